@@ -1,10 +1,61 @@
 #include"threadpool.h"
 #include<functional>
 #include<thread>
-#include<iostream>
+#include<algorithm>
+#include<cstdio>
+#include<cstdarg>
 const int TASK_MAX_THRESHHOLD=INT32_MAX;
 const int THREAD_MAX_THRESHHOLD=10;
 const int THREAD_MAX_IDLE_TIME=60;
+//空闲线程休眠前自旋检查任务的次数范围（自适应）
+const int IDLE_SPIN_MIN=64;
+const int IDLE_SPIN_MAX=4096;
+
+#ifndef THREADPOOL_LOG_LEVEL
+#define THREADPOOL_LOG_LEVEL POOL_LOG_LEVEL_WARN
+#endif
+const std::size_t POOL_LOG_LINE_SIZE=240;
+
+namespace{
+//默认sink：整行一次fwrite，不经过iostream
+void poolLogStderr(int level,const char*text,std::size_t len){
+    static const char*names[]={"NONE","ERROR","WARN","INFO","DEBUG","TRACE"};
+    char line[POOL_LOG_LINE_SIZE+16];
+    int n=std::snprintf(line,sizeof(line),"[%s] %.*s\n",names[level],(int)len,text);
+    if(n<=0)return;
+    std::fwrite(line,1,std::min((std::size_t)n,sizeof(line)-1),stderr);
+}
+
+std::atomic<PoolLogSink>poolLogSink_{&poolLogStderr};
+
+#if defined(__GNUC__)
+__attribute__((format(printf,2,3)))
+#endif
+void poolLogf(int level,const char*fmt,...){
+    char text[POOL_LOG_LINE_SIZE];
+    va_list args;
+    va_start(args,fmt);
+    int n=std::vsnprintf(text,sizeof(text),fmt,args);
+    va_end(args);
+    if(n<0)return;
+    poolLogSink_.load(std::memory_order_acquire)(level,text,std::min((std::size_t)n,sizeof(text)-1));
+}
+
+unsigned long poolThreadTag(){
+    return (unsigned long)(std::hash<std::thread::id>()(std::this_thread::get_id())&0xFFFFFF);
+}
+}
+
+//级别高于THREADPOOL_LOG_LEVEL时整条语句被丢弃，参数不求值
+#define POOL_LOG(level,...) do{if constexpr((level)<=THREADPOOL_LOG_LEVEL){poolLogf((level),__VA_ARGS__);}}while(0)
+#define POOL_LOG_WARN(...) POOL_LOG(POOL_LOG_LEVEL_WARN,__VA_ARGS__)
+#define POOL_LOG_DEBUG(...) POOL_LOG(POOL_LOG_LEVEL_DEBUG,__VA_ARGS__)
+#define POOL_LOG_TRACE(...) POOL_LOG(POOL_LOG_LEVEL_TRACE,__VA_ARGS__)
+
+PoolLogSink setPoolLogSink(PoolLogSink sink){
+    if(sink==nullptr)sink=&poolLogStderr;
+    return poolLogSink_.exchange(sink,std::memory_order_acq_rel);
+}
 
 ThreadPool::ThreadPool()
     :initThreadSize_(4)
@@ -18,11 +69,40 @@ ThreadPool::ThreadPool()
     {}
 
 ThreadPool::~ThreadPool(){
-    isPoolRunning_=false;
-    
-    std::unique_lock<std::mutex>lock(taskQueMtx_);
-    notEmpty_.notify_all();
-    exitCond_.wait(lock,[&]()->bool{return threads_.size()==0;});
+    shutdown(ShutdownMode::SHUTDOWN_DRAIN,std::chrono::milliseconds::max());
+}
+
+bool ThreadPool::shutdown(ShutdownMode mode,std::chrono::milliseconds timeout){
+    std::queue<std::shared_ptr<TaskBase>>aborted;
+    std::vector<std::unique_ptr<Thread>>exited;//在锁外析构（join）
+    bool done=true;
+    int running=0;
+    {
+        std::unique_lock<std::mutex>lock(taskQueMtx_);
+        isShutdown_=true;
+        isPoolRunning_=false;
+        //延迟启动：之后不再创建线程；还有任务却一个线程都没有时补一个把它们执行完
+        if(lazyPending_>0&&threads_.empty()&&mode==ShutdownMode::SHUTDOWN_DRAIN&&!taskQue_.empty())spawnThread();
+        lazyPending_=0;
+        if(mode==ShutdownMode::SHUTDOWN_ABORT){
+            aborted.swap(taskQue_);
+            taskSize_=0;
+        }
+        //唤醒休眠的线程（队列空时退出）和阻塞中的提交者（立即失败）
+        notEmpty_.notify_all();
+        notFull_.notify_all();
+        auto allExited=[&]()->bool{return threads_.size()==0;};
+        if(timeout==std::chrono::milliseconds::max())exitCond_.wait(lock,allExited);
+        else done=exitCond_.wait_for(lock,timeout,allExited);
+        running=(int)threads_.size();
+        exited.swap(exitedThreads_);
+    }
+    while(!aborted.empty()){
+        aborted.front()->drop(SubmitStatus::SUBMIT_SHUTDOWN);
+        aborted.pop();
+    }
+    if(!done)POOL_LOG_WARN("shutdown timeout,%d threads still running.",running);
+    return done;
 }
 
 void ThreadPool::setMode(PoolMode mode){
@@ -42,24 +122,72 @@ void ThreadPool::setThreadSizeThreshHold(int threshHold){
     if(checkRunningState())return;
     if(poolMode_== PoolMode::MODE_CACHED)threadSizeThreshHold_=threshHold;
 }
-Result ThreadPool::submitTask(std::shared_ptr<Task>sp){
-    //获取锁
-    std::unique_lock<std::mutex>lock(taskQueMtx_);
-    //线程的通信
+void ThreadPool::setLazyStart(bool enable){
+    if(checkRunningState())return;
+    lazyStart_=enable;
+}
 
-    if(!notFull_.wait_for(lock,std::chrono::seconds(1),
-        [&]()->bool{
-            return taskQue_.size()<(size_t)taskQueMaxThreshHold_;}))
-    {
-        std::cerr<<"task queue is full,submit task fail."<<std::endl;
-        return Result(sp,false);
+ThreadPool& ThreadPool::defaultPool(){
+    static ThreadPool& pool=[]()->ThreadPool&{
+        static ThreadPool p;
+        p.setLazyStart(true);
+        int n=int(std::thread::hardware_concurrency());
+        p.start(n>0?n:1);
+        return p;
+    }();
+    return pool;
+}
+
+void ThreadPool::setOverflowPolicy(OverflowPolicy policy,std::chrono::milliseconds blockTimeout){
+    if(checkRunningState())return;
+    overflowPolicy_=policy;
+    blockTimeout_=toWaitLimit(blockTimeout);
+}
+SubmitStatus ThreadPool::pushTask(std::unique_lock<std::mutex>&lock,std::shared_ptr<TaskBase>sp,
+    OverflowPolicy policy,std::chrono::nanoseconds wait){
+    if(isShutdown_){
+        POOL_LOG_DEBUG("thread pool is shut down,submit task fail.");
+        return SubmitStatus::SUBMIT_SHUTDOWN;
+    }
+    //线程的通信（shutdown也会唤醒等待中的提交者）
+    auto notFull=[&]()->bool{
+        return isShutdown_||taskQue_.size()<(size_t)taskQueMaxThreshHold_;};
+    if(!notFull()){
+        if(policy==OverflowPolicy::OVERFLOW_DROP_OLDEST&&!taskQue_.empty()){
+            //丢弃最早入队的任务，它的Result立即就绪（状态为SUBMIT_DROPPED）
+            taskQue_.front()->drop();
+            taskQue_.pop();
+            taskSize_--;
+        }else if(policy==OverflowPolicy::OVERFLOW_BLOCK&&wait>std::chrono::nanoseconds::zero()){
+            waitingProducers_++;
+            bool ok=true;
+            if(wait==std::chrono::nanoseconds::max())notFull_.wait(lock,notFull);
+            else ok=notFull_.wait_for(lock,wait,notFull);
+            waitingProducers_--;
+            if(!ok){
+                POOL_LOG_WARN("task queue is full,submit task timeout.");
+                return SubmitStatus::SUBMIT_TIMEOUT;
+            }
+            if(isShutdown_)return SubmitStatus::SUBMIT_SHUTDOWN;
+        }else{
+            POOL_LOG_DEBUG("task queue is full,submit task fail.");
+            return SubmitStatus::SUBMIT_QUEUE_FULL;
+        }
     }
     //如果有空余，任务放入任务队列中
     taskQue_.emplace(sp);
     taskSize_++;
+
+    //延迟启动：空闲线程不够时补一个初始线程
+    if(lazyPending_>0&&taskSize_>idleThreadSize_){
+        spawnThread();
+        lazyPending_--;
+    }
     
-    //放入任务队列后，在notEmpty_上通知
-    notEmpty_.notify_all();
+    //放入任务队列后，只唤醒一个在notEmpty_上休眠的线程
+    if(waitingThreads_>0){
+        notEmpty_.notify_one();
+    }
 
     //cached多且小的任务
     //TODO 根据任务和空闲线程的数量，判断是否需要创建新的线程出来?
@@ -67,41 +195,80 @@ Result ThreadPool::submitTask(std::shared_ptr<Task>sp){
         &&taskSize_>idleThreadSize_
         &&curThreadSize_<threadSizeThreshHold_)
     {   
-        std::cout<<"create new thread"<<std::endl;
-            auto ptr=std::make_unique<Thread>(std::bind(&ThreadPool::threadFunc,this,std::placeholders::_1));
-            int threadId=ptr->getId();
-            threads_.emplace(threadId,std::move(ptr));
-            threads_[threadId]->start();
+        POOL_LOG_DEBUG("create new thread");
+            spawnThread();
             curThreadSize_++;
-            idleThreadSize_++;
     }
     
 
-    return Result(sp);
+    return SubmitStatus::SUBMIT_OK;
+
+}
 
+SubmitStatus ThreadPool::enqueue(std::shared_ptr<TaskBase>sp,OverflowPolicy policy,std::chrono::nanoseconds wait){
+    //先于lock声明：锁释放之后才执行任务
+    CallerRuns callerRuns;
+    std::unique_lock<std::mutex>lock(taskQueMtx_);
+    SubmitStatus status=pushTask(lock,sp,policy,wait);
+    if((status==SubmitStatus::SUBMIT_QUEUE_FULL||status==SubmitStatus::SUBMIT_TIMEOUT)
+        &&policy==OverflowPolicy::OVERFLOW_CALLER_RUNS){
+        callerRuns.task=std::move(sp);
+        status=SubmitStatus::SUBMIT_OK;
+    }
+    return status;
 }
 
 void ThreadPool::start(int initThreadSize){
+    {
+        std::lock_guard<std::mutex>lock(taskQueMtx_);
+        if(isShutdown_){
+            POOL_LOG_WARN("thread pool is shut down,start ignored.");
+            return;
+        }
+    }
 
     isPoolRunning_=true;
 
     initThreadSize_=initThreadSize;
     curThreadSize_=initThreadSize;
 
-    for(int i=0;i<initThreadSize_;i++)
-    {
-        auto ptr=std::make_unique<Thread>(std::bind(&ThreadPool::threadFunc,this,std::placeholders::_1));
-        //threads_.emplace_back(std::move(ptr));
-        int threadId=ptr->getId();
-        threads_.emplace(threadId,std::move(ptr));
+    //线程ID按本线程池计数分配，同一进程内可以有多个线程池
+    std::lock_guard<std::mutex>lock(taskQueMtx_);
+    if(lazyStart_){
+        lazyPending_=initThreadSize_;
+        return;
     }
     for(int i=0;i<initThreadSize_;i++)
     {
-        threads_[i]->start();
-        idleThreadSize_++;
+        spawnThread();
     }
 } 
 
+void ThreadPool::spawnThread(){
+    auto ptr=std::make_unique<Thread>([this](int threadid){threadFunc(threadid);},nextThreadId_++);
+    Thread* thread=ptr.get();
+    threads_.emplace(thread->getId(),std::move(ptr));
+    thread->start();
+    idleThreadSize_++;
+}
+
+bool ThreadPool::runPendingTask(){
+    if(taskSize_==0)return false;//无锁快速判断
+    std::shared_ptr<TaskBase>task;
+    {
+        std::unique_lock<std::mutex>lock(taskQueMtx_);
+        if(taskQue_.empty())return false;
+        task=taskQue_.front();
+        taskQue_.pop();
+        taskSize_--;
+        if(waitingProducers_>0){
+            notFull_.notify_one();
+        }
+    }
+    task->exec();
+    return true;
+}
+
 void ThreadPool::threadFunc(int threadid){
     
    /*  std::cout<<"begin threadFunc tid:"
@@ -109,15 +276,30 @@ void ThreadPool::threadFunc(int threadid){
 
     std::cout<<"end threadFunc tid:"
     <<std::this_thread::get_id()<<std::endl; */
-    auto lastTime=std::chrono::high_resolution_clock().now();
+    auto lastTime=std::chrono::steady_clock::now();
+    int spinLimit=IDLE_SPIN_MIN;
 
     for(;;){
 
-        std::shared_ptr<Task>task;
+        std::shared_ptr<TaskBase>task;
+        //本线程退出前取走的、先前已退出的线程，在释放锁之后析构（join）
+        std::vector<std::unique_ptr<Thread>>reaped;
+
+        //先不加锁自旋一会，任务很快到来时省掉一次休眠/唤醒
+        if(taskSize_==0){
+            int i=0;
+            while(i<spinLimit&&taskSize_==0&&isPoolRunning_){
+                std::this_thread::yield();
+                i++;
+            }
+            if(taskSize_>0)spinLimit=std::min(spinLimit*2,IDLE_SPIN_MAX);
+            else spinLimit=std::max(spinLimit/2,IDLE_SPIN_MIN);
+        }
+
         {//获取锁
         
             std::unique_lock<std::mutex>lock(taskQueMtx_);
-            std::cout<<"tid:"<<std::this_thread::get_id()<<"尝试获取任务..."<<std::endl;
+            POOL_LOG_TRACE("tid:%lx尝试获取任务...",poolThreadTag());
             
             //cached模式下，有可能已经创建了很多的线程
             //但是空闲时间超过60s,应该把多余的线程结束回收掉
@@ -126,47 +308,50 @@ void ThreadPool::threadFunc(int threadid){
             {   
                 if(!isPoolRunning_)
                 {
-                    threads_.erase(threadid);
-                    std::cout<<"threadid:"<<std::this_thread::get_id()
-                    <<"exit"<<std::endl;
-                    exitCond_.notify_all();
+                    retireSelf(threadid);
+                    POOL_LOG_DEBUG("threadid:%lx exit",poolThreadTag());
 
                     return;
                 }
 
-                if(poolMode_==PoolMode::MODE_CACHED){
-
-                    if(std::cv_status::timeout==
-                        notEmpty_.wait_for(lock,std::chrono::seconds(1)))
+                if(poolMode_==PoolMode::MODE_CACHED&&curThreadSize_>initThreadSize_){
+                    //空闲满THREAD_MAX_IDLE_TIME时醒来回收（只等到期那一刻，不按秒轮询）
+                    auto idleDeadline=lastTime+std::chrono::seconds(THREAD_MAX_IDLE_TIME);
+                    waitingThreads_++;
+                    std::cv_status status=notEmpty_.wait_until(lock,idleDeadline);
+                    waitingThreads_--;
+                    if(status==std::cv_status::no_timeout&&taskQue_.size()==0&&isPoolRunning_){
+                        wastedWakeups_++;
+                    }
+                    if(taskQue_.size()==0&&isPoolRunning_
+                        &&std::chrono::steady_clock::now()>=idleDeadline
+                        &&curThreadSize_>initThreadSize_)
                     {
-                        auto now=std::chrono::high_resolution_clock().now();
-                        auto dur=std::chrono::duration_cast<std::chrono::seconds>
-                        (now-lastTime);
-                        if(dur.count()>=THREAD_MAX_IDLE_TIME&&
-                        curThreadSize_>initThreadSize_)
-                        {
-                            threads_.erase(threadid);
-                            curThreadSize_--;
-                            idleThreadSize_--;
-
-                            std::cout<<"threadid:"<<std::this_thread::get_id()
-                            <<"exit"<<std::endl;
-
-                            return;
-                        }
+                        reaped.swap(exitedThreads_);
+                        retireSelf(threadid);
+                        curThreadSize_--;
+                        idleThreadSize_--;
+
+                        POOL_LOG_DEBUG("threadid:%lx exit",poolThreadTag());
+
+                        return;
                     }
                 }
                 else
                 {
+                    waitingThreads_++;
                     notEmpty_.wait(lock);
+                    waitingThreads_--;
+                    if(taskQue_.size()==0&&isPoolRunning_){
+                        wastedWakeups_++;
+                    }
                 }
                /*  if(!isPoolRunning_){
                     threads_.erase(threadid);
                     curThreadSize_--;
                     idleThreadSize_--;
 
-                    std::cout<<"threadid:"<<std::this_thread::get_id()
-                    <<"exit"<<std::endl;
+                    POOL_LOG_DEBUG("threadid:%lx exit",poolThreadTag());
                     exitCond_.notify_all();
                     return;
                 } */
@@ -175,18 +360,16 @@ void ThreadPool::threadFunc(int threadid){
         
             idleThreadSize_--;
             
-            std::cout<<"tid:"<<std::this_thread::get_id()<<"获取任务成功"<<std::endl;
+            POOL_LOG_TRACE("tid:%lx获取任务成功",poolThreadTag());
             //从任务队列取一个任务出来
             task=taskQue_.front();
             taskQue_.pop();
             taskSize_--;
 
-            //先释放锁
-            if(taskQue_.size()>0){
-                notEmpty_.notify_all();
+            //只有确实有提交者在等待时才通知，且只通知一个
+            if(waitingProducers_>0){
+                notFull_.notify_one();
             }
-            
-            notFull_.notify_all(); 
         }
 
 
@@ -197,7 +380,7 @@ void ThreadPool::threadFunc(int threadid){
         }
        
         idleThreadSize_++; 
-        lastTime=std::chrono::high_resolution_clock().now();
+        lastTime=std::chrono::steady_clock::now();
         
     }
 
@@ -205,63 +388,38 @@ void ThreadPool::threadFunc(int threadid){
 
 }
 
+void ThreadPool::retireSelf(int threadid){
+    auto it=threads_.find(threadid);
+    if(it!=threads_.end()){
+        exitedThreads_.push_back(std::move(it->second));
+        threads_.erase(it);
+    }
+    exitCond_.notify_all();//通知shutdown
+}
+
 bool ThreadPool::checkRunningState()const{
     return isPoolRunning_;
 }
 
-int Thread::generateId_=0;
+long long ThreadPool::wastedWakeupCount()const{
+    return wastedWakeups_;
+}
 
-Thread::Thread(ThreadFunc func)
-    :func_(func)
-    ,threadId_(generateId_++)
+Thread::Thread(ThreadFunc func,int threadId)
+    :func_(std::move(func))
+    ,threadId_(threadId)
 {}
 
+//std::jthread析构时join
 Thread::~Thread(){
 
 }
 
-//
 void Thread::start(){
-    std::thread t(func_,threadId_);
-    t.detach();
+    thread_=std::jthread(func_,threadId_);
 }
 
 int Thread::getId()const{
     return threadId_;
 }
 
-
-Task::Task()
-    :result_(nullptr)
-{}
-
-
-void Task::exec(){
-    if(result_!=nullptr)
-    result_->setVal(run());
-}
-
-void Task::setResult(Result*res){
-    result_=res;
-}
-
-
-Result::Result(std::shared_ptr<Task>task,bool isValid)
-    :isValid_(isValid)
-    ,task_(task)
-{
-    task_->setResult(this);
-}
-
-Any Result::get(){
-    if(!isValid_){
-        return "";
-    }
-    sem_.wait();
-    return std::move(any_);
-}
-
-void Result::setVal(Any any){
-    this->any_=std::move(any);
-    sem_.post();
-}
\ No newline at end of file
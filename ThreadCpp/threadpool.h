@@ -10,6 +10,12 @@
 #include <functional>
 #include<unordered_map>
 #include<thread>
+#include<cstdint>
+#include<new>
+#include<cstddef>
+#include<chrono>
+#include<type_traits>
+#include<utility>
 
 class Any{
     public: 
@@ -22,15 +28,16 @@ class Any{
     Any& operator=(Any&&)=default;
 
     template<typename T>
-    Any(T data):base_(std::make_unique<Derive<T>>(data)){}
+    Any(T data):base_(std::make_unique<Derive<T>>(std::move(data))){}
 
+    //左值拷贝出值；右值（如res.get().cast_<T>()）直接移走，不再拷贝
     template<typename T>
-    T cast_(){
-        Derive<T>*pd=dynamic_cast<Derive<T>*>(base_.get());
-        if(pd==nullptr){
-            throw"type is unmatch!";
-        }
-        return pd->data_;
+    T cast_()&{
+        return derive<T>()->data_;
+    }
+    template<typename T>
+    T cast_()&&{
+        return std::move(derive<T>()->data_);
     }
     private:
     class Base{
@@ -41,7 +48,7 @@ class Any{
     template<typename T>
     class Derive:public Base{
         public:
-        Derive(T data):data_(data){}
+        Derive(T data):data_(std::move(data)){}
 
     
 
@@ -49,6 +56,15 @@ class Any{
 
         
     };
+
+    template<typename T>
+    Derive<T>* derive(){
+        Derive<T>*pd=dynamic_cast<Derive<T>*>(base_.get());
+        if(pd==nullptr){
+            throw"type is unmatch!";
+        }
+        return pd;
+    }
     private:
     std::unique_ptr<Base>base_;
 };
@@ -81,31 +97,256 @@ class Semaphore{
     std::condition_variable cond_;
 
 };
-class Task;
+//任务队列满时submitTask的处理策略（setOverflowPolicy，trySubmit/submitFor不受影响）
+enum class OverflowPolicy{
+    OVERFLOW_BLOCK,//等待空位，超过等待时限仍满则提交失败（默认，时限默认1秒）
+    OVERFLOW_REJECT,//立即提交失败
+    OVERFLOW_CALLER_RUNS,//在提交线程上直接执行
+    OVERFLOW_DROP_OLDEST,//丢弃最早入队的任务腾出位置（被丢弃任务的Result状态为SUBMIT_DROPPED）
+};
+
+//提交结果（Result::status()）
+enum class SubmitStatus{
+    SUBMIT_OK,//已入队（或已在提交线程上执行）
+    SUBMIT_QUEUE_FULL,//队列满（未等待）
+    SUBMIT_TIMEOUT,//等待空位超时
+    SUBMIT_DROPPED,//入队后被drop-oldest丢弃
+    SUBMIT_SHUTDOWN,//线程池已关闭（shutdown之后提交，或入队后被SHUTDOWN_ABORT丢弃）
+};
+
+//shutdown的方式
+enum class ShutdownMode{
+    SHUTDOWN_DRAIN,//不再接受新任务，已入队的任务全部执行完后线程退出（析构函数使用）
+    SHUTDOWN_ABORT,//不再接受新任务，丢弃尚未开始的任务（Result状态为SUBMIT_SHUTDOWN），执行中的任务照常完成
+};
+
+//队列中存放的任务基类（与结果类型无关）
+class TaskBase{
+    public:
+    virtual ~TaskBase()=default;
+    //执行任务并把返回值写入关联的Result
+    virtual void exec()=0;
+    //任务被丢弃（drop-oldest或SHUTDOWN_ABORT），不再执行
+    virtual void drop(SubmitStatus reason=SubmitStatus::SUBMIT_DROPPED)=0;
+};
+
+template<typename T>
+class TypedTask;
+
+//结果槽：状态字+就地存放的值（Result和submit()的TaskHandle共用）
+//状态字:EMPTY未完成 -> WAITING有线程在等 -> READY已完成
+//完成时只做一次原子交换，只有确实有线程在等时才futex唤醒(C++20 atomic::wait)
+//任务被丢弃时状态字变为DROPPED（或SHUTDOWN），等待方同样被唤醒
+template<typename T>
+class ResultSlot{
+    public:
+    ResultSlot():state_(STATE_EMPTY){}
+    ~ResultSlot(){
+        if constexpr(!std::is_void_v<T>){
+            if(state_.load(std::memory_order_acquire)==STATE_READY)value()->~Stored();
+        }
+    }
+    ResultSlot(const ResultSlot&)=delete;
+    ResultSlot& operator=(const ResultSlot&)=delete;
+
+    //调用fn()并把返回值直接构造在槽内（不经过中间拷贝），然后标记完成
+    template<typename Fn>
+    void emplaceFrom(Fn&fn){
+        if constexpr(std::is_void_v<T>)fn();
+        else new(storage_)Stored(fn());
+        publish(STATE_READY);
+    }
+    void drop(SubmitStatus reason){
+        publish(reason==SubmitStatus::SUBMIT_SHUTDOWN?STATE_SHUTDOWN:STATE_DROPPED);
+    }
+    //阻塞直到完成或被丢弃，完成时取走结果（被丢弃时返回T()）
+    T take(){
+        std::uint32_t s=state_.load(std::memory_order_acquire);
+        while(s==STATE_EMPTY||s==STATE_WAITING){
+            //先登记等待，完成方看到WAITING才会唤醒
+            if(s==STATE_EMPTY&&!state_.compare_exchange_weak(s,STATE_WAITING,std::memory_order_acquire))continue;
+            state_.wait(STATE_WAITING,std::memory_order_acquire);
+            s=state_.load(std::memory_order_acquire);
+        }
+        if constexpr(!std::is_void_v<T>){
+            if(s!=STATE_READY)return T();
+            return std::move(*value());
+        }
+    }
+    bool ready()const{
+        std::uint32_t s=state_.load(std::memory_order_acquire);
+        return s!=STATE_EMPTY&&s!=STATE_WAITING;
+    }
+    //SUBMIT_OK、SUBMIT_DROPPED或SUBMIT_SHUTDOWN
+    SubmitStatus status()const{
+        std::uint32_t s=state_.load(std::memory_order_acquire);
+        if(s==STATE_DROPPED)return SubmitStatus::SUBMIT_DROPPED;
+        if(s==STATE_SHUTDOWN)return SubmitStatus::SUBMIT_SHUTDOWN;
+        return SubmitStatus::SUBMIT_OK;
+    }
+    private:
+    static constexpr std::uint32_t STATE_EMPTY=0;
+    static constexpr std::uint32_t STATE_WAITING=1;
+    static constexpr std::uint32_t STATE_READY=2;
+    static constexpr std::uint32_t STATE_DROPPED=3;
+    static constexpr std::uint32_t STATE_SHUTDOWN=4;
+
+    //void结果不占存储
+    using Stored=std::conditional_t<std::is_void_v<T>,char,T>;
+
+    void publish(std::uint32_t s){
+        if(state_.exchange(s,std::memory_order_acq_rel)==STATE_WAITING){
+            state_.notify_all();
+        }
+    }
+    Stored* value(){return std::launder(reinterpret_cast<Stored*>(storage_));}
+
+    std::atomic<std::uint32_t>state_;
+    alignas(Stored) unsigned char storage_[sizeof(Stored)];
+};
+
+//任务结果（类型化，值直接存放在Result内部）
+template<typename T=Any>
 class Result{
     public:
-    Result(std::shared_ptr<Task>task,bool isValid=true);
-    ~Result()=default;
-    void setVal(Any any);
-    Any get();
+    Result(std::shared_ptr<TypedTask<T>>task,SubmitStatus status=SubmitStatus::SUBMIT_OK);
+    ~Result();
+    Result(const Result&)=delete;
+    Result& operator=(const Result&)=delete;
+    void setVal(T val);
+    //任务被丢弃：唤醒等待方，get返回T()；reason为之后status()的值
+    void drop(SubmitStatus reason=SubmitStatus::SUBMIT_DROPPED);
+    //阻塞直到任务完成并取走结果（提交失败或被丢弃时返回T()，用status()区分）
+    T get();
+    //get是否不会阻塞（已完成或已被丢弃；不阻塞，只读一次状态字，适合轮询）
+    bool ready()const;
+    //提交结果：失败（队列满/超时）或已被丢弃时get直接返回T()
+    SubmitStatus status()const;
+    //提交成功且未被丢弃
+    bool valid()const{return status()==SubmitStatus::SUBMIT_OK;}
+    private:
+    ResultSlot<T>slot_;
+    std::shared_ptr<TypedTask<T>>task_;
+    SubmitStatus status_;
+
+};
+
+//返回值类型为T的任务，用户继承并实现run()
+template<typename T>
+class TypedTask:public TaskBase{
+    public:
+    using value_type=T;
+    TypedTask():result_(nullptr){}
+    ~TypedTask()=default;
+    void exec()override{
+        if(result_!=nullptr)
+        result_->setVal(run());
+    }
+    void drop(SubmitStatus reason=SubmitStatus::SUBMIT_DROPPED)override{
+        if(result_!=nullptr)
+        result_->drop(reason);
+    }
+    void setResult(Result<T>*res){
+        result_=res;
+    }
+    virtual T run()=0;
+
     private:
-    Any any_;
-    Semaphore sem_;
-    std::shared_ptr<Task>task_;
-    std::atomic_bool isValid_;
+    Result<T>* result_;
+};
 
+//原有接口：返回Any的任务
+class Task:public TypedTask<Any>{
 };
 
-class Task{
+template<typename T>
+Result<T>::Result(std::shared_ptr<TypedTask<T>>task,SubmitStatus status)
+    :task_(task)
+    ,status_(status)
+{
+    task_->setResult(this);
+}
+
+template<typename T>
+Result<T>::~Result()=default;
+
+template<typename T>
+void Result<T>::setVal(T val){
+    auto move=[&]()->T{return std::move(val);};
+    slot_.emplaceFrom(move);
+}
+
+template<typename T>
+void Result<T>::drop(SubmitStatus reason){
+    slot_.drop(reason);
+}
+
+template<typename T>
+T Result<T>::get(){
+    if(status_!=SubmitStatus::SUBMIT_OK){
+        return T();
+    }
+    return slot_.take();
+}
+
+template<typename T>
+bool Result<T>::ready()const{
+    return slot_.ready();
+}
+
+template<typename T>
+SubmitStatus Result<T>::status()const{
+    if(status_!=SubmitStatus::SUBMIT_OK)return status_;
+    return slot_.status();
+}
+
+//submit()的任务状态：结果槽与任务对象在同一次分配中，与可调用对象的类型无关
+template<typename T>
+class TaskState:public TaskBase{
     public:
-    Task();
-    ~Task()=default;
-    void exec();
-    void setResult(Result*res);
-    virtual Any run()=0;
+    void drop(SubmitStatus reason=SubmitStatus::SUBMIT_DROPPED)override{
+        slot_.drop(reason);
+    }
+    ResultSlot<T>slot_;
+};
 
+//submit()的任务：可调用对象直接存放在任务对象内，返回值直接构造在结果槽中
+template<typename F,typename T>
+class FuncTask:public TaskState<T>{
+    public:
+    template<typename G>
+    explicit FuncTask(G&&fn):fn_(std::forward<G>(fn)){}
+    void exec()override{
+        this->slot_.emplaceFrom(fn_);
+    }
     private:
-    Result * result_;
+    F fn_;
+};
+
+//submit()返回的类型化结果句柄（可移动）
+//取结果不经过Any/dynamic_cast，也没有虚函数调用；get()把结果移出，不拷贝
+template<typename T>
+class TaskHandle{
+    public:
+    TaskHandle(std::shared_ptr<TaskState<T>>state,SubmitStatus status)
+        :state_(std::move(state))
+        ,status_(status)
+    {}
+    //阻塞直到任务完成并取走结果（只能取一次；提交失败或被丢弃时返回T()，用status()区分）
+    T get(){
+        if(status_!=SubmitStatus::SUBMIT_OK)return T();
+        return state_->slot_.take();
+    }
+    //get是否不会阻塞
+    bool ready()const{return status_!=SubmitStatus::SUBMIT_OK||state_->slot_.ready();}
+    SubmitStatus status()const{
+        if(status_!=SubmitStatus::SUBMIT_OK)return status_;
+        return state_->slot_.status();
+    }
+    bool valid()const{return status()==SubmitStatus::SUBMIT_OK;}
+    private:
+    std::shared_ptr<TaskState<T>>state_;
+    SubmitStatus status_;
 };
 
 enum class PoolMode{
@@ -113,11 +354,13 @@ enum class PoolMode{
     MODE_CACHED,
 };
 
+//工作线程（std::jthread，析构时join；线程退出时由线程池移到待回收表，由其他线程析构）
 class Thread{
     public:
     using ThreadFunc=std::function<void(int)>;
 
-    Thread(ThreadFunc func);
+    //threadId由所属线程池分配，在线程池内唯一
+    Thread(ThreadFunc func,int threadId);
 
     ~Thread();
 
@@ -127,15 +370,30 @@ class Thread{
     private:
     
     ThreadFunc func_;
-    static int generateId_;
     int threadId_;
+    std::jthread thread_;
 
 };
 
+//日志级别：高于THREADPOOL_LOG_LEVEL（编译threadpool.cpp时定义，默认WARN）的日志不生成代码
+#define POOL_LOG_LEVEL_NONE 0
+#define POOL_LOG_LEVEL_ERROR 1
+#define POOL_LOG_LEVEL_WARN 2
+#define POOL_LOG_LEVEL_INFO 3
+#define POOL_LOG_LEVEL_DEBUG 4
+#define POOL_LOG_LEVEL_TRACE 5
+
+//日志输出函数：text不含换行，len为长度
+using PoolLogSink=void(*)(int level,const char*text,std::size_t len);
+
+//替换日志输出函数（默认整行写stderr），返回原来的sink，传入nullptr恢复默认
+PoolLogSink setPoolLogSink(PoolLogSink sink);
+
 class ThreadPool{
     public:
     ThreadPool();
 
+    //等同于shutdown(SHUTDOWN_DRAIN)并一直等待所有线程退出
     ~ThreadPool();
 
     void setMode(PoolMode mode);
@@ -146,30 +404,162 @@ class ThreadPool{
 
     void setThreadSizeThreshHold(int threshHold);
 
-    Result submitTask(std::shared_ptr<Task>sp);
+    //延迟启动（运行中不可修改）：start()不创建线程，任务入队时没有空闲线程才创建一个，直到达到初始线程数
+    void setLazyStart(bool enable);
+
+    //进程共享的默认线程池：首次调用时以延迟启动方式启动（线程数为CPU核心数），进程退出时析构
+    //不要对它调用shutdown或修改配置，也不要在其他静态对象的析构函数中向它提交任务
+    static ThreadPool& defaultPool();
+
+    //设置队列满时submitTask的处理策略（运行中不可修改）
+    //blockTimeout只对OVERFLOW_BLOCK有效，std::chrono::milliseconds::max()表示一直等待
+    //（一直等待时不要在工作线程内提交：所有线程都卡在提交上就没有线程出队了）
+    void setOverflowPolicy(OverflowPolicy policy,std::chrono::milliseconds blockTimeout=std::chrono::seconds(1));
+
+    //提交任务，返回与任务返回值同类型的Result（Task子类得到Result<Any>）
+    //队列满时按OverflowPolicy处理，失败时Result::status()给出原因
+    template<typename TaskT,typename T=typename TaskT::value_type>
+    Result<T> submitTask(std::shared_ptr<TaskT>sp){
+        return submitWith<TaskT,T>(sp,overflowPolicy_,blockTimeout_);
+    }
+
+    //提交可调用对象（返回值任意类型，包括void），队列满时按OverflowPolicy处理
+    //可调用对象和结果在一次分配中存放，不需要继承Task，结果不经过Any
+    template<typename F,typename T=std::invoke_result_t<std::decay_t<F>&>>
+    TaskHandle<T> submit(F&&fn){
+        auto sp=std::make_shared<FuncTask<std::decay_t<F>,T>>(std::forward<F>(fn));
+        SubmitStatus status=enqueue(sp,overflowPolicy_,blockTimeout_);
+        return TaskHandle<T>(std::move(sp),status);
+    }
+
+    //非阻塞提交：队列满时立即返回状态为SUBMIT_QUEUE_FULL的Result（任务不执行）
+    template<typename TaskT,typename T=typename TaskT::value_type>
+    Result<T> trySubmit(std::shared_ptr<TaskT>sp){
+        return submitWith<TaskT,T>(sp,OverflowPolicy::OVERFLOW_REJECT,std::chrono::nanoseconds::zero());
+    }
+
+    //限时提交：队列满时最多等待timeout，仍满则返回状态为SUBMIT_TIMEOUT的Result（任务不执行）
+    template<typename TaskT,typename Rep,typename Period,typename T=typename TaskT::value_type>
+    Result<T> submitFor(std::shared_ptr<TaskT>sp,const std::chrono::duration<Rep,Period>&timeout){
+        return submitWith<TaskT,T>(sp,OverflowPolicy::OVERFLOW_BLOCK,toWaitLimit(timeout));
+    }
 
     void start(int initThreadSize=int(std::thread::hardware_concurrency()));
 
+    //关闭线程池：之后提交的任务直接失败（Result状态为SUBMIT_SHUTDOWN），阻塞中的提交者也立即失败
+    //DRAIN执行完已入队的任务，ABORT丢弃尚未开始的任务；最多等待timeout，期间所有工作线程退出并被join时返回true
+    //超时返回false（执行中的任务不会被打断），之后可以再次调用（例如改用ABORT）继续等待
+    //不要在本线程池的工作线程内调用
+    bool shutdown(ShutdownMode mode=ShutdownMode::SHUTDOWN_DRAIN,
+        std::chrono::milliseconds timeout=std::chrono::milliseconds::max());
+
+    //等待res就绪并取出结果，等待期间在当前线程上执行队列中的任务
+    //任务内等待子任务时用它代替res.get()：不会占住工作线程，线程数固定时也不会死锁
+    template<typename T>
+    T waitFor(Result<T>&res){
+        int idleRounds=0;
+        while(res.valid()&&!res.ready()){
+            if(runPendingTask()){
+                idleRounds=0;
+                continue;
+            }
+            //队列暂时为空：先让出CPU，仍无任务再短暂休眠
+            if(++idleRounds<IDLE_YIELD_ROUNDS)std::this_thread::yield();
+            else std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+        return res.get();
+    }
+
+    //TaskHandle版本
+    template<typename T>
+    T waitFor(TaskHandle<T>&res){
+        int idleRounds=0;
+        while(res.valid()&&!res.ready()){
+            if(runPendingTask()){
+                idleRounds=0;
+                continue;
+            }
+            if(++idleRounds<IDLE_YIELD_ROUNDS)std::this_thread::yield();
+            else std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+        return res.get();
+    }
+
+    //被唤醒后却发现队列为空的次数
+    long long wastedWakeupCount()const;
+
     ThreadPool(const ThreadPool&)=delete;
     ThreadPool& operator=(const ThreadPool&)=delete;
 
 
     private:
+    //析构时在当前线程上执行任务（caller-runs）
+    struct CallerRuns{
+        std::shared_ptr<TaskBase>task;
+        ~CallerRuns(){if(task)task->exec();}
+    };
+
+    template<typename TaskT,typename T>
+    Result<T> submitWith(std::shared_ptr<TaskT>sp,OverflowPolicy policy,std::chrono::nanoseconds wait){
+        //先于lock声明：返回值构造完、锁释放之后才执行任务
+        CallerRuns callerRuns;
+        std::unique_lock<std::mutex>lock(taskQueMtx_);
+        SubmitStatus status=pushTask(lock,sp,policy,wait);
+        if((status==SubmitStatus::SUBMIT_QUEUE_FULL||status==SubmitStatus::SUBMIT_TIMEOUT)
+            &&policy==OverflowPolicy::OVERFLOW_CALLER_RUNS){
+            callerRuns.task=sp;
+            status=SubmitStatus::SUBMIT_OK;
+        }
+        //在锁内构造Result：工作线程取到任务之前，结果对象一定已经与任务绑定
+        return Result<T>(sp,status);
+    }
+
+    //等待时长换算为纳秒：超过一年视为一直等待（nanoseconds::max()）
+    template<typename Rep,typename Period>
+    static std::chrono::nanoseconds toWaitLimit(const std::chrono::duration<Rep,Period>&d){
+        using Seconds=std::chrono::duration<double>;
+        if(d<=d.zero())return std::chrono::nanoseconds::zero();
+        if(Seconds(d)>=Seconds(std::chrono::hours(24*365)))return std::chrono::nanoseconds::max();
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(d);
+    }
+
+    //submit()的入队：任务自带结果槽，不需要在锁内绑定结果；caller-runs在释放锁后直接执行
+    SubmitStatus enqueue(std::shared_ptr<TaskBase>sp,OverflowPolicy policy,std::chrono::nanoseconds wait);
+
+    //任务入队（调用方持有taskQueMtx_），队列满时按policy处理，wait为BLOCK的最长等待时间
+    SubmitStatus pushTask(std::unique_lock<std::mutex>&lock,std::shared_ptr<TaskBase>sp,
+        OverflowPolicy policy,std::chrono::nanoseconds wait);
+
     void threadFunc(int threadid);
 
+    //创建并启动一个线程（调用方持有taskQueMtx_）
+    void spawnThread();
+
+    //当前线程退出：把自己的Thread对象移到待回收表（调用方持有taskQueMtx_）
+    void retireSelf(int threadid);
+
+    //从队列取一个任务在当前线程上执行，队列为空时返回false
+    bool runPendingTask();
+
+    //waitFor找不到任务时先yield的次数，之后改为短暂休眠
+    static constexpr int IDLE_YIELD_ROUNDS=64;
+
     bool checkRunningState()const;
 
     private:
 
     //std::vector<std::unique_ptr<Thread>>threads_;
     std::unordered_map<int,std::unique_ptr<Thread>>threads_;
+    int nextThreadId_=0;//下一个线程ID（受taskQueMtx_保护）
+    //已退出、尚未join的线程（受taskQueMtx_保护）：线程不能join自己，由shutdown或之后退出的线程回收
+    std::vector<std::unique_ptr<Thread>>exitedThreads_;
 
     int initThreadSize_;
     std::atomic_int curThreadSize_;
     int threadSizeThreshHold_;
     std::atomic_int idleThreadSize_;
 
-    std::queue<std::shared_ptr<Task>>taskQue_;
+    std::queue<std::shared_ptr<TaskBase>>taskQue_;
     std::atomic_int taskSize_;
     int taskQueMaxThreshHold_;
 
@@ -178,8 +568,17 @@ class ThreadPool{
     std::condition_variable notEmpty_;
     std::condition_variable exitCond_;
 
+    int waitingThreads_=0;//在notEmpty_上休眠的线程数（受taskQueMtx_保护）
+    int waitingProducers_=0;//在notFull_上等待的提交者数（受taskQueMtx_保护）
+    std::atomic<long long>wastedWakeups_{0};
+
     PoolMode poolMode_;
+    OverflowPolicy overflowPolicy_=OverflowPolicy::OVERFLOW_BLOCK;
+    std::chrono::nanoseconds blockTimeout_=std::chrono::seconds(1);
     std::atomic_bool isPoolRunning_;
+    bool isShutdown_=false;//已调用shutdown（受taskQueMtx_保护）
+    bool lazyStart_=false;
+    int lazyPending_=0;//延迟启动时尚未创建的初始线程数（受taskQueMtx_保护）
     
 };
 #endif 
\ No newline at end of file
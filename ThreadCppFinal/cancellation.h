@@ -0,0 +1,84 @@
+#ifndef CANCELLATION_H
+#define CANCELLATION_H
+
+#include<atomic>
+#include<cstdint>
+#include<memory>
+#include<stdexcept>
+#include<utility>
+#if __cplusplus >= 202002L && __has_include(<stop_token>)
+#include<stop_token>
+#endif
+
+// 协作式取消（接口与C++20的 std::stop_source / std::stop_token 对应，C++17下可用）
+// 取消只是置位：已开始执行的任务不会被打断，需要时在任务内部轮询 stop_requested()；
+// 排队中的任务在出队后、调用可调用对象之前检查令牌，已取消的直接跳过
+
+namespace detail {
+
+struct CancelState {
+    std::atomic_bool stopped{false};
+};
+
+} // namespace detail
+
+// 取消令牌（可拷贝，只读）
+class CancellationToken {
+public:
+    CancellationToken() noexcept = default;
+
+    bool stop_requested() const noexcept {
+        return state_ != nullptr && state_->stopped.load(std::memory_order_acquire);
+    }
+
+    // 是否关联了取消源（默认构造的令牌永远不会被取消）
+    bool stop_possible() const noexcept {
+        return state_ != nullptr;
+    }
+
+private:
+    friend class CancellationSource;
+
+    explicit CancellationToken(std::shared_ptr<detail::CancelState> state) noexcept
+        : state_(std::move(state))
+    {}
+
+    std::shared_ptr<detail::CancelState> state_;
+};
+
+// 取消源：发出取消请求，由它取得的所有令牌随之变为已取消
+class CancellationSource {
+public:
+    CancellationSource()
+        : state_(std::make_shared<detail::CancelState>())
+    {}
+
+    CancellationToken get_token() const noexcept {
+        return CancellationToken(state_);
+    }
+
+    // 请求取消，第一次调用返回true
+    bool request_stop() noexcept {
+        return !state_->stopped.exchange(true, std::memory_order_acq_rel);
+    }
+
+    bool stop_requested() const noexcept {
+        return state_->stopped.load(std::memory_order_acquire);
+    }
+
+private:
+    std::shared_ptr<detail::CancelState> state_;
+};
+
+// 任务分组编号（ThreadPool::submitToGroup / cancelGroup），0表示不属于任何组
+using GroupId = std::uint32_t;
+
+// 令牌已取消（或所在组已被cancelGroup）的任务不会执行，其Future在get()时抛出该异常
+class TaskCancelledError : public std::runtime_error {
+public:
+    TaskCancelledError()
+        : std::runtime_error("任务在开始执行之前已被取消")
+    {}
+};
+
+#endif
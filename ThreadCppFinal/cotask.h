@@ -0,0 +1,250 @@
+#ifndef COTASK_H
+#define COTASK_H
+
+// C++20协程支持（编译器未开启协程时本文件为空，其余部分仍可按C++17使用）
+#if defined(__cpp_impl_coroutine) && __cpp_impl_coroutine >= 201902L && __has_include(<coroutine>)
+
+#include<coroutine>
+#include<exception>
+#include<future>
+#include<memory>
+#include<memory_resource>
+#include<new>
+#include<optional>
+#include<type_traits>
+#include<utility>
+#include<cstddef>
+
+#include"slabpool.h"
+
+#define THREADPOOL_HAS_COROUTINES 1
+
+namespace detail {
+
+// 协程帧分配：帧末尾额外存放分配来源（为空表示slab池）
+// 默认按64字节分级放进slab池（每线程空闲链表，分配释放不加锁，可跨线程释放），
+// 超过SLAB_MAX_OBJECT_SIZE的帧走operator new
+const std::size_t CO_FRAME_GRANULE = 64;
+
+inline std::size_t coFrameHeader(std::size_t size) {
+    return (size + alignof(void*) - 1) & ~(alignof(void*) - 1);
+}
+
+template<std::size_t Class>
+inline void* coSlabAllocate(std::size_t cls) {
+    if constexpr (Class * CO_FRAME_GRANULE > SLAB_MAX_OBJECT_SIZE) {
+        return nullptr;
+    } else {
+        if (cls == Class) return SlabPool<Class * CO_FRAME_GRANULE>::allocate();
+        return coSlabAllocate<Class + 1>(cls);
+    }
+}
+
+template<std::size_t Class>
+inline void coSlabDeallocate(std::size_t cls, void* p) noexcept {
+    if constexpr (Class * CO_FRAME_GRANULE <= SLAB_MAX_OBJECT_SIZE) {
+        if (cls == Class) {
+            SlabPool<Class * CO_FRAME_GRANULE>::deallocate(p);
+            return;
+        }
+        coSlabDeallocate<Class + 1>(cls, p);
+    }
+}
+
+inline void* coFrameAllocate(std::size_t size, std::pmr::memory_resource* mr) {
+    std::size_t off = coFrameHeader(size);
+    std::size_t total = off + sizeof(std::pmr::memory_resource*);
+    void* p = nullptr;
+    if (mr != nullptr) {
+        p = mr->allocate(total, alignof(std::max_align_t));
+    } else if (total <= SLAB_MAX_OBJECT_SIZE) {
+        p = coSlabAllocate<1>((total + CO_FRAME_GRANULE - 1) / CO_FRAME_GRANULE);
+    } else {
+        p = ::operator new(total);
+    }
+    *reinterpret_cast<std::pmr::memory_resource**>(static_cast<char*>(p) + off) = mr;
+    return p;
+}
+
+inline void coFrameDeallocate(void* p, std::size_t size) noexcept {
+    std::size_t off = coFrameHeader(size);
+    std::size_t total = off + sizeof(std::pmr::memory_resource*);
+    std::pmr::memory_resource* mr = *reinterpret_cast<std::pmr::memory_resource**>(static_cast<char*>(p) + off);
+    if (mr != nullptr) {
+        mr->deallocate(p, total, alignof(std::max_align_t));
+    } else if (total <= SLAB_MAX_OBJECT_SIZE) {
+        coSlabDeallocate<1>((total + CO_FRAME_GRANULE - 1) / CO_FRAME_GRANULE, p);
+    } else {
+        ::operator delete(p);
+    }
+}
+
+// 协程promise的公共部分：帧分配
+// 协程的前两个参数为 (std::allocator_arg_t, memory_resource*) 时帧从该资源分配，例如：
+//   CoTask<int> parse(std::allocator_arg_t, std::pmr::memory_resource* mr, Buffer buf);
+// 注意：工作线程的TaskArena在每个任务返回后自动reset，而协程挂起后帧仍要保留，
+// 因此只有关闭autoReset、由调用方自己管理生命周期的arena才可以用来分配帧
+struct CoPromiseAlloc {
+    static void* operator new(std::size_t size) {
+        return coFrameAllocate(size, nullptr);
+    }
+
+    template<typename... Args>
+    static void* operator new(std::size_t size, std::allocator_arg_t, std::pmr::memory_resource* mr, Args&...) {
+        return coFrameAllocate(size, mr);
+    }
+
+    static void operator delete(void* p, std::size_t size) noexcept {
+        coFrameDeallocate(p, size);
+    }
+};
+
+// CoTask的结果存放
+template<typename T>
+class CoResult {
+public:
+    template<typename U = T>
+    void return_value(U&& value) {
+        value_.emplace(std::forward<U>(value));
+    }
+
+    void unhandled_exception() noexcept {
+        error_ = std::current_exception();
+    }
+
+    T take() {
+        if (error_) std::rethrow_exception(error_);
+        return std::move(*value_);
+    }
+
+private:
+    std::optional<T> value_;
+    std::exception_ptr error_;
+};
+
+template<>
+class CoResult<void> {
+public:
+    void return_void() noexcept {}
+
+    void unhandled_exception() noexcept {
+        error_ = std::current_exception();
+    }
+
+    void take() {
+        if (error_) std::rethrow_exception(error_);
+    }
+
+private:
+    std::exception_ptr error_;
+};
+
+// 分离运行的驱动协程（立即开始，结束时自行销毁），供ThreadPool::spawn使用
+struct CoDetached {
+    struct promise_type : CoPromiseAlloc {
+        CoDetached get_return_object() noexcept { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { std::terminate(); }
+    };
+};
+
+} // namespace detail
+
+// 惰性启动的协程任务：被co_await时才开始执行，完成后直接恢复等待它的协程（对称转移），
+// 整个过程不阻塞任何线程。只可移动；异常在co_await处重新抛出。
+// 交给线程池运行并取得Future：pool.spawn(task)
+template<typename T = void>
+class CoTask {
+    static_assert(!std::is_reference<T>::value, "CoTask 不支持引用类型的结果");
+
+public:
+    struct promise_type : detail::CoPromiseAlloc, detail::CoResult<T> {
+        std::coroutine_handle<> continuation;  // 完成后恢复的协程
+
+        CoTask get_return_object() noexcept {
+            return CoTask(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+
+        std::suspend_always initial_suspend() noexcept { return {}; }
+
+        struct FinalAwaiter {
+            bool await_ready() noexcept { return false; }
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> h) noexcept {
+                std::coroutine_handle<> next = h.promise().continuation;
+                return next ? next : std::noop_coroutine();
+            }
+            void await_resume() noexcept {}
+        };
+
+        FinalAwaiter final_suspend() noexcept { return {}; }
+    };
+
+    using Handle = std::coroutine_handle<promise_type>;
+
+    CoTask() noexcept = default;
+
+    CoTask(CoTask&& other) noexcept
+        : handle_(std::exchange(other.handle_, nullptr))
+    {}
+
+    CoTask& operator=(CoTask&& other) noexcept {
+        if (this != &other) {
+            if (handle_) handle_.destroy();
+            handle_ = std::exchange(other.handle_, nullptr);
+        }
+        return *this;
+    }
+
+    CoTask(const CoTask&) = delete;
+    CoTask& operator=(const CoTask&) = delete;
+
+    ~CoTask() {
+        if (handle_) handle_.destroy();
+    }
+
+    bool valid() const noexcept {
+        return static_cast<bool>(handle_);
+    }
+
+    bool done() const noexcept {
+        return handle_ && handle_.done();
+    }
+
+    struct Awaiter {
+        Handle handle;
+
+        bool await_ready() const noexcept {
+            return !handle || handle.done();
+        }
+
+        // 记下等待方后转入本任务执行
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+            handle.promise().continuation = awaiting;
+            return handle;
+        }
+
+        T await_resume() {
+            if (!handle) throw std::future_error(std::future_errc::no_state);
+            return handle.promise().take();
+        }
+    };
+
+    Awaiter operator co_await() const& noexcept {
+        return Awaiter{ handle_ };
+    }
+
+    Awaiter operator co_await() const&& noexcept {
+        return Awaiter{ handle_ };
+    }
+
+private:
+    explicit CoTask(Handle h) noexcept : handle_(h) {}
+
+    Handle handle_ = nullptr;
+};
+
+#endif
+
+#endif
@@ -0,0 +1,179 @@
+#ifndef IDLEREGISTRY_H
+#define IDLEREGISTRY_H
+
+#include<atomic>
+#include<mutex>
+#include<condition_variable>
+#include<chrono>
+#include<vector>
+#include<algorithm>
+
+// 空闲线程登记表
+// 每个空闲线程在自己的Waiter上休眠，提交任务时只唤醒其中一个（LIFO，
+// 最近进入空闲的线程缓存最热），避免notify_all造成的惊群。
+// 休眠协议（防止丢失唤醒）：
+//   休眠方: enlist -> 再次检查是否有任务 -> 有则cancel，无则wait
+//   唤醒方: 任务入队 -> notifyOne
+// 两侧都有seq_cst栅栏，保证至少一方能看到对方的写入。
+class IdleRegistry {
+public:
+    // 休眠线程的等待对象（通常位于工作线程栈上）
+    struct Waiter {
+        std::mutex mtx;
+        std::condition_variable cond;
+        bool signaled = false;    // 已被选中唤醒（受mtx保护）
+        bool registered = false;  // 仍在登记表中（受登记表mtx_保护）
+    };
+
+    IdleRegistry() = default;
+    ~IdleRegistry() = default;
+
+    IdleRegistry(const IdleRegistry&) = delete;
+    IdleRegistry& operator=(const IdleRegistry&) = delete;
+
+    // 登记为空闲（之后调用方必须再次检查任务，再调用wait或cancel）
+    void enlist(Waiter* w) {
+        {
+            std::lock_guard<std::mutex> lock(w->mtx);
+            w->signaled = false;
+        }
+        std::lock_guard<std::mutex> lock(mtx_);
+        waiters_.push_back(w);
+        w->registered = true;
+        idleCount_.fetch_add(1, std::memory_order_seq_cst);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+
+    // 取消登记；返回true表示仍在表中被成功移除，false表示已被唤醒方选中
+    bool cancel(Waiter* w) {
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            if (w->registered) {
+                waiters_.erase(std::find(waiters_.begin(), waiters_.end(), w));
+                w->registered = false;
+                idleCount_.fetch_sub(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        // 已被唤醒方选中：等它完成通知，之后Waiter才能安全复用或销毁
+        wait(w);
+        return false;
+    }
+
+    // 无限等待直到被唤醒
+    void wait(Waiter* w) {
+        std::unique_lock<std::mutex> lock(w->mtx);
+        w->cond.wait(lock, [&]()->bool { return w->signaled; });
+    }
+
+    // 带超时的等待，超时返回false（调用方随后应调用cancel）
+    template<typename Rep, typename Period>
+    bool waitFor(Waiter* w, const std::chrono::duration<Rep, Period>& timeout) {
+        std::unique_lock<std::mutex> lock(w->mtx);
+        return w->cond.wait_for(lock, timeout, [&]()->bool { return w->signaled; });
+    }
+
+    // 唤醒一个空闲线程，没有空闲线程时返回false（无空闲线程时不加锁）
+    bool notifyOne() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (idleCount_.load(std::memory_order_relaxed) == 0) return false;
+
+        Waiter* w = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            if (waiters_.empty()) return false;
+            w = waiters_.back();
+            waiters_.pop_back();
+            w->registered = false;
+            idleCount_.fetch_sub(1, std::memory_order_relaxed);
+        }
+        signal(w);
+        return true;
+    }
+
+    // 唤醒指定的线程（只有它能执行的任务入队时使用），它不在登记表中时返回false
+    bool notify(Waiter* w) {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (idleCount_.load(std::memory_order_relaxed) == 0) return false;
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            if (!w->registered) return false;
+            waiters_.erase(std::find(waiters_.begin(), waiters_.end(), w));
+            w->registered = false;
+            idleCount_.fetch_sub(1, std::memory_order_relaxed);
+        }
+        signal(w);
+        return true;
+    }
+
+    // 唤醒登记最早（空闲最久、缓存最冷）的线程，用于回收多余线程
+    bool notifyOldest() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (idleCount_.load(std::memory_order_relaxed) == 0) return false;
+
+        Waiter* w = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            if (waiters_.empty()) return false;
+            w = waiters_.front();
+            waiters_.erase(waiters_.begin());
+            w->registered = false;
+            idleCount_.fetch_sub(1, std::memory_order_relaxed);
+        }
+        signal(w);
+        return true;
+    }
+
+    // 唤醒至多n个空闲线程（批量提交时使用，只加一次锁），返回实际唤醒数
+    int notifyMany(int n) {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (n <= 0 || idleCount_.load(std::memory_order_relaxed) == 0) return 0;
+
+        Waiter* picked[64];
+        int count = 0;
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            while (count < n && count < 64 && !waiters_.empty()) {
+                Waiter* w = waiters_.back();
+                waiters_.pop_back();
+                w->registered = false;
+                picked[count++] = w;
+            }
+            idleCount_.fetch_sub(count, std::memory_order_relaxed);
+        }
+        for (int i = 0; i < count; i++) signal(picked[i]);
+        return count;
+    }
+
+    // 唤醒所有空闲线程（关闭线程池时使用）
+    void notifyAll() {
+        std::vector<Waiter*> all;
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            all.swap(waiters_);
+            for (Waiter* w : all) w->registered = false;
+            idleCount_.store(0, std::memory_order_relaxed);
+        }
+        for (Waiter* w : all) signal(w);
+    }
+
+    // 当前登记的空闲线程数（近似值）
+    int idleCount() const {
+        return idleCount_.load(std::memory_order_relaxed);
+    }
+
+private:
+    // 在持有Waiter锁时通知，保证休眠方返回前通知已完成
+    static void signal(Waiter* w) {
+        std::lock_guard<std::mutex> lock(w->mtx);
+        w->signaled = true;
+        w->cond.notify_one();
+    }
+
+private:
+    std::mutex mtx_;                 // 保护waiters_
+    std::vector<Waiter*> waiters_;   // 空闲线程栈
+    std::atomic_int idleCount_{0};   // 登记数量（供唤醒方无锁快速判断）
+};
+
+#endif
@@ -0,0 +1,790 @@
+#ifndef IOREACTOR_H
+#define IOREACTOR_H
+
+// 异步I/O反应器：任务提交读/写/accept后立即返回，完成时回调（或协程恢复）投递回线程池执行，
+// 等待I/O期间不占用工作线程，CPU任务和I/O任务可以共用一个线程池。
+// 后端优先使用io_uring（直接系统调用，不依赖liburing），内核不支持时退回epoll。
+// 仅Linux可用（定义THREADPOOL_HAS_IO_REACTOR）。
+#if defined(__linux__)
+
+#include<atomic>
+#include<mutex>
+#include<algorithm>
+#include<unordered_map>
+#include<utility>
+#include<cerrno>
+#include<cstdint>
+#include<cstring>
+#include<cstddef>
+
+#include<unistd.h>
+#include<fcntl.h>
+#include<poll.h>
+#include<sys/epoll.h>
+#include<sys/eventfd.h>
+#include<sys/mman.h>
+#include<sys/socket.h>
+#include<sys/stat.h>
+#include<sys/syscall.h>
+
+#if __has_include(<linux/io_uring.h>) && defined(__NR_io_uring_setup)
+#include<linux/io_uring.h>
+#define THREADPOOL_HAS_IO_URING 1
+#endif
+
+#include"taskfunction.h"
+#include"taskfuture.h"
+#include"slabpool.h"
+#include"cotask.h"
+#include"poollog.h"
+
+#define THREADPOOL_HAS_IO_REACTOR 1
+
+// io_uring提交队列的默认长度
+const unsigned IO_RING_DEFAULT_ENTRIES = 256;
+// epoll后端每次epoll_wait最多取回的事件数
+const int IO_EPOLL_BATCH = 64;
+
+// 反应器后端
+enum class IoBackend {
+    BACKEND_AUTO,   // 优先io_uring，不可用时退回epoll（构造参数）
+    BACKEND_URING,  // io_uring：内核完成I/O，适用于任意fd（包括普通文件）
+    BACKEND_EPOLL,  // epoll：就绪后由收割线程执行系统调用（收割线程不会阻塞在系统调用里，
+                    // 阻塞模式的fd有限制，见IoReactor::submitEpoll）
+    BACKEND_NONE,   // 初始化失败，所有操作以 -ENOSYS 完成
+};
+
+// I/O操作类型
+enum class IoOpcode {
+    IO_READ,    // read/pread
+    IO_WRITE,   // write/pwrite
+    IO_RECV,    // recv
+    IO_SEND,    // send
+    IO_ACCEPT,  // accept4
+};
+
+// 一次I/O请求的参数（缓冲区在操作完成前必须保持有效）
+struct IoRequest {
+    IoOpcode opcode = IoOpcode::IO_READ;
+    int fd = -1;
+    void* buf = nullptr;           // accept时为sockaddr*（可为空）
+    std::size_t len = 0;
+    std::int64_t offset = -1;      // read/write的文件偏移，-1表示使用并推进当前位置
+    int flags = 0;                 // recv/send为MSG_*，accept为SOCK_NONBLOCK/SOCK_CLOEXEC
+    socklen_t* addrlen = nullptr;  // accept的地址长度（输入输出）
+
+    static IoRequest read(int fd, void* buf, std::size_t len, std::int64_t offset = -1) {
+        IoRequest req;
+        req.opcode = IoOpcode::IO_READ;
+        req.fd = fd;
+        req.buf = buf;
+        req.len = len;
+        req.offset = offset;
+        return req;
+    }
+
+    static IoRequest write(int fd, const void* buf, std::size_t len, std::int64_t offset = -1) {
+        IoRequest req = read(fd, const_cast<void*>(buf), len, offset);
+        req.opcode = IoOpcode::IO_WRITE;
+        return req;
+    }
+
+    static IoRequest recv(int fd, void* buf, std::size_t len, int flags = 0) {
+        IoRequest req = read(fd, buf, len);
+        req.opcode = IoOpcode::IO_RECV;
+        req.flags = flags;
+        return req;
+    }
+
+    static IoRequest send(int fd, const void* buf, std::size_t len, int flags = 0) {
+        IoRequest req = recv(fd, const_cast<void*>(buf), len, flags);
+        req.opcode = IoOpcode::IO_SEND;
+        return req;
+    }
+
+    static IoRequest accept(int fd, sockaddr* addr = nullptr, socklen_t* addrlen = nullptr, int flags = 0) {
+        IoRequest req;
+        req.opcode = IoOpcode::IO_ACCEPT;
+        req.fd = fd;
+        req.buf = addr;
+        req.addrlen = addrlen;
+        req.flags = flags;
+        return req;
+    }
+
+    bool isWrite() const {
+        return opcode == IoOpcode::IO_WRITE || opcode == IoOpcode::IO_SEND;
+    }
+};
+
+// 进行中的I/O操作（侵入式，由提交方分配，complete被调用前不得释放）
+// result：成功为字节数（accept为新fd），失败为 -errno（与io_uring的约定一致）
+struct IoOp {
+    IoRequest req;
+    long result = 0;
+    void (*complete)(IoOp* op) = nullptr;  // 完成回调
+    IoOp* next = nullptr;                  // 反应器内部链表
+    bool once = false;                     // 反应器内部：epoll后端阻塞fd上的读，每次就绪只执行一个
+};
+
+namespace detail {
+
+// 回调形式的操作：完成时先释放自身再调用回调（回调中可以直接提交下一个操作）
+template<typename F>
+struct IoCallbackOp : IoOp {
+    F fn;
+
+    explicit IoCallbackOp(F&& f) : fn(std::move(f)) {}
+
+    static void run(IoOp* base) {
+        IoCallbackOp* self = static_cast<IoCallbackOp*>(base);
+        long result = self->result;
+        F fn = std::move(self->fn);
+        self->~IoCallbackOp();
+        slabDeallocate<IoCallbackOp>(self);
+        fn(result);
+    }
+};
+
+// 同步执行一次I/O系统调用（epoll后端就绪后调用，或fd不支持epoll时直接调用）
+inline long performIo(const IoRequest& req) {
+    for (;;) {
+        long r = -1;
+        switch (req.opcode) {
+        case IoOpcode::IO_READ:
+            r = req.offset < 0 ? ::read(req.fd, req.buf, req.len)
+                               : ::pread(req.fd, req.buf, req.len, req.offset);
+            break;
+        case IoOpcode::IO_WRITE:
+            r = req.offset < 0 ? ::write(req.fd, req.buf, req.len)
+                               : ::pwrite(req.fd, req.buf, req.len, req.offset);
+            break;
+        case IoOpcode::IO_RECV:
+            r = ::recv(req.fd, req.buf, req.len, req.flags | MSG_DONTWAIT);
+            break;
+        case IoOpcode::IO_SEND:
+            r = ::send(req.fd, req.buf, req.len, req.flags | MSG_DONTWAIT);
+            break;
+        case IoOpcode::IO_ACCEPT:
+            r = ::accept4(req.fd, static_cast<sockaddr*>(req.buf), req.addrlen, req.flags);
+            break;
+        }
+        if (r >= 0) return r;
+        if (errno != EINTR) return -errno;
+    }
+}
+
+} // namespace detail
+
+// I/O反应器：任意线程提交操作，由poll()收割完成事件并分发
+// 同一时刻只有一个线程在收割（其他线程调用poll()立即返回0）。
+// 挂到线程池上（ThreadPool::setIoReactor）后由工作线程驱动：空闲线程休眠前先收割一次，
+// 其中一个空闲线程阻塞在反应器上等待I/O，有新任务时被唤醒；完成回调作为任务投递回线程池。
+// 注意：操作完成前不要关闭fd，也不要销毁反应器
+class IoReactor {
+public:
+    explicit IoReactor(unsigned entries = IO_RING_DEFAULT_ENTRIES, IoBackend backend = IoBackend::BACKEND_AUTO) {
+        wakeFd_ = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (wakeFd_ < 0) {
+            POOL_LOG_ERROR("创建eventfd失败: %s", std::strerror(errno));
+            return;
+        }
+#if defined(THREADPOOL_HAS_IO_URING)
+        if (backend != IoBackend::BACKEND_EPOLL && setupUring(entries)) {
+            backend_ = IoBackend::BACKEND_URING;
+            return;
+        }
+#endif
+        if (backend != IoBackend::BACKEND_URING && setupEpoll()) {
+            backend_ = IoBackend::BACKEND_EPOLL;
+            return;
+        }
+        POOL_LOG_ERROR("I/O反应器初始化失败，所有操作将以ENOSYS完成");
+    }
+
+    ~IoReactor() {
+#if defined(THREADPOOL_HAS_IO_URING)
+        if (sqRing_ != nullptr) ::munmap(sqRing_, sqRingSize_);
+        if (cqRing_ != nullptr && cqRing_ != sqRing_) ::munmap(cqRing_, cqRingSize_);
+        if (sqes_ != nullptr) ::munmap(sqes_, sqesSize_);
+        if (ringFd_ >= 0) ::close(ringFd_);
+#endif
+        if (epollFd_ >= 0) ::close(epollFd_);
+        if (wakeFd_ >= 0) ::close(wakeFd_);
+    }
+
+    IoReactor(const IoReactor&) = delete;
+    IoReactor& operator=(const IoReactor&) = delete;
+
+    IoBackend backend() const {
+        return backend_;
+    }
+
+    bool valid() const {
+        return backend_ != IoBackend::BACKEND_NONE;
+    }
+
+    // 完成回调的投递方式（在提交任何操作前设置），为空时在收割线程上就地执行
+    void setExecutor(FutureExecutor executor) {
+        executor_ = executor;
+    }
+
+    // 尚未完成的操作数
+    std::size_t pending() const {
+        return pending_.load(std::memory_order_relaxed);
+    }
+
+    // 提交一个操作（底层接口）：完成时调用op->complete(op)
+    void submit(IoOp* op) {
+        pending_.fetch_add(1, std::memory_order_relaxed);
+        switch (backend_) {
+#if defined(THREADPOOL_HAS_IO_URING)
+        case IoBackend::BACKEND_URING:
+            submitUring(op);
+            return;
+#endif
+        case IoBackend::BACKEND_EPOLL:
+            submitEpoll(op);
+            return;
+        default:
+            op->result = -ENOSYS;
+            finish(op);
+            return;
+        }
+    }
+
+    // 回调形式：callback(long result)
+    template<typename F>
+    void submitIo(const IoRequest& req, F&& callback) {
+        using Op = detail::IoCallbackOp<std::decay_t<F>>;
+        Op* op = new (slabAllocate<Op>()) Op(std::decay_t<F>(std::forward<F>(callback)));
+        op->req = req;
+        op->complete = &Op::run;
+        submit(op);
+    }
+
+    // Future形式：结果为字节数或 -errno，then()续延经setExecutor指定的调度器投递
+    Future<long> submitIo(const IoRequest& req) {
+        Promise<long> promise(executor_);
+        Future<long> result = promise.get_future();
+        submitIo(req, [p = std::move(promise)](long r) mutable { p.set_value(r); });
+        return result;
+    }
+
+#if defined(THREADPOOL_HAS_COROUTINES)
+    // 协程形式：long n = co_await reactor.awaitIo(IoRequest::recv(fd, buf, len));
+    // 操作状态存放在协程帧内，不额外分配内存
+    class IoAwaiter : private IoOp {
+    public:
+        IoAwaiter(IoReactor* reactor, const IoRequest& request)
+            : reactor_(reactor)
+        {
+            req = request;
+            complete = &IoAwaiter::resume;
+        }
+
+        bool await_ready() const noexcept { return false; }
+
+        void await_suspend(std::coroutine_handle<> handle) {
+            handle_ = handle;
+            reactor_->submit(this);  // 之后可能已在其他线程恢复，不再访问this
+        }
+
+        long await_resume() const noexcept { return result; }
+
+    private:
+        static void resume(IoOp* op) {
+            static_cast<IoAwaiter*>(op)->handle_.resume();
+        }
+
+        IoReactor* reactor_;
+        std::coroutine_handle<> handle_;
+    };
+
+    IoAwaiter awaitIo(const IoRequest& req) {
+        return IoAwaiter(this, req);
+    }
+#endif
+
+    // 收割已完成的操作并分发，返回分发的数量
+    // timeoutMs：0不等待，-1一直等到有完成事件或被wake()唤醒
+    int poll(int timeoutMs = 0) {
+        if (reaping_.exchange(true, std::memory_order_acquire)) return 0;
+        IoOp* done = nullptr;
+        switch (backend_) {
+#if defined(THREADPOOL_HAS_IO_URING)
+        case IoBackend::BACKEND_URING:
+            done = reapUring(timeoutMs);
+            break;
+#endif
+        case IoBackend::BACKEND_EPOLL:
+            done = reapEpoll(timeoutMs);
+            break;
+        default:
+            break;
+        }
+        reaping_.store(false, std::memory_order_release);
+
+        int count = 0;
+        while (done != nullptr) {
+            IoOp* op = done;
+            done = op->next;
+            finish(op);
+            count++;
+        }
+        return count;
+    }
+
+    // 唤醒阻塞在poll()中的线程（没有线程在等待时，下一次阻塞的poll()立即返回）
+    void wake() {
+        std::uint64_t one = 1;
+        ssize_t r = ::write(wakeFd_, &one, sizeof(one));
+        (void)r;
+    }
+
+private:
+    // 分发一个已完成的操作
+    void finish(IoOp* op) {
+        pending_.fetch_sub(1, std::memory_order_relaxed);
+        if (executor_.post != nullptr) {
+            executor_.post(executor_.ctx, TaskFunction([op]() { op->complete(op); }));
+        } else {
+            op->complete(op);
+        }
+    }
+
+    void drainWake() {
+        std::uint64_t value;
+        ssize_t r = ::read(wakeFd_, &value, sizeof(value));
+        (void)r;
+    }
+
+#if defined(THREADPOOL_HAS_IO_URING)
+    static int uringEnter(int fd, unsigned toSubmit, unsigned minComplete, unsigned flags) {
+        return static_cast<int>(::syscall(__NR_io_uring_enter, fd, toSubmit, minComplete, flags, nullptr, 0));
+    }
+
+    // 建立io_uring并映射提交/完成队列；要求内核支持IORING_OP_READ等操作（5.6+）
+    bool setupUring(unsigned entries) {
+        io_uring_params params;
+        std::memset(&params, 0, sizeof(params));
+        int fd = static_cast<int>(::syscall(__NR_io_uring_setup, entries, &params));
+        if (fd < 0) {
+            POOL_LOG_INFO("io_uring不可用（%s），使用epoll", std::strerror(errno));
+            return false;
+        }
+        const unsigned required = IORING_FEAT_NODROP | IORING_FEAT_RW_CUR_POS;
+        if ((params.features & required) != required) {
+            POOL_LOG_INFO("内核io_uring版本过低，使用epoll");
+            ::close(fd);
+            return false;
+        }
+        ringFd_ = fd;
+
+        sqRingSize_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cqRingSize_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        bool single = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (single) sqRingSize_ = cqRingSize_ = std::max(sqRingSize_, cqRingSize_);
+
+        void* sq = ::mmap(nullptr, sqRingSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+        if (sq == MAP_FAILED) return failUring();
+        sqRing_ = sq;
+        void* cq = sq;
+        if (!single) {
+            cq = ::mmap(nullptr, cqRingSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+            if (cq == MAP_FAILED) return failUring();
+        }
+        cqRing_ = cq;
+        sqesSize_ = params.sq_entries * sizeof(io_uring_sqe);
+        void* sqes = ::mmap(nullptr, sqesSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+        if (sqes == MAP_FAILED) return failUring();
+        sqes_ = static_cast<io_uring_sqe*>(sqes);
+
+        char* sqBase = static_cast<char*>(sqRing_);
+        sqHead_ = reinterpret_cast<unsigned*>(sqBase + params.sq_off.head);
+        sqTail_ = reinterpret_cast<unsigned*>(sqBase + params.sq_off.tail);
+        sqMask_ = *reinterpret_cast<unsigned*>(sqBase + params.sq_off.ring_mask);
+        sqEntries_ = params.sq_entries;
+        sqFlags_ = reinterpret_cast<unsigned*>(sqBase + params.sq_off.flags);
+        sqArray_ = reinterpret_cast<unsigned*>(sqBase + params.sq_off.array);
+
+        char* cqBase = static_cast<char*>(cqRing_);
+        cqHead_ = reinterpret_cast<unsigned*>(cqBase + params.cq_off.head);
+        cqTail_ = reinterpret_cast<unsigned*>(cqBase + params.cq_off.tail);
+        cqMask_ = *reinterpret_cast<unsigned*>(cqBase + params.cq_off.ring_mask);
+        cqes_ = reinterpret_cast<io_uring_cqe*>(cqBase + params.cq_off.cqes);
+        return true;
+    }
+
+    bool failUring() {
+        POOL_LOG_WARN("io_uring映射失败（%s），使用epoll", std::strerror(errno));
+        if (sqRing_ != nullptr) ::munmap(sqRing_, sqRingSize_);
+        ::close(ringFd_);
+        ringFd_ = -1;
+        sqRing_ = nullptr;
+        return false;
+    }
+
+    // 填写提交项后立即io_uring_enter（不使用SQPOLL，提交项在enter时被内核取走）
+    void submitUring(IoOp* op) {
+        std::unique_lock<std::mutex> lock(sqMtx_);
+        unsigned tail = *sqTail_;
+        unsigned head = __atomic_load_n(sqHead_, __ATOMIC_ACQUIRE);
+        if (tail - head >= sqEntries_) {
+            // 之前的enter失败留下了未提交项，先尝试提交
+            uringEnter(ringFd_, tail - head, 0, 0);
+            head = __atomic_load_n(sqHead_, __ATOMIC_ACQUIRE);
+            if (tail - head >= sqEntries_) {
+                lock.unlock();
+                op->result = -EBUSY;
+                finish(op);
+                return;
+            }
+        }
+
+        unsigned index = tail & sqMask_;
+        io_uring_sqe* sqe = &sqes_[index];
+        std::memset(sqe, 0, sizeof(*sqe));
+        const IoRequest& req = op->req;
+        sqe->fd = req.fd;
+        sqe->addr = reinterpret_cast<std::uint64_t>(req.buf);
+        sqe->len = static_cast<std::uint32_t>(req.len);
+        sqe->user_data = reinterpret_cast<std::uint64_t>(op);
+        switch (req.opcode) {
+        case IoOpcode::IO_READ:
+            sqe->opcode = IORING_OP_READ;
+            sqe->off = static_cast<std::uint64_t>(req.offset);
+            break;
+        case IoOpcode::IO_WRITE:
+            sqe->opcode = IORING_OP_WRITE;
+            sqe->off = static_cast<std::uint64_t>(req.offset);
+            break;
+        case IoOpcode::IO_RECV:
+            sqe->opcode = IORING_OP_RECV;
+            sqe->msg_flags = static_cast<std::uint32_t>(req.flags);
+            break;
+        case IoOpcode::IO_SEND:
+            sqe->opcode = IORING_OP_SEND;
+            sqe->msg_flags = static_cast<std::uint32_t>(req.flags);
+            break;
+        case IoOpcode::IO_ACCEPT:
+            sqe->opcode = IORING_OP_ACCEPT;
+            sqe->len = 0;
+            sqe->addr2 = reinterpret_cast<std::uint64_t>(req.addrlen);
+            sqe->accept_flags = static_cast<std::uint32_t>(req.flags);
+            break;
+        }
+        sqArray_[index] = index;
+        __atomic_store_n(sqTail_, tail + 1, __ATOMIC_RELEASE);
+        flushUring(tail + 1 - head);
+    }
+
+    // 调用方持有sqMtx_；EBUSY/EAGAIN（完成队列积压）时留到下次提交或收割时重试
+    void flushUring(unsigned toSubmit) {
+        int r;
+        do {
+            r = uringEnter(ringFd_, toSubmit, 0, 0);
+        } while (r < 0 && errno == EINTR);
+        if (r < 0) {
+            if (errno != EBUSY && errno != EAGAIN) {
+                POOL_LOG_WARN("io_uring_enter失败: %s", std::strerror(errno));
+            }
+            unsubmitted_.store(true, std::memory_order_relaxed);
+        }
+    }
+
+    // 收割线程调用（同一时刻只有一个）
+    IoOp* reapUring(int timeoutMs) {
+        if (unsubmitted_.exchange(false, std::memory_order_relaxed)) {
+            std::lock_guard<std::mutex> lock(sqMtx_);
+            unsigned toSubmit = *sqTail_ - __atomic_load_n(sqHead_, __ATOMIC_ACQUIRE);
+            if (toSubmit > 0) flushUring(toSubmit);
+        }
+        // 内核缓存了溢出的完成项，enter一次让它们写回完成队列
+        if (__atomic_load_n(sqFlags_, __ATOMIC_RELAXED) & IORING_SQ_CQ_OVERFLOW) {
+            uringEnter(ringFd_, 0, 0, IORING_ENTER_GETEVENTS);
+        }
+
+        IoOp* done = collectUring();
+        if (done != nullptr || timeoutMs == 0) return done;
+
+        // 同时等待完成队列（ring fd可读）和唤醒事件
+        pollfd fds[2];
+        fds[0].fd = ringFd_;
+        fds[0].events = POLLIN;
+        fds[1].fd = wakeFd_;
+        fds[1].events = POLLIN;
+        if (::poll(fds, 2, timeoutMs) > 0 && (fds[1].revents & POLLIN)) drainWake();
+        return collectUring();
+    }
+
+    IoOp* collectUring() {
+        unsigned head = *cqHead_;
+        unsigned tail = __atomic_load_n(cqTail_, __ATOMIC_ACQUIRE);
+        if (head == tail) return nullptr;
+        // 操作经内核交接：与提交方对sqTail_的release配对，保证读到IoOp的内容（也让TSan看到先后关系）
+        (void)__atomic_load_n(sqTail_, __ATOMIC_ACQUIRE);
+        IoOp* done = nullptr;
+        IoOp** link = &done;
+        for (; head != tail; head++) {
+            io_uring_cqe* cqe = &cqes_[head & cqMask_];
+            IoOp* op = reinterpret_cast<IoOp*>(cqe->user_data);
+            op->result = cqe->res;
+            op->next = nullptr;
+            *link = op;
+            link = &op->next;
+        }
+        __atomic_store_n(cqHead_, head, __ATOMIC_RELEASE);
+        return done;
+    }
+#endif
+
+    // epoll后端：每个fd的读/写等待队列（先进先出），fd以EPOLLONESHOT注册，
+    // 就绪后收割线程取出就绪方向的队列，在fdMtx_之外按顺序执行系统调用，直到EAGAIN，
+    // 再把未完成的操作放回队首并重新注册
+    struct FdWaiters {
+        IoOp* readHead = nullptr;
+        IoOp* readTail = nullptr;
+        IoOp* writeHead = nullptr;
+        IoOp* writeTail = nullptr;
+        bool registered = false;
+        bool busy = false;  // 收割线程已取出操作、正在锁外执行（期间不移除表项）
+    };
+
+    bool setupEpoll() {
+        epollFd_ = ::epoll_create1(EPOLL_CLOEXEC);
+        if (epollFd_ < 0) {
+            POOL_LOG_ERROR("epoll_create1失败: %s", std::strerror(errno));
+            return false;
+        }
+        epoll_event ev;
+        std::memset(&ev, 0, sizeof(ev));
+        ev.events = EPOLLIN;
+        ev.data.fd = wakeFd_;
+        if (::epoll_ctl(epollFd_, EPOLL_CTL_ADD, wakeFd_, &ev) < 0) {
+            POOL_LOG_ERROR("注册eventfd失败: %s", std::strerror(errno));
+            ::close(epollFd_);
+            epollFd_ = -1;
+            return false;
+        }
+        return true;
+    }
+
+    static void pushOp(IoOp*& head, IoOp*& tail, IoOp* op) {
+        op->next = nullptr;
+        if (tail != nullptr) tail->next = op;
+        else head = op;
+        tail = op;
+    }
+
+    // 从队列中移除op（op是最后加入的，一般在队尾）
+    static void removeOp(IoOp*& head, IoOp*& tail, IoOp* op) {
+        IoOp* prev = nullptr;
+        for (IoOp* cur = head; cur != nullptr; prev = cur, cur = cur->next) {
+            if (cur != op) continue;
+            if (prev != nullptr) prev->next = op->next;
+            else head = op->next;
+            if (tail == op) tail = prev;
+            op->next = nullptr;
+            return;
+        }
+    }
+
+    // 把未完成的操作链表list放回队首（之后提交的操作排在它们后面）
+    static void restoreOps(IoOp*& head, IoOp*& tail, IoOp* list) {
+        if (list == nullptr) return;
+        IoOp* last = list;
+        while (last->next != nullptr) last = last->next;
+        last->next = head;
+        if (head == nullptr) tail = last;
+        head = list;
+    }
+
+    // 调用方持有fdMtx_；返回false表示该fd不支持epoll（例如普通文件）
+    bool armFd(int fd, FdWaiters& w) {
+        epoll_event ev;
+        std::memset(&ev, 0, sizeof(ev));
+        ev.events = EPOLLONESHOT;
+        if (w.readHead != nullptr) ev.events |= EPOLLIN;
+        if (w.writeHead != nullptr) ev.events |= EPOLLOUT;
+        ev.data.fd = fd;
+        int r = ::epoll_ctl(epollFd_, w.registered ? EPOLL_CTL_MOD : EPOLL_CTL_ADD, fd, &ev);
+        if (r == 0) {
+            w.registered = true;
+            return true;
+        }
+        if (errno == EPERM || errno == EBADF) return false;
+        POOL_LOG_WARN("epoll_ctl(fd=%d)失败: %s", fd, std::strerror(errno));
+        return false;
+    }
+
+    // 阻塞模式的fd：调整操作使收割线程执行它时不会阻塞，无法保证时返回false
+    //   - recv/send总带MSG_DONTWAIT；套接字上的read/write改为recv/send
+    //   - 管道等非套接字fd上的read每次就绪只执行一个（就绪后的一次read必定立即返回）
+    //   - 非套接字fd上的write（可能写不完整块而阻塞）和阻塞监听套接字上的accept不支持
+    // 普通文件不支持epoll，照常同步执行（磁盘读写不会无限期阻塞）
+    static bool prepareBlocking(IoOp* op) {
+        IoRequest& req = op->req;
+        if (req.opcode == IoOpcode::IO_RECV || req.opcode == IoOpcode::IO_SEND) return true;
+        struct stat st;
+        if (::fstat(req.fd, &st) < 0) return true;  // 无效fd：注册失败后同步执行得到错误码
+        if (S_ISREG(st.st_mode) || S_ISDIR(st.st_mode) || S_ISBLK(st.st_mode)) return true;
+        if (S_ISSOCK(st.st_mode)) {
+            if (req.opcode == IoOpcode::IO_ACCEPT || req.offset >= 0) return false;
+            req.opcode = req.opcode == IoOpcode::IO_READ ? IoOpcode::IO_RECV : IoOpcode::IO_SEND;
+            req.flags = 0;
+            return true;
+        }
+        if (req.opcode != IoOpcode::IO_READ) return false;
+        op->once = true;
+        return true;
+    }
+
+    void submitEpoll(IoOp* op) {
+        int fd = op->req.fd;
+        int fl = ::fcntl(fd, F_GETFL);
+        if (fl >= 0 && (fl & O_NONBLOCK) == 0 && !prepareBlocking(op)) {
+            POOL_LOG_WARN("epoll后端不支持阻塞fd(%d)上的该操作，请使用非阻塞fd", fd);
+            op->result = -EINVAL;
+            finish(op);
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(fdMtx_);
+            FdWaiters& w = fds_[fd];
+            if (op->req.isWrite()) pushOp(w.writeHead, w.writeTail, op);
+            else pushOp(w.readHead, w.readTail, op);
+            if (armFd(fd, w)) return;
+            // 注册失败（普通文件、fd已关闭）：直接同步执行；收割线程正在处理该fd时由它清理表项
+            if (op->req.isWrite()) removeOp(w.writeHead, w.writeTail, op);
+            else removeOp(w.readHead, w.readTail, op);
+            if (!w.busy && w.readHead == nullptr && w.writeHead == nullptr) fds_.erase(fd);
+        }
+        op->result = detail::performIo(op->req);
+        finish(op);
+    }
+
+    IoOp* reapEpoll(int timeoutMs) {
+        epoll_event events[IO_EPOLL_BATCH];
+        int n;
+        do {
+            n = ::epoll_wait(epollFd_, events, IO_EPOLL_BATCH, timeoutMs);
+        } while (n < 0 && errno == EINTR);
+
+        IoOp* done = nullptr;
+        IoOp** link = &done;
+        for (int i = 0; i < n; i++) {
+            int fd = events[i].data.fd;
+            if (fd == wakeFd_) {
+                drainWake();
+                continue;
+            }
+            // 取出就绪方向的队列，系统调用在锁外执行，不阻塞其他线程提交
+            const std::uint32_t hangup = EPOLLERR | EPOLLHUP;
+            IoOp* reads = nullptr;
+            IoOp* writes = nullptr;
+            {
+                std::lock_guard<std::mutex> lock(fdMtx_);
+                auto it = fds_.find(fd);
+                if (it == fds_.end()) continue;
+                FdWaiters& w = it->second;
+                if (events[i].events & (EPOLLIN | hangup)) {
+                    reads = w.readHead;
+                    w.readHead = w.readTail = nullptr;
+                }
+                if (events[i].events & (EPOLLOUT | hangup)) {
+                    writes = w.writeHead;
+                    w.writeHead = w.writeTail = nullptr;
+                }
+                w.busy = true;
+            }
+            reads = runReady(reads, link);
+            writes = runReady(writes, link);
+
+            std::lock_guard<std::mutex> lock(fdMtx_);
+            auto it = fds_.find(fd);  // busy期间表项不会被移除
+            FdWaiters& w = it->second;
+            w.busy = false;
+            restoreOps(w.readHead, w.readTail, reads);
+            restoreOps(w.writeHead, w.writeTail, writes);
+            if (w.readHead == nullptr && w.writeHead == nullptr) {
+                ::epoll_ctl(epollFd_, EPOLL_CTL_DEL, fd, nullptr);
+                fds_.erase(it);
+            } else if (!armFd(fd, w)) {
+                // 重新注册失败（fd已被关闭等）：剩余操作以错误完成
+                int err = -errno;
+                failAll(w.readHead, err, link);
+                failAll(w.writeHead, err, link);
+                fds_.erase(it);
+            }
+        }
+        return done;
+    }
+
+    // 按顺序执行就绪方向上的操作，直到某个返回EAGAIN；完成的操作追加到link，返回未完成的链表
+    // 阻塞fd上的读（once）只在本次就绪的第一个位置执行，执行后停止
+    static IoOp* runReady(IoOp* head, IoOp**& link) {
+        bool ran = false;
+        while (head != nullptr) {
+            if (head->once && ran) break;
+            long r = detail::performIo(head->req);
+            if (r == -EAGAIN) break;
+            IoOp* op = head;
+            head = op->next;
+            op->result = r;
+            op->next = nullptr;
+            *link = op;
+            link = &op->next;
+            ran = true;
+            if (op->once) break;
+        }
+        return head;
+    }
+
+    static void failAll(IoOp* head, int err, IoOp**& link) {
+        while (head != nullptr) {
+            IoOp* op = head;
+            head = op->next;
+            op->result = err;
+            op->next = nullptr;
+            *link = op;
+            link = &op->next;
+        }
+    }
+
+    IoBackend backend_ = IoBackend::BACKEND_NONE;
+    FutureExecutor executor_;
+    int wakeFd_ = -1;
+    std::atomic_bool reaping_{false};      // 是否有线程正在收割
+    std::atomic<std::size_t> pending_{0};  // 未完成的操作数
+
+#if defined(THREADPOOL_HAS_IO_URING)
+    int ringFd_ = -1;
+    std::mutex sqMtx_;                      // 提交队列只允许一个生产者
+    std::atomic_bool unsubmitted_{false};   // 有提交项因enter失败尚未交给内核
+    void* sqRing_ = nullptr;
+    void* cqRing_ = nullptr;
+    std::size_t sqRingSize_ = 0;
+    std::size_t cqRingSize_ = 0;
+    io_uring_sqe* sqes_ = nullptr;
+    std::size_t sqesSize_ = 0;
+    unsigned* sqHead_ = nullptr;
+    unsigned* sqTail_ = nullptr;
+    unsigned* sqFlags_ = nullptr;
+    unsigned* sqArray_ = nullptr;
+    unsigned sqMask_ = 0;
+    unsigned sqEntries_ = 0;
+    unsigned* cqHead_ = nullptr;
+    unsigned* cqTail_ = nullptr;
+    unsigned cqMask_ = 0;
+    io_uring_cqe* cqes_ = nullptr;
+#endif
+
+    int epollFd_ = -1;
+    std::mutex fdMtx_;
+    std::unordered_map<int, FdWaiters> fds_;  // 受fdMtx_保护
+};
+
+#endif
+
+#endif
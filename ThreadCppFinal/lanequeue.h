@@ -0,0 +1,304 @@
+#ifndef LANEQUEUE_H
+#define LANEQUEUE_H
+
+#include<atomic>
+#include<chrono>
+#include<memory>
+#include<cstddef>
+#include<cstdint>
+#include<utility>
+
+#include"ringqueue.h"
+#include"mpmcqueue.h"
+
+// 任务优先级（每个优先级对应一条独立的FIFO通道）
+enum class TaskPriority {
+    PRIORITY_HIGH,    // 时延敏感的交互请求
+    PRIORITY_NORMAL,  // 默认
+    PRIORITY_LOW,     // 批处理等后台任务
+};
+
+const int TASK_PRIORITY_LANES = 3;
+// 防饿死：非空的低优先级通道连续被跳过这么多次后，下一次出队优先服务它
+const int LANE_AGING_LIMIT = 16;
+
+// 单条通道的统计快照
+struct LaneStats {
+    std::size_t depth;             // 当前排队数
+    unsigned long long dequeued;   // 累计出队数
+    double avgWaitUs;              // 平均排队时间（微秒）
+    double maxWaitUs;              // 最大排队时间（微秒）
+};
+
+namespace detail {
+
+inline std::int64_t laneNowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// 通道计数器（原子变量，读取统计时无需持有队列锁；各通道独占缓存行）
+struct alignas(CACHE_LINE_SIZE) LaneCounters {
+    std::atomic<std::size_t> depth{0};
+    std::atomic<unsigned long long> dequeued{0};
+    std::atomic<unsigned long long> totalWaitNs{0};
+    std::atomic<unsigned long long> maxWaitNs{0};
+    std::atomic<int> skipped{0};  // 非空时连续被更高优先级跳过的次数
+
+    void onPush() {
+        depth.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // 返回该元素的排队时间（纳秒）
+    std::int64_t onPop(std::int64_t enqueuedNs) {
+        unsigned long long wait = static_cast<unsigned long long>(laneNowNs() - enqueuedNs);
+        depth.fetch_sub(1, std::memory_order_relaxed);
+        dequeued.fetch_add(1, std::memory_order_relaxed);
+        totalWaitNs.fetch_add(wait, std::memory_order_relaxed);
+        unsigned long long prev = maxWaitNs.load(std::memory_order_relaxed);
+        while (wait > prev && !maxWaitNs.compare_exchange_weak(prev, wait, std::memory_order_relaxed)) {}
+        return static_cast<std::int64_t>(wait);
+    }
+
+    LaneStats snapshot() const {
+        LaneStats s;
+        s.depth = depth.load(std::memory_order_relaxed);
+        s.dequeued = dequeued.load(std::memory_order_relaxed);
+        unsigned long long total = totalWaitNs.load(std::memory_order_relaxed);
+        s.avgWaitUs = s.dequeued == 0 ? 0.0 : total / 1000.0 / s.dequeued;
+        s.maxWaitUs = maxWaitNs.load(std::memory_order_relaxed) / 1000.0;
+        return s;
+    }
+};
+
+// 通道中的元素：任务 + 入队时间
+template<typename T>
+struct LaneItem {
+    T task;
+    std::int64_t enqueuedNs = 0;
+    bool droppable = false;  // 队列满且策略为drop-oldest时可被丢弃（只有用户提交的任务）
+    std::uint32_t group = 0; // 所属任务组（ThreadPool::cancelGroup一次移出），0为不分组
+};
+
+// 按优先级和防饿死规则选择出队通道
+// nonEmpty(l)判断通道l是否非空；返回-1表示全部为空
+template<typename NonEmpty>
+int pickLane(LaneCounters* counters, NonEmpty&& nonEmpty) {
+    int first = -1;
+    for (int l = 0; l < TASK_PRIORITY_LANES; l++) {
+        if (nonEmpty(l)) { first = l; break; }
+    }
+    if (first < 0) return -1;
+
+    // 比first低的非空通道各记一次"被跳过"，从最低优先级开始找第一个达到上限的
+    int chosen = first;
+    for (int l = TASK_PRIORITY_LANES - 1; l > first; l--) {
+        if (!nonEmpty(l)) {
+            counters[l].skipped.store(0, std::memory_order_relaxed);
+            continue;
+        }
+        int skipped = counters[l].skipped.fetch_add(1, std::memory_order_relaxed) + 1;
+        if (skipped >= LANE_AGING_LIMIT && chosen == first) chosen = l;
+    }
+    counters[chosen].skipped.store(0, std::memory_order_relaxed);
+    return chosen;
+}
+
+} // namespace detail
+
+// 多通道优先级队列（非线程安全，由调用方加锁；统计可无锁读取）
+template<typename T>
+class LaneQueue {
+public:
+    LaneQueue() = default;
+    LaneQueue(const LaneQueue&) = delete;
+    LaneQueue& operator=(const LaneQueue&) = delete;
+
+    void push(T&& task, TaskPriority priority = TaskPriority::PRIORITY_NORMAL, bool droppable = false,
+        std::uint32_t group = 0)
+    {
+        int lane = static_cast<int>(priority);
+        lanes_[lane].emplace(detail::LaneItem<T>{ std::move(task), detail::laneNowNs(), droppable, group });
+        counters_[lane].onPush();
+        size_++;
+    }
+
+    template<typename... Args>
+    void emplace(Args&&... args) {
+        push(T(std::forward<Args>(args)...));
+    }
+
+    // 一次遍历移出属于group的所有元素，追加到out（各通道其余元素保持原顺序），返回移出的个数
+    template<typename Out>
+    std::size_t extractGroup(std::uint32_t group, Out& out) {
+        std::size_t removed = 0;
+        for (int l = 0; l < TASK_PRIORITY_LANES; l++) {
+            std::size_t n = lanes_[l].size();
+            for (std::size_t i = 0; i < n; i++) {
+                detail::LaneItem<T> item = std::move(lanes_[l].front());
+                lanes_[l].pop();
+                if (item.group == group) {
+                    out.push_back(std::move(item.task));
+                    counters_[l].depth.fetch_sub(1, std::memory_order_relaxed);
+                    removed++;
+                } else {
+                    lanes_[l].push(std::move(item));
+                }
+            }
+        }
+        size_ -= removed;
+        return removed;
+    }
+
+    // 按优先级出队（带防饿死），队列为空时返回false；waitNs非空时写入排队时间
+    bool pop(T& task, std::int64_t* waitNs = nullptr) {
+        int lane = detail::pickLane(counters_, [this](int l) { return !lanes_[l].empty(); });
+        if (lane < 0) return false;
+        detail::LaneItem<T>& item = lanes_[lane].front();
+        task = std::move(item.task);
+        std::int64_t wait = counters_[lane].onPop(item.enqueuedNs);
+        if (waitNs != nullptr) *waitNs = wait;
+        lanes_[lane].pop();
+        size_--;
+        return true;
+    }
+
+    // 取出最早入队的任务（比较各通道队头），队列为空时返回false；droppable写入该任务能否丢弃
+    bool popOldest(T& task, bool& droppable) {
+        int lane = -1;
+        for (int l = 0; l < TASK_PRIORITY_LANES; l++) {
+            if (lanes_[l].empty()) continue;
+            if (lane < 0 || lanes_[l].front().enqueuedNs < lanes_[lane].front().enqueuedNs) lane = l;
+        }
+        if (lane < 0) return false;
+        detail::LaneItem<T>& item = lanes_[lane].front();
+        task = std::move(item.task);
+        droppable = item.droppable;
+        counters_[lane].onPop(item.enqueuedNs);
+        lanes_[lane].pop();
+        size_--;
+        return true;
+    }
+
+    std::size_t size() const {
+        return size_;
+    }
+
+    bool empty() const {
+        return size_ == 0;
+    }
+
+    LaneStats stats(TaskPriority priority) const {
+        return counters_[static_cast<int>(priority)].snapshot();
+    }
+
+private:
+    RingQueue<detail::LaneItem<T>> lanes_[TASK_PRIORITY_LANES];
+    detail::LaneCounters counters_[TASK_PRIORITY_LANES];
+    std::size_t size_ = 0;
+};
+
+// 多通道无锁优先级队列：每条通道一个有界MPMC环形队列，各自容量为capacity
+// 普通通道在构造时创建，高/低优先级通道首次使用时才创建（避免默认容量下占用三倍内存）
+template<typename T>
+class LockFreeLaneQueue {
+public:
+    explicit LockFreeLaneQueue(std::size_t capacity)
+        : capacity_(capacity)
+    {
+        for (auto& lane : lanes_) lane.store(nullptr, std::memory_order_relaxed);
+        lane(static_cast<int>(TaskPriority::PRIORITY_NORMAL));
+    }
+
+    ~LockFreeLaneQueue() {
+        for (auto& lane : lanes_) delete lane.load(std::memory_order_relaxed);
+    }
+
+    LockFreeLaneQueue(const LockFreeLaneQueue&) = delete;
+    LockFreeLaneQueue& operator=(const LockFreeLaneQueue&) = delete;
+
+    // 尝试入队，所在通道满时返回false（此时task保持不变）
+    bool tryPush(T&& task, TaskPriority priority = TaskPriority::PRIORITY_NORMAL, bool droppable = false) {
+        int l = static_cast<int>(priority);
+        detail::LaneItem<T> item{ std::move(task), detail::laneNowNs(), droppable };
+        counters_[l].onPush();
+        if (!lane(l)->tryPush(std::move(item))) {
+            counters_[l].depth.fetch_sub(1, std::memory_order_relaxed);
+            task = std::move(item.task);
+            return false;
+        }
+        return true;
+    }
+
+    // 按优先级出队（带防饿死）；选中的通道被别人抢空时按优先级依次尝试其余通道
+    bool tryPop(T& task, std::int64_t* waitNs = nullptr) {
+        int chosen = detail::pickLane(counters_, [this](int l) {
+            return counters_[l].depth.load(std::memory_order_relaxed) > 0;
+        });
+        if (chosen < 0) return false;
+        if (popFrom(chosen, task, waitNs)) return true;
+        for (int l = 0; l < TASK_PRIORITY_LANES; l++) {
+            if (l != chosen && popFrom(l, task, waitNs)) return true;
+        }
+        return false;
+    }
+
+    // 从指定通道取出队头（最早入队）的任务，通道为空时返回false
+    bool tryPopLane(TaskPriority priority, T& task, bool& droppable) {
+        int l = static_cast<int>(priority);
+        Ring* ring = lanes_[l].load(std::memory_order_acquire);
+        if (ring == nullptr) return false;
+        detail::LaneItem<T> item;
+        if (!ring->tryPop(item)) return false;
+        task = std::move(item.task);
+        droppable = item.droppable;
+        counters_[l].onPop(item.enqueuedNs);
+        return true;
+    }
+
+    // 近似元素个数
+    std::size_t size() const {
+        std::size_t n = 0;
+        for (const auto& c : counters_) n += c.depth.load(std::memory_order_relaxed);
+        return n;
+    }
+
+    bool empty() const {
+        return size() == 0;
+    }
+
+    LaneStats stats(TaskPriority priority) const {
+        return counters_[static_cast<int>(priority)].snapshot();
+    }
+
+private:
+    using Ring = MPMCQueue<detail::LaneItem<T>>;
+
+    // 取通道，不存在时创建（并发创建时只保留一个）
+    Ring* lane(int l) {
+        Ring* ring = lanes_[l].load(std::memory_order_acquire);
+        if (ring != nullptr) return ring;
+        Ring* fresh = new Ring(capacity_);
+        if (lanes_[l].compare_exchange_strong(ring, fresh, std::memory_order_acq_rel)) return fresh;
+        delete fresh;
+        return ring;
+    }
+
+    bool popFrom(int l, T& task, std::int64_t* waitNs) {
+        Ring* ring = lanes_[l].load(std::memory_order_acquire);
+        if (ring == nullptr) return false;
+        detail::LaneItem<T> item;
+        if (!ring->tryPop(item)) return false;
+        task = std::move(item.task);
+        std::int64_t wait = counters_[l].onPop(item.enqueuedNs);
+        if (waitNs != nullptr) *waitNs = wait;
+        return true;
+    }
+
+private:
+    std::size_t capacity_;
+    std::atomic<Ring*> lanes_[TASK_PRIORITY_LANES];
+    detail::LaneCounters counters_[TASK_PRIORITY_LANES];
+};
+
+#endif
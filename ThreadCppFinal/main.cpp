@@ -2,6 +2,12 @@
 #include<chrono>
 #include<thread>
 #include"threadpool.h"
+#include"parallel.h"
+#include"strand.h"
+#include"taskgroup.h"
+#include<atomic>
+#include<vector>
+#include<numeric>
 #include <future>
 
 using uLong=unsigned long long;
@@ -16,8 +22,52 @@ int main(){
     ThreadPool pool;
     pool.start(4);
     
-    std::future<int>r1=pool.submitTask(sum1,1,2);
+    Future<int>r1=pool.submitTask(sum1,1,2);
 
     std::cout<<r1.get()<<std::endl;
 
+    // 并行归约：无需手工切分区间
+    uLong total=pool.parallel_reduce<uLong,uLong>(1,100000001ULL,0ULL,
+        [](uLong i){return i;},std::plus<uLong>());
+    std::cout<<total<<std::endl;
+
+    // 数组区间求和：按缓存行切块并行归约
+    std::vector<uLong> arr(10000000);
+    std::iota(arr.begin(),arr.end(),1ULL);
+    std::cout<<parallel_reduce(pool,arr.begin(),arr.end(),0ULL)<<std::endl;
+
+    // strand：同一分片的更新串行执行，分片状态无需加锁
+    uLong shard=0;
+    {
+        Strand strand(pool);
+        for(int i=1;i<=100;i++){
+            strand.post([&shard,i]{shard+=i;});
+        }
+        strand.wait();
+    }
+    std::cout<<shard<<std::endl;
+
+    // SHUTDOWN_ABORT：排队中的用户任务被丢弃，外部线程上进行中的parallel_for、
+    // TaskGroup::wait、Strand::wait仍会返回（内部分块和驱动任务照常执行）
+    {
+        ThreadPool abortPool;
+        abortPool.start(2);
+        std::atomic<int> ran{0};
+        auto slow=[&ran]{std::this_thread::sleep_for(std::chrono::milliseconds(1));ran++;};
+        std::thread outside([&]{
+            abortPool.parallel_for(0,400,[&](int){slow();},1);
+            TaskGroup group(abortPool);
+            for(int i=0;i<100;i++) group.run(slow);
+            group.wait();
+            Strand strand(abortPool);
+            for(int i=0;i<100;i++) strand.post(slow);
+            strand.wait();
+        });
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        for(int i=0;i<1000;i++) abortPool.submitTask(slow);
+        bool joined=abortPool.shutdown(ShutdownMode::SHUTDOWN_ABORT,std::chrono::seconds(2));
+        outside.join();
+        std::cout<<"abort joined="<<joined<<" ran="<<ran<<std::endl;
+    }
+
 }
\ No newline at end of file
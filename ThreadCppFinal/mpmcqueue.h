@@ -0,0 +1,121 @@
+#ifndef MPMCQUEUE_H
+#define MPMCQUEUE_H
+
+#include<atomic>
+#include<memory>
+#include<cstddef>
+#include<cstdint>
+#include<new>
+#include<utility>
+
+#include"workstealingqueue.h"  // CACHE_LINE_SIZE
+
+// 有界多生产者多消费者无锁环形队列
+// 参考: Dmitry Vyukov, "Bounded MPMC queue"
+// 每个槽位带一个序号：
+//   seq == pos       槽位空闲，可由位置为pos的生产者写入
+//   seq == pos + 1   槽位已写入，可由位置为pos的消费者读取
+// 生产者/消费者只需一次CAS抢占位置，之后独占槽位，因此T可以不是平凡类型
+template<typename T>
+class MPMCQueue {
+public:
+    // 容量向上取整为2的幂（至少为2）
+    explicit MPMCQueue(std::size_t capacity)
+        : head_(0)
+        , tail_(0)
+    {
+        std::size_t cap = 2;
+        while (cap < capacity) cap <<= 1;
+        mask_ = cap - 1;
+        cells_.reset(new Cell[cap]);
+        for (std::size_t i = 0; i < cap; i++) {
+            cells_[i].seq.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    // 析构时销毁尚未取出的元素
+    ~MPMCQueue() {
+        T item;
+        while (tryPop(item)) {}
+    }
+
+    MPMCQueue(const MPMCQueue&) = delete;
+    MPMCQueue& operator=(const MPMCQueue&) = delete;
+
+    // 尝试入队，队列满时返回false（此时item保持不变）
+    bool tryPush(T&& item) {
+        Cell* cell;
+        std::size_t pos = tail_.load(std::memory_order_relaxed);
+        for (;;) {
+            cell = &cells_[pos & mask_];
+            std::size_t seq = cell->seq.load(std::memory_order_acquire);
+            std::intptr_t dif = (std::intptr_t)seq - (std::intptr_t)pos;
+            if (dif == 0) {
+                if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            } else if (dif < 0) {
+                return false;  // 队列已满
+            } else {
+                pos = tail_.load(std::memory_order_relaxed);
+            }
+        }
+        new (cell->ptr()) T(std::move(item));
+        cell->seq.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // 尝试出队，队列空时返回false
+    bool tryPop(T& item) {
+        Cell* cell;
+        std::size_t pos = head_.load(std::memory_order_relaxed);
+        for (;;) {
+            cell = &cells_[pos & mask_];
+            std::size_t seq = cell->seq.load(std::memory_order_acquire);
+            std::intptr_t dif = (std::intptr_t)seq - (std::intptr_t)(pos + 1);
+            if (dif == 0) {
+                if (head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            } else if (dif < 0) {
+                return false;  // 队列为空
+            } else {
+                pos = head_.load(std::memory_order_relaxed);
+            }
+        }
+        T* p = cell->ptr();
+        item = std::move(*p);
+        p->~T();
+        cell->seq.store(pos + mask_ + 1, std::memory_order_release);
+        return true;
+    }
+
+    // 近似元素个数（并发下仅作参考）
+    std::size_t size() const {
+        std::size_t h = head_.load(std::memory_order_relaxed);
+        std::size_t t = tail_.load(std::memory_order_relaxed);
+        return t > h ? t - h : 0;
+    }
+
+    bool empty() const {
+        return size() == 0;
+    }
+
+    std::size_t capacity() const {
+        return mask_ + 1;
+    }
+
+private:
+    struct Cell {
+        T* ptr() { return std::launder(reinterpret_cast<T*>(storage)); }
+
+        std::atomic<std::size_t> seq;
+        alignas(T) unsigned char storage[sizeof(T)];
+    };
+
+private:
+    alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> head_;  // 消费者位置
+    alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> tail_;  // 生产者位置
+    alignas(CACHE_LINE_SIZE) std::unique_ptr<Cell[]> cells_;
+    std::size_t mask_;
+};
+
+#endif
@@ -0,0 +1,298 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include<vector>
+#include<optional>
+#include<algorithm>
+#include<functional>
+#include<iterator>
+#include<memory>
+#include<numeric>
+#include<utility>
+#include<cstddef>
+#include<cstdint>
+
+#include"threadpool.h"
+
+// 连续数组上的并行算法，在ThreadPool上执行（基于ThreadPool::parallel_for）
+// 用法：parallel_transform / parallel_reduce / parallel_inclusive_scan / parallel_exclusive_scan / parallel_sort，
+// 第一个参数是线程池，其余参数与对应的std算法相同；迭代器须指向连续存储（指针、vector/array的迭代器）。
+//   - 数组按块切分：除第一块外每块的起点都落在缓存行边界上，块长是一个缓存行所含元素数的整数倍，
+//     块内是普通的顺序循环，编译器可以按向量宽度展开；相邻块不共享缓存行，写输出时没有伪共享
+//   - 块数约为线程数的4倍（块不小于PARALLEL_MIN_CHUNK_BYTES），一次调用只有一个parallel_for，
+//     调用线程参与计算，工作线程内嵌套调用也不会死锁
+//   - 归约和扫描按块的顺序合并，op只需满足结合律，结果与串行版本相同（浮点数的舍入可能不同）
+// op抛出的第一个异常在调用方重新抛出（此时输出只写了一部分）。
+// 另有执行策略适配器poolexec::par(pool)，见文件末尾。
+
+// 每块的最小字节数：更小的块调度开销超过计算量
+const std::size_t PARALLEL_MIN_CHUNK_BYTES = 16 * 1024;
+
+// 每个线程平均分到的块数（留出负载均衡的余地）
+const std::size_t PARALLEL_CHUNKS_PER_THREAD = 4;
+
+namespace detail {
+
+// [0, n)的分块方案：第一块[0, head + chunk)，之后第i块从head + i * chunk开始
+struct ChunkPlan {
+    std::size_t n = 0;
+    std::size_t head = 0;   // 到第一个缓存行边界的元素数
+    std::size_t chunk = 1;  // 块长（缓存行所含元素数的整数倍）
+    std::size_t count = 0;  // 块数
+
+    std::size_t begin(std::size_t i) const {
+        return i == 0 ? 0 : std::min(n, head + i * chunk);
+    }
+
+    std::size_t end(std::size_t i) const {
+        return std::min(n, head + (i + 1) * chunk);
+    }
+};
+
+// 按base的地址对齐分块；元素大小不能整除缓存行时不对齐
+template<typename T>
+ChunkPlan planChunks(const ThreadPool& pool, const T* base, std::size_t n) {
+    ChunkPlan plan;
+    plan.n = n;
+    if (n == 0) return plan;
+
+    std::size_t lanes = 1;
+    if (sizeof(T) < CACHE_LINE_SIZE && CACHE_LINE_SIZE % sizeof(T) == 0) {
+        lanes = CACHE_LINE_SIZE / sizeof(T);
+        std::uintptr_t addr = reinterpret_cast<std::uintptr_t>(base);
+        if (addr % sizeof(T) == 0) {
+            plan.head = ((CACHE_LINE_SIZE - addr % CACHE_LINE_SIZE) % CACHE_LINE_SIZE) / sizeof(T);
+        }
+    }
+    std::size_t threads = static_cast<std::size_t>(std::max(1, pool.threadCount()));
+    std::size_t minChunk = std::max<std::size_t>(1, PARALLEL_MIN_CHUNK_BYTES / sizeof(T));
+    std::size_t chunk = std::max(minChunk, n / (threads * PARALLEL_CHUNKS_PER_THREAD));
+    plan.chunk = (chunk + lanes - 1) / lanes * lanes;
+    plan.head = std::min(plan.head, n);
+    plan.count = n <= plan.head + plan.chunk ? 1 : 1 + (n - plan.head - 1) / plan.chunk;
+    return plan;
+}
+
+template<typename Iter>
+auto elementAddress(Iter it) {
+    return std::addressof(*it);
+}
+
+// 按块执行body(块号, b, e)：只有一块时直接在调用线程上执行
+template<typename Body>
+void forEachChunk(ThreadPool& pool, const ChunkPlan& plan, Body&& body) {
+    if (plan.count == 0) return;
+    if (plan.count == 1) {
+        body(std::size_t(0), std::size_t(0), plan.n);
+        return;
+    }
+    pool.parallel_for<std::size_t>(0, plan.count, [&](std::size_t i) {
+        body(i, plan.begin(i), plan.end(i));
+    }, 1);
+}
+
+// 每块一个部分结果，缓存行对齐避免伪共享
+template<typename T>
+struct alignas(CACHE_LINE_SIZE) ChunkPartial {
+    std::optional<T> value;
+};
+
+}  // namespace detail
+
+// out[i] = op(first[i])，返回输出末尾；输出按其自身的地址对齐分块
+template<typename InIter, typename OutIter, typename UnaryOp>
+OutIter parallel_transform(ThreadPool& pool, InIter first, InIter last, OutIter out, UnaryOp op) {
+    std::size_t n = static_cast<std::size_t>(std::distance(first, last));
+    if (n == 0) return out;
+    detail::ChunkPlan plan = detail::planChunks(pool, detail::elementAddress(out), n);
+    detail::forEachChunk(pool, plan, [&](std::size_t, std::size_t b, std::size_t e) {
+        InIter in = first + b;
+        OutIter o = out + b;
+        for (std::size_t i = 0; i < e - b; i++) o[i] = op(in[i]);
+    });
+    return out + n;
+}
+
+// out[i] = op(first1[i], first2[i])
+template<typename InIter1, typename InIter2, typename OutIter, typename BinaryOp>
+OutIter parallel_transform(ThreadPool& pool, InIter1 first1, InIter1 last1, InIter2 first2,
+    OutIter out, BinaryOp op)
+{
+    std::size_t n = static_cast<std::size_t>(std::distance(first1, last1));
+    if (n == 0) return out;
+    detail::ChunkPlan plan = detail::planChunks(pool, detail::elementAddress(out), n);
+    detail::forEachChunk(pool, plan, [&](std::size_t, std::size_t b, std::size_t e) {
+        InIter1 in1 = first1 + b;
+        InIter2 in2 = first2 + b;
+        OutIter o = out + b;
+        for (std::size_t i = 0; i < e - b; i++) o[i] = op(in1[i], in2[i]);
+    });
+    return out + n;
+}
+
+// init ⊕ first[0] ⊕ ... ⊕ first[n-1]：每块在本地累加，最后按块的顺序合并
+template<typename Iter, typename T, typename BinaryOp = std::plus<>>
+T parallel_reduce(ThreadPool& pool, Iter first, Iter last, T init, BinaryOp op = BinaryOp()) {
+    std::size_t n = static_cast<std::size_t>(std::distance(first, last));
+    if (n == 0) return init;
+    detail::ChunkPlan plan = detail::planChunks(pool, detail::elementAddress(first), n);
+    std::vector<detail::ChunkPartial<T>> partials(plan.count);
+    detail::forEachChunk(pool, plan, [&](std::size_t c, std::size_t b, std::size_t e) {
+        Iter in = first + b;
+        T acc = in[0];
+        for (std::size_t i = 1; i < e - b; i++) acc = op(std::move(acc), in[i]);
+        partials[c].value = std::move(acc);
+    });
+    T result = std::move(init);
+    for (auto& p : partials) result = op(std::move(result), std::move(*p.value));
+    return result;
+}
+
+namespace detail {
+
+// 两遍分块扫描：第一遍求每块的和，串行求出每块之前的前缀，第二遍每块从自己的前缀开始扫描
+// prefix[i]为第i块之前所有元素的累积（第0块没有前缀，除非有init）
+template<typename InIter, typename OutIter, typename T, typename BinaryOp>
+OutIter blockedScan(ThreadPool& pool, InIter first, InIter last, OutIter out,
+    std::optional<T> init, BinaryOp op, bool inclusive)
+{
+    std::size_t n = static_cast<std::size_t>(std::distance(first, last));
+    if (n == 0) return out;
+    ChunkPlan plan = planChunks(pool, elementAddress(out), n);
+
+    // 第一遍（只读输入，输出可以与输入相同）
+    std::vector<ChunkPartial<T>> sums(plan.count);
+    if (plan.count > 1) {
+        forEachChunk(pool, plan, [&](std::size_t c, std::size_t b, std::size_t e) {
+            if (e == n) return;  // 最后一块的和用不到
+            InIter in = first + b;
+            T acc = in[0];
+            for (std::size_t i = 1; i < e - b; i++) acc = op(std::move(acc), in[i]);
+            sums[c].value = std::move(acc);
+        });
+    }
+
+    // 各块的前缀
+    std::vector<ChunkPartial<T>> prefix(plan.count);
+    prefix[0].value = std::move(init);
+    for (std::size_t i = 1; i < plan.count; i++) {
+        if (prefix[i - 1].value) prefix[i].value = op(*prefix[i - 1].value, std::move(*sums[i - 1].value));
+        else prefix[i].value = std::move(sums[i - 1].value);
+    }
+
+    // 第二遍
+    forEachChunk(pool, plan, [&](std::size_t c, std::size_t b, std::size_t e) {
+        std::optional<T>& pre = prefix[c].value;
+        InIter in = first + b;
+        OutIter o = out + b;
+        if (inclusive) {
+            if (pre) std::inclusive_scan(in, in + (e - b), o, op, *pre);
+            else std::inclusive_scan(in, in + (e - b), o, op);
+        } else {
+            std::exclusive_scan(in, in + (e - b), o, *pre, op);
+        }
+    });
+    return out + n;
+}
+
+}  // namespace detail
+
+// out[i] = first[0] ⊕ ... ⊕ first[i]（输出可以与输入相同）
+template<typename InIter, typename OutIter, typename BinaryOp = std::plus<>>
+OutIter parallel_inclusive_scan(ThreadPool& pool, InIter first, InIter last, OutIter out, BinaryOp op = BinaryOp()) {
+    using T = typename std::iterator_traits<InIter>::value_type;
+    return detail::blockedScan<InIter, OutIter, T>(pool, first, last, out, std::nullopt, op, true);
+}
+
+// out[i] = init ⊕ first[0] ⊕ ... ⊕ first[i]
+template<typename InIter, typename OutIter, typename T, typename BinaryOp>
+OutIter parallel_inclusive_scan(ThreadPool& pool, InIter first, InIter last, OutIter out, BinaryOp op, T init) {
+    return detail::blockedScan<InIter, OutIter, T>(pool, first, last, out, std::optional<T>(std::move(init)), op, true);
+}
+
+// out[0] = init，out[i] = init ⊕ first[0] ⊕ ... ⊕ first[i-1]（输出可以与输入相同）
+template<typename InIter, typename OutIter, typename T, typename BinaryOp = std::plus<>>
+OutIter parallel_exclusive_scan(ThreadPool& pool, InIter first, InIter last, OutIter out, T init, BinaryOp op = BinaryOp()) {
+    return detail::blockedScan<InIter, OutIter, T>(pool, first, last, out, std::optional<T>(std::move(init)), op, false);
+}
+
+// 并行归并排序（不稳定，结果与std::sort相同）：各块并行std::sort，
+// 之后每一轮把相邻的有序段两两std::inplace_merge（同一轮的各次归并并行执行），共log2(块数)轮
+template<typename Iter, typename Compare = std::less<>>
+void parallel_sort(ThreadPool& pool, Iter first, Iter last, Compare comp = Compare()) {
+    std::size_t n = static_cast<std::size_t>(std::distance(first, last));
+    if (n < 2) return;
+    detail::ChunkPlan plan = detail::planChunks(pool, detail::elementAddress(first), n);
+    detail::forEachChunk(pool, plan, [&](std::size_t, std::size_t b, std::size_t e) {
+        std::sort(first + b, first + e, comp);
+    });
+    for (std::size_t width = 1; width < plan.count; width *= 2) {
+        std::size_t pairs = (plan.count + 2 * width - 1) / (2 * width);
+        pool.parallel_for<std::size_t>(0, pairs, [&](std::size_t p) {
+            std::size_t lo = p * 2 * width;
+            std::size_t mid = lo + width;
+            if (mid >= plan.count) return;  // 落单的一段留到下一轮
+            std::size_t hi = std::min(mid + width, plan.count);
+            std::inplace_merge(first + plan.begin(lo), first + plan.begin(mid), first + plan.end(hi - 1), comp);
+        }, 1);
+    }
+}
+
+// 执行策略适配器：poolexec::par(pool)作为第一个参数，调用方式与C++17并行算法相同
+//   for_each(poolexec::par(pool), v.begin(), v.end(), fn);   // 不加限定，经ADL找到
+// 标准不允许为自定义类型特化std::is_execution_policy，不能写成std::for_each(policy, ...)，
+// 因此这些重载放在poolexec命名空间内，不加std::限定调用（或写poolexec::for_each）
+namespace poolexec {
+
+struct PoolPolicy {
+    ThreadPool* pool;
+};
+
+inline PoolPolicy par(ThreadPool& pool) {
+    return PoolPolicy{ &pool };
+}
+
+template<typename Iter, typename Func>
+void for_each(const PoolPolicy& policy, Iter first, Iter last, Func fn) {
+    std::size_t n = static_cast<std::size_t>(std::distance(first, last));
+    if (n == 0) return;
+    detail::ChunkPlan plan = detail::planChunks(*policy.pool, detail::elementAddress(first), n);
+    detail::forEachChunk(*policy.pool, plan, [&](std::size_t, std::size_t b, std::size_t e) {
+        Iter it = first + b;
+        for (std::size_t i = 0; i < e - b; i++) fn(it[i]);
+    });
+}
+
+template<typename InIter, typename OutIter, typename UnaryOp>
+OutIter transform(const PoolPolicy& policy, InIter first, InIter last, OutIter out, UnaryOp op) {
+    return parallel_transform(*policy.pool, first, last, out, op);
+}
+
+template<typename InIter1, typename InIter2, typename OutIter, typename BinaryOp>
+OutIter transform(const PoolPolicy& policy, InIter1 first1, InIter1 last1, InIter2 first2, OutIter out, BinaryOp op) {
+    return parallel_transform(*policy.pool, first1, last1, first2, out, op);
+}
+
+template<typename Iter, typename T, typename BinaryOp = std::plus<>>
+T reduce(const PoolPolicy& policy, Iter first, Iter last, T init, BinaryOp op = BinaryOp()) {
+    return parallel_reduce(*policy.pool, first, last, init, op);
+}
+
+template<typename InIter, typename OutIter, typename BinaryOp = std::plus<>>
+OutIter inclusive_scan(const PoolPolicy& policy, InIter first, InIter last, OutIter out, BinaryOp op = BinaryOp()) {
+    return parallel_inclusive_scan(*policy.pool, first, last, out, op);
+}
+
+template<typename InIter, typename OutIter, typename T, typename BinaryOp = std::plus<>>
+OutIter exclusive_scan(const PoolPolicy& policy, InIter first, InIter last, OutIter out, T init, BinaryOp op = BinaryOp()) {
+    return parallel_exclusive_scan(*policy.pool, first, last, out, init, op);
+}
+
+template<typename Iter, typename Compare = std::less<>>
+void sort(const PoolPolicy& policy, Iter first, Iter last, Compare comp = Compare()) {
+    parallel_sort(*policy.pool, first, last, comp);
+}
+
+}  // namespace poolexec
+
+#endif
@@ -0,0 +1,213 @@
+#ifndef POOLLOG_H
+#define POOLLOG_H
+
+#include<atomic>
+#include<chrono>
+#include<thread>
+#include<mutex>
+#include<condition_variable>
+#include<functional>
+#include<cstdio>
+#include<cstdarg>
+#include<cstddef>
+#include<cstring>
+
+#include"mpmcqueue.h"
+
+// 线程池日志
+// 级别在编译期确定：高于 THREADPOOL_LOG_LEVEL 的日志语句被 if constexpr 整段丢弃，
+// 参数不求值、不生成任何代码。默认只保留WARN及以上（提交失败等少见事件），
+// 每个任务都会经过的TRACE/DEBUG日志默认完全不存在于热路径中。
+// 调试时可在包含头文件前定义，例如 -DTHREADPOOL_LOG_LEVEL=5 打开全部日志。
+// 输出经由可替换的sink函数（默认同步写stderr，不使用iostream）；
+// 调试构建可安装 AsyncPoolLogger，由后台线程经无锁环形队列统一输出。
+#define POOL_LOG_LEVEL_NONE  0
+#define POOL_LOG_LEVEL_ERROR 1
+#define POOL_LOG_LEVEL_WARN  2
+#define POOL_LOG_LEVEL_INFO  3
+#define POOL_LOG_LEVEL_DEBUG 4
+#define POOL_LOG_LEVEL_TRACE 5
+
+#ifndef THREADPOOL_LOG_LEVEL
+#define THREADPOOL_LOG_LEVEL POOL_LOG_LEVEL_WARN
+#endif
+
+// 单条日志的最大长度（超出部分截断）
+const std::size_t POOL_LOG_LINE_SIZE = 240;
+
+// 日志输出函数：level为POOL_LOG_LEVEL_*，text不含换行，len为长度
+using PoolLogSink = void (*)(int level, const char* text, std::size_t len);
+
+namespace detail {
+
+inline const char* poolLogLevelName(int level) {
+    switch (level) {
+    case POOL_LOG_LEVEL_ERROR: return "ERROR";
+    case POOL_LOG_LEVEL_WARN:  return "WARN";
+    case POOL_LOG_LEVEL_INFO:  return "INFO";
+    case POOL_LOG_LEVEL_DEBUG: return "DEBUG";
+    default:                   return "TRACE";
+    }
+}
+
+// 默认sink：整行一次fwrite，多线程输出不会交错
+inline void poolLogStderr(int level, const char* text, std::size_t len) {
+    char line[POOL_LOG_LINE_SIZE + 16];
+    int n = std::snprintf(line, sizeof(line), "[%s] %.*s\n",
+        poolLogLevelName(level), static_cast<int>(len), text);
+    if (n <= 0) return;
+    std::size_t size = static_cast<std::size_t>(n) < sizeof(line) ? static_cast<std::size_t>(n) : sizeof(line) - 1;
+    std::fwrite(line, 1, size, stderr);
+}
+
+inline std::atomic<PoolLogSink>& poolLogSinkRef() {
+    static std::atomic<PoolLogSink> sink{ &poolLogStderr };
+    return sink;
+}
+
+// 当前线程的短标识（用于日志中区分线程）
+inline unsigned long poolThreadTag() {
+    return static_cast<unsigned long>(std::hash<std::thread::id>()(std::this_thread::get_id()) & 0xFFFFFF);
+}
+
+// 格式化后交给当前sink
+inline void poolLogf(int level, const char* fmt, ...)
+#if defined(__GNUC__)
+    __attribute__((format(printf, 2, 3)))
+#endif
+    ;
+
+inline void poolLogf(int level, const char* fmt, ...) {
+    char text[POOL_LOG_LINE_SIZE];
+    va_list args;
+    va_start(args, fmt);
+    int n = std::vsnprintf(text, sizeof(text), fmt, args);
+    va_end(args);
+    if (n < 0) return;
+    std::size_t len = static_cast<std::size_t>(n) < sizeof(text) ? static_cast<std::size_t>(n) : sizeof(text) - 1;
+    poolLogSinkRef().load(std::memory_order_acquire)(level, text, len);
+}
+
+} // namespace detail
+
+// 替换日志输出函数，返回原来的sink（传入nullptr恢复默认的stderr输出）
+inline PoolLogSink setPoolLogSink(PoolLogSink sink) {
+    if (sink == nullptr) sink = &detail::poolLogStderr;
+    return detail::poolLogSinkRef().exchange(sink, std::memory_order_acq_rel);
+}
+
+// 按级别记录日志（printf格式），级别高于THREADPOOL_LOG_LEVEL时编译为空
+#define POOL_LOG(level, ...)                                   \
+    do {                                                       \
+        if constexpr ((level) <= THREADPOOL_LOG_LEVEL) {       \
+            ::detail::poolLogf((level), __VA_ARGS__);          \
+        }                                                      \
+    } while (0)
+
+#define POOL_LOG_ERROR(...) POOL_LOG(POOL_LOG_LEVEL_ERROR, __VA_ARGS__)
+#define POOL_LOG_WARN(...)  POOL_LOG(POOL_LOG_LEVEL_WARN, __VA_ARGS__)
+#define POOL_LOG_INFO(...)  POOL_LOG(POOL_LOG_LEVEL_INFO, __VA_ARGS__)
+#define POOL_LOG_DEBUG(...) POOL_LOG(POOL_LOG_LEVEL_DEBUG, __VA_ARGS__)
+#define POOL_LOG_TRACE(...) POOL_LOG(POOL_LOG_LEVEL_TRACE, __VA_ARGS__)
+
+// 异步日志（调试构建使用）：记录方只把格式化好的行放进无锁环形队列（Vyukov MPMC），
+// 由后台线程写出，工作线程不会因为输出而阻塞；队列满时丢弃并计数。
+// 同一时刻只能安装一个；析构时卸载、写完剩余日志并结束后台线程。
+// 应在线程池之前创建、在线程池销毁之后再销毁（析构时不能有线程仍在记录日志）。
+class AsyncPoolLogger {
+public:
+    explicit AsyncPoolLogger(std::size_t capacity = 4096, PoolLogSink output = &detail::poolLogStderr)
+        : queue_(capacity)
+        , output_(output)
+        , stop_(false)
+        , dropped_(0)
+        , previous_(nullptr)
+    {
+        writer_ = std::thread(&AsyncPoolLogger::writerLoop, this);
+        instance().store(this, std::memory_order_release);
+        previous_ = setPoolLogSink(&AsyncPoolLogger::enqueue);
+    }
+
+    ~AsyncPoolLogger() {
+        setPoolLogSink(previous_);
+        instance().store(nullptr, std::memory_order_release);
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            stop_ = true;
+        }
+        cond_.notify_one();
+        writer_.join();
+    }
+
+    AsyncPoolLogger(const AsyncPoolLogger&) = delete;
+    AsyncPoolLogger& operator=(const AsyncPoolLogger&) = delete;
+
+    // 因队列满而丢弃的日志条数
+    unsigned long long droppedCount() const {
+        return dropped_.load(std::memory_order_relaxed);
+    }
+
+private:
+    struct Record {
+        int level = 0;
+        std::size_t len = 0;
+        char text[POOL_LOG_LINE_SIZE];
+    };
+
+    static std::atomic<AsyncPoolLogger*>& instance() {
+        static std::atomic<AsyncPoolLogger*> current{ nullptr };
+        return current;
+    }
+
+    // 安装后的sink：入队，后台线程可能在休眠时才加锁唤醒
+    static void enqueue(int level, const char* text, std::size_t len) {
+        AsyncPoolLogger* self = instance().load(std::memory_order_acquire);
+        if (self == nullptr) {
+            detail::poolLogStderr(level, text, len);
+            return;
+        }
+        Record rec;
+        rec.level = level;
+        rec.len = len < POOL_LOG_LINE_SIZE ? len : POOL_LOG_LINE_SIZE;
+        std::memcpy(rec.text, text, rec.len);
+        if (!self->queue_.tryPush(std::move(rec))) {
+            self->dropped_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (self->sleeping_.load(std::memory_order_relaxed)) {
+            std::lock_guard<std::mutex> lock(self->mtx_);
+            self->cond_.notify_one();
+        }
+    }
+
+    void writerLoop() {
+        Record rec;
+        for (;;) {
+            while (queue_.tryPop(rec)) {
+                output_(rec.level, rec.text, rec.len);
+            }
+            std::unique_lock<std::mutex> lock(mtx_);
+            sleeping_.store(true, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (stop_ && queue_.empty()) break;
+            // 入队方与休眠标记两侧都有栅栏，不会丢失唤醒；超时只作兜底
+            cond_.wait_for(lock, std::chrono::milliseconds(10),
+                [&]()->bool { return stop_ || !queue_.empty(); });
+            sleeping_.store(false, std::memory_order_relaxed);
+        }
+    }
+
+private:
+    MPMCQueue<Record> queue_;
+    PoolLogSink output_;
+    std::thread writer_;
+    std::mutex mtx_;
+    std::condition_variable cond_;
+    bool stop_;                           // 受mtx_保护
+    std::atomic_bool sleeping_{false};    // 后台线程是否准备休眠
+    std::atomic<unsigned long long> dropped_;
+    PoolLogSink previous_;                // 安装前的sink，析构时恢复
+};
+
+#endif
@@ -0,0 +1,154 @@
+#ifndef POOLSTATS_H
+#define POOLSTATS_H
+
+#include<atomic>
+#include<vector>
+#include<cstddef>
+#include<cstdint>
+
+#include"workstealingqueue.h"
+
+// 直方图精度：每个2的幂区间再均分为 2^HIST_SUB_BITS 格（相对误差约12.5%）
+const int HIST_SUB_BITS = 3;
+// 记录上限：2^HIST_MAX_BITS 纳秒（约18分钟），更大的值计入最后一格
+const int HIST_MAX_BITS = 40;
+const int HIST_BUCKETS = (HIST_MAX_BITS - HIST_SUB_BITS + 1) << HIST_SUB_BITS;
+
+namespace detail {
+
+// 单写者计数器自增：只有所属线程写入，用普通的读+写代替原子读改写（不加lock前缀），
+// 其他线程可随时无锁读取
+inline void bumpCounter(std::atomic<unsigned long long>& c, unsigned long long n = 1) {
+    c.store(c.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+// 值所在的格
+inline int histBucket(std::uint64_t v) {
+    const std::uint64_t sub = 1u << HIST_SUB_BITS;
+    if (v < sub) return static_cast<int>(v);
+    int msb = 63 - __builtin_clzll(v);
+    if (msb >= HIST_MAX_BITS) return HIST_BUCKETS - 1;
+    int shift = msb - HIST_SUB_BITS;
+    return ((shift + 1) << HIST_SUB_BITS) + static_cast<int>((v >> shift) & (sub - 1));
+}
+
+// 格的上界（含）
+inline std::uint64_t histBucketUpper(int b) {
+    const int sub = 1 << HIST_SUB_BITS;
+    if (b < sub) return static_cast<std::uint64_t>(b);
+    int shift = (b >> HIST_SUB_BITS) - 1;
+    std::uint64_t lower = static_cast<std::uint64_t>(sub + (b & (sub - 1))) << shift;
+    return lower + (std::uint64_t(1) << shift) - 1;
+}
+
+} // namespace detail
+
+// 直方图快照（单位纳秒），可合并
+struct HistogramSnapshot {
+    std::vector<unsigned long long> counts = std::vector<unsigned long long>(HIST_BUCKETS);
+    unsigned long long total = 0;   // 样本数
+    unsigned long long sumNs = 0;   // 样本和
+    unsigned long long maxNs = 0;   // 最大值
+
+    void merge(const HistogramSnapshot& other) {
+        for (int b = 0; b < HIST_BUCKETS; b++) counts[b] += other.counts[b];
+        total += other.total;
+        sumNs += other.sumNs;
+        if (other.maxNs > maxNs) maxNs = other.maxNs;
+    }
+
+    double meanNs() const {
+        return total == 0 ? 0.0 : static_cast<double>(sumNs) / total;
+    }
+
+    // 分位数（p取0~1），返回所在格的上界，不超过实际最大值
+    unsigned long long percentileNs(double p) const {
+        if (total == 0) return 0;
+        unsigned long long rank = static_cast<unsigned long long>(p * total + 0.5);
+        if (rank < 1) rank = 1;
+        unsigned long long seen = 0;
+        for (int b = 0; b < HIST_BUCKETS; b++) {
+            seen += counts[b];
+            if (seen >= rank) {
+                unsigned long long upper = detail::histBucketUpper(b);
+                return upper < maxNs ? upper : maxNs;
+            }
+        }
+        return maxNs;
+    }
+};
+
+// 对数线性分桶的延迟直方图（HDR风格），单写者，任意线程可读取快照
+class LatencyHistogram {
+public:
+    void record(std::uint64_t ns) {
+        detail::bumpCounter(counts_[detail::histBucket(ns)]);
+        detail::bumpCounter(total_);
+        detail::bumpCounter(sum_, ns);
+        if (ns > max_.load(std::memory_order_relaxed)) max_.store(ns, std::memory_order_relaxed);
+    }
+
+    void snapshotInto(HistogramSnapshot& out) const {
+        for (int b = 0; b < HIST_BUCKETS; b++) {
+            out.counts[b] += counts_[b].load(std::memory_order_relaxed);
+        }
+        out.total += total_.load(std::memory_order_relaxed);
+        out.sumNs += sum_.load(std::memory_order_relaxed);
+        unsigned long long m = max_.load(std::memory_order_relaxed);
+        if (m > out.maxNs) out.maxNs = m;
+    }
+
+private:
+    std::atomic<unsigned long long> counts_[HIST_BUCKETS] = {};
+    std::atomic<unsigned long long> total_{0};
+    std::atomic<unsigned long long> sum_{0};
+    std::atomic<unsigned long long> max_{0};
+};
+
+// 每个工作线程一份的计数器（独占缓存行，只由所属线程写入）
+struct alignas(CACHE_LINE_SIZE) WorkerStats {
+    std::atomic<unsigned long long> submitted{0};        // 本线程提交的任务
+    std::atomic<unsigned long long> executed{0};         // 本线程执行完的任务
+    std::atomic<unsigned long long> steals{0};           // 窃取成功
+    std::atomic<unsigned long long> failedSteals{0};     // 遍历所有目标仍未窃取到
+    std::atomic<unsigned long long> parks{0};            // 真正进入休眠的次数
+    std::atomic<unsigned long long> wakeups{0};          // 被唤醒次数
+    std::atomic<unsigned long long> spuriousWakeups{0};  // 被唤醒后没拿到任务
+    std::atomic<unsigned long long> parkedNs{0};         // 休眠总时长
+    LatencyHistogram queueWait;                          // 任务排队时间
+    LatencyHistogram runTime;                            // 任务执行时间
+};
+
+// 非工作线程的计数器分片（按线程分散到不同缓存行）
+const int EXTERNAL_STATS_STRIPES = 16;
+
+struct alignas(CACHE_LINE_SIZE) ExternalStats {
+    std::atomic<unsigned long long> submitted{0};
+    std::atomic<unsigned long long> executed{0};  // 等待时帮忙执行的任务
+};
+
+// 线程池统计快照（ThreadPool::stats()）
+struct PoolStats {
+    unsigned long long tasksSubmitted = 0;    // 已入队的任务（含内部拆分的子任务和续延）
+    unsigned long long tasksCompleted = 0;    // 已执行完的任务
+    HistogramSnapshot queueWait;              // 排队时间（全局队列和节点队列，本地队列不计）
+    HistogramSnapshot runTime;                // 工作线程上的执行时间
+    double parkedSeconds = 0;                 // 所有工作线程的休眠时间之和
+    unsigned long long parks = 0;             // 休眠次数
+    unsigned long long wakeups = 0;           // 唤醒次数
+    unsigned long long spuriousWakeups = 0;   // 无效唤醒次数
+    unsigned long long steals = 0;            // 窃取成功次数
+    unsigned long long failedSteals = 0;      // 窃取失败次数
+    unsigned long long threadsCreated = 0;    // CACHED模式新建的线程数
+    unsigned long long threadsRetired = 0;    // CACHED模式回收的线程数
+    unsigned long long tasksRejected = 0;     // 队列满（或等待超时）而提交失败的任务
+    unsigned long long tasksDropped = 0;      // drop-oldest策略丢弃的排队任务
+    unsigned long long tasksCallerRan = 0;    // caller-runs策略在提交线程上执行的任务
+    unsigned long long tasksExpired = 0;      // 过了截止时间（submitBefore）而跳过的任务
+    unsigned long long tasksCancelled = 0;    // 令牌已取消或所在组已取消而跳过的任务
+    unsigned long long timersFired = 0;       // 已到期的定时任务（submitAfter/submitAt/submitEvery）
+    int threads = 0;                          // 当前线程数
+    int parkedThreads = 0;                    // 当前休眠的线程数
+};
+
+#endif
@@ -0,0 +1,78 @@
+#ifndef RINGQUEUE_H
+#define RINGQUEUE_H
+
+#include<cstddef>
+#include<memory>
+#include<utility>
+
+// 可增长的环形FIFO队列（非线程安全，由调用方加锁）
+// 用于替代 std::queue（std::deque）：后者按块分配，
+// 稳定入队/出队时仍会反复申请和释放块；环形缓冲区只在扩容时分配，
+// 达到峰值容量后不再分配内存。T需可默认构造和移动赋值。
+template<typename T>
+class RingQueue {
+public:
+    explicit RingQueue(std::size_t capacity = 64)
+        : head_(0)
+        , count_(0)
+    {
+        std::size_t cap = 1;
+        while (cap < capacity) cap <<= 1;
+        buffer_.reset(new T[cap]);
+        mask_ = cap - 1;
+    }
+
+    RingQueue(const RingQueue&) = delete;
+    RingQueue& operator=(const RingQueue&) = delete;
+
+    template<typename... Args>
+    void emplace(Args&&... args) {
+        if (count_ == mask_ + 1) grow();
+        buffer_[(head_ + count_) & mask_] = T(std::forward<Args>(args)...);
+        count_++;
+    }
+
+    void push(T&& item) {
+        emplace(std::move(item));
+    }
+
+    T& front() {
+        return buffer_[head_];
+    }
+
+    // 出队（槽位重置为默认值，及时释放元素持有的资源）
+    void pop() {
+        buffer_[head_] = T();
+        head_ = (head_ + 1) & mask_;
+        count_--;
+    }
+
+    std::size_t size() const {
+        return count_;
+    }
+
+    bool empty() const {
+        return count_ == 0;
+    }
+
+private:
+    // 容量翻倍，元素按顺序搬到新缓冲区开头
+    void grow() {
+        std::size_t cap = (mask_ + 1) * 2;
+        std::unique_ptr<T[]> fresh(new T[cap]);
+        for (std::size_t i = 0; i < count_; i++) {
+            fresh[i] = std::move(buffer_[(head_ + i) & mask_]);
+        }
+        buffer_ = std::move(fresh);
+        head_ = 0;
+        mask_ = cap - 1;
+    }
+
+private:
+    std::unique_ptr<T[]> buffer_;
+    std::size_t head_;   // 队首下标
+    std::size_t count_;  // 元素个数
+    std::size_t mask_;   // 容量-1（容量为2的幂）
+};
+
+#endif
@@ -0,0 +1,157 @@
+#ifndef SLABPOOL_H
+#define SLABPOOL_H
+
+#include<cstddef>
+#include<mutex>
+#include<new>
+
+// 定长内存块对象池（按块大小区分，每种大小一个独立的池）
+// 结构：
+//   - 每个线程有一个本地空闲链表，分配/释放都不加锁
+//   - 本地链表为空时从全局链表整批取回一批块，过长时整批还回全局链表
+//   - 全局链表也为空时一次向系统申请一整块slab（SLAB_BLOCK_COUNT个块）
+// 分配方与释放方可以是不同线程（例如提交线程分配、工作线程释放），
+// 块会经由全局链表流回分配多的线程，稳定后不再调用 operator new。
+// slab内存在进程生命期内不归还系统（分离的工作线程退出时可能仍在释放块）。
+const std::size_t SLAB_BLOCK_COUNT = 64;       // 每次向系统申请的块数
+const std::size_t SLAB_LOCAL_MAX = 256;        // 本地链表超过该长度时还回一批
+
+template<std::size_t BlockSize>
+class SlabPool {
+    static_assert(BlockSize >= sizeof(void*), "块大小至少要能存放一个指针");
+    static_assert(BlockSize % alignof(std::max_align_t) == 0, "块大小需按max_align_t对齐");
+
+public:
+    // 分配一个块（未初始化）
+    static void* allocate() {
+        LocalCache& cache = local();
+        if (cache.head == nullptr) {
+            refill(cache);
+        }
+        FreeNode* node = cache.head;
+        cache.head = node->next;
+        cache.count--;
+        return node;
+    }
+
+    // 释放一个由allocate得到的块（可在任意线程调用）
+    static void deallocate(void* p) noexcept {
+        LocalCache& cache = local();
+        FreeNode* node = static_cast<FreeNode*>(p);
+        node->next = cache.head;
+        cache.head = node;
+        cache.count++;
+        if (cache.count > SLAB_LOCAL_MAX) {
+            flush(cache, SLAB_LOCAL_MAX / 2);
+        }
+    }
+
+private:
+    struct FreeNode {
+        FreeNode* next;
+    };
+
+    // 线程本地缓存，线程退出时把剩余块全部还回全局链表
+    struct LocalCache {
+        FreeNode* head = nullptr;
+        std::size_t count = 0;
+
+        ~LocalCache() {
+            flush(*this, count);
+        }
+    };
+
+    // 全局共享部分（函数内静态对象，进程退出时不释放slab）
+    struct Global {
+        std::mutex mtx;
+        FreeNode* head = nullptr;
+        std::size_t count = 0;
+    };
+
+    static LocalCache& local() {
+        static thread_local LocalCache cache;
+        return cache;
+    }
+
+    static Global& global() {
+        static Global* g = new Global();  // 故意不析构，线程退出顺序不可控
+        return *g;
+    }
+
+    // 从全局链表取回一批，不足时申请新slab
+    static void refill(LocalCache& cache) {
+        Global& g = global();
+        {
+            std::lock_guard<std::mutex> lock(g.mtx);
+            std::size_t n = 0;
+            while (g.head != nullptr && n < SLAB_BLOCK_COUNT) {
+                FreeNode* node = g.head;
+                g.head = node->next;
+                node->next = cache.head;
+                cache.head = node;
+                n++;
+            }
+            g.count -= n;
+            cache.count += n;
+        }
+        if (cache.head != nullptr) return;
+
+        unsigned char* slab = static_cast<unsigned char*>(::operator new(BlockSize * SLAB_BLOCK_COUNT));
+        for (std::size_t i = 0; i < SLAB_BLOCK_COUNT; i++) {
+            FreeNode* node = reinterpret_cast<FreeNode*>(slab + i * BlockSize);
+            node->next = cache.head;
+            cache.head = node;
+        }
+        cache.count += SLAB_BLOCK_COUNT;
+    }
+
+    // 把本地链表头部的n个块还回全局链表
+    static void flush(LocalCache& cache, std::size_t n) noexcept {
+        if (n == 0 || cache.head == nullptr) return;
+        FreeNode* first = cache.head;
+        FreeNode* last = first;
+        std::size_t moved = 1;
+        while (moved < n && last->next != nullptr) {
+            last = last->next;
+            moved++;
+        }
+        cache.head = last->next;
+        cache.count -= moved;
+
+        Global& g = global();
+        std::lock_guard<std::mutex> lock(g.mtx);
+        last->next = g.head;
+        g.head = first;
+        g.count += moved;
+    }
+};
+
+// 把对象大小向上取整到对齐后的块大小
+constexpr std::size_t slabBlockSize(std::size_t size) {
+    return (size + alignof(std::max_align_t) - 1) / alignof(std::max_align_t) * alignof(std::max_align_t);
+}
+
+// 超过该大小的对象直接使用 operator new
+const std::size_t SLAB_MAX_OBJECT_SIZE = 512;
+
+// 按类型分配/释放（T的对齐不超过max_align_t）
+template<typename T>
+void* slabAllocate() {
+    static_assert(alignof(T) <= alignof(std::max_align_t), "slab不支持超对齐类型");
+    if constexpr (sizeof(T) <= SLAB_MAX_OBJECT_SIZE) {
+        return SlabPool<slabBlockSize(sizeof(T))>::allocate();
+    } else {
+        return ::operator new(sizeof(T));
+    }
+}
+
+template<typename T>
+void slabDeallocate(void* p) noexcept {
+    if constexpr (sizeof(T) <= SLAB_MAX_OBJECT_SIZE) {
+        SlabPool<slabBlockSize(sizeof(T))>::deallocate(p);
+    } else {
+        ::operator delete(p);
+    }
+}
+
+#endif
@@ -0,0 +1,183 @@
+#ifndef STRAND_H
+#define STRAND_H
+
+#include<atomic>
+#include<exception>
+#include<functional>
+#include<mutex>
+#include<utility>
+#include<cstddef>
+
+#include"threadpool.h"
+
+// Strand构造参数worker的取值：非负数表示固定到该槽位，或者下面两种
+const int STRAND_STICKY = -1;  // 跟随上一次执行它的工作线程（默认）
+const int STRAND_ANY = -2;     // 不指定线程，与普通任务一样由任意线程执行
+
+// 驱动任务每次最多连续执行的任务数，之后重新排队，让同一线程上的其他任务有机会执行
+const std::size_t STRAND_BATCH = 64;
+
+// 串行执行队列（strand），在ThreadPool上执行
+// 提交到同一个strand的任务按提交顺序逐个执行，任意时刻最多只有一个在执行，
+// 前一个任务的写入对后一个任务可见：只被一个strand访问的状态无需加锁。
+//   - strand本身不占线程：有任务时向线程池投递一个驱动任务，由它连续执行排队中的任务，
+//     strand排空时驱动任务结束，不同的strand可以在不同线程上同时执行
+//   - 亲和：STRAND_STICKY时驱动任务投递到上一次执行它的线程的专属队列（见submitTo），
+//     状态留在同一个核心的缓存里；固定槽位时总由该槽位的线程执行。
+//     亲和线程正被长任务占住时strand要等它执行完，对延迟敏感时用STRAND_ANY
+// post的任务抛出的异常只记录日志；submit返回Future，异常由Future传出。
+// 不要在strand的任务内等待同一strand中之后提交的任务（它们要等当前任务返回才能开始）。
+// 析构时等待已提交的任务全部完成，任务引用本strand时须保证strand的生命周期覆盖所有任务。
+class Strand {
+public:
+    explicit Strand(ThreadPool& pool, int worker = STRAND_STICKY)
+        : pool_(pool)
+        , pinned_(worker >= 0)
+        , affinity_(worker >= 0 ? worker : (worker == STRAND_ANY ? STRAND_ANY : STRAND_STICKY))
+        , scheduled_(false)
+        , done_(1)  // strand自身持有一个计数，wait()时释放
+    {}
+
+    Strand(const Strand&) = delete;
+    Strand& operator=(const Strand&) = delete;
+
+    ~Strand() {
+        join();
+    }
+
+    // 提交一个任务（不返回结果）
+    template<typename Func>
+    void post(Func&& fn) {
+        enqueue(TaskFunction([fn = std::forward<Func>(fn)]() mutable {
+            try {
+                fn();
+            } catch (const std::exception& e) {
+                POOL_LOG_ERROR("strand任务抛出异常：%s", e.what());
+            } catch (...) {
+                POOL_LOG_ERROR("strand任务抛出未知异常");
+            }
+        }));
+    }
+
+    // 提交一个任务，返回其结果的Future
+    template<typename Func, typename... Args>
+    auto submit(Func&& func, Args&&... args) -> Future<decltype(func(args...))> {
+        using RType = decltype(func(args...));
+        Promise<RType> promise(pool_.executor());
+        Future<RType> result = promise.get_future();
+        enqueue(TaskFunction([promise = std::move(promise),
+            fn = std::bind(std::forward<Func>(func), std::forward<Args>(args)...)]() mutable {
+            promise.run(fn);
+        }));
+        return result;
+    }
+
+    // 等待已提交的任务全部完成（等待期间帮忙执行线程池中的任务），不要在本strand的任务内调用
+    void wait() {
+        join();
+    }
+
+    // 当前线程是否正在执行本strand的任务
+    bool runningInThisThread() const {
+        return current() == this;
+    }
+
+    // 下一次投递驱动任务的槽位，尚未执行过（STRAND_STICKY）或不指定线程时为负数
+    int worker() const {
+        return affinity_.load(std::memory_order_relaxed);
+    }
+
+private:
+    // 释放strand自身的计数并等待归零，之后重新持有一个计数以便复用
+    void join() {
+        done_.done();
+        pool_.helpUntil(done_);
+        done_.reset(1);
+    }
+
+    void enqueue(TaskFunction&& task) {
+        done_.add();
+        bool startDriver = false;
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            queue_.push(std::move(task));
+            if (!scheduled_) {
+                scheduled_ = true;
+                startDriver = true;
+            }
+        }
+        if (startDriver) schedule();
+    }
+
+    // 投递驱动任务：有亲和槽位时进入该线程的专属队列，否则进入公共队列；
+    // 都失败（队列满、线程池已关闭）时在当前线程上执行
+    void schedule() {
+        done_.add();
+        if (!spawnDriver()) drive();
+    }
+
+    bool spawnDriver() {
+        int worker = affinity_.load(std::memory_order_relaxed);
+        TaskFunction task([this]() { drive(); });
+        return worker >= 0 ? pool_.trySpawnTo(worker, std::move(task)) : pool_.trySpawn(std::move(task));
+    }
+
+    // 驱动任务：连续执行最多STRAND_BATCH个排队中的任务，之后仍有任务时重新投递自己，
+    // 投递失败时在当前线程上继续；驱动任务自身也持有一个计数，执行期间本strand不会被销毁
+    void drive() {
+        if (!pinned_ && affinity_.load(std::memory_order_relaxed) != STRAND_ANY) {
+            int index = pool_.currentWorkerIndex();
+            if (index >= 0) affinity_.store(index, std::memory_order_relaxed);
+        }
+        const Strand* outer = current();  // 任务内等待时可能在同一线程上帮忙执行其他strand
+        current() = this;
+        for (;;) {
+            if (!runBatch()) break;
+            done_.add();
+            if (spawnDriver()) break;
+            done_.undo();
+        }
+        current() = outer;
+        done_.done();
+    }
+
+    // 执行至多STRAND_BATCH个任务，返回true表示仍有任务（scheduled_保持为true）
+    bool runBatch() {
+        for (std::size_t n = 0; n < STRAND_BATCH; n++) {
+            TaskFunction task;
+            {
+                std::lock_guard<std::mutex> lock(mtx_);
+                if (queue_.empty()) {
+                    scheduled_ = false;
+                    return false;
+                }
+                task = std::move(queue_.front());
+                queue_.pop();
+            }
+            task();
+            done_.done();
+        }
+        std::lock_guard<std::mutex> lock(mtx_);
+        if (queue_.empty()) {
+            scheduled_ = false;
+            return false;
+        }
+        return true;
+    }
+
+    static const Strand*& current() {
+        thread_local const Strand* strand = nullptr;
+        return strand;
+    }
+
+private:
+    ThreadPool& pool_;
+    const bool pinned_;              // 构造时指定了固定槽位
+    std::atomic_int affinity_;       // 驱动任务投递的槽位（负数表示公共队列）
+    std::mutex mtx_;                 // 保护queue_和scheduled_
+    RingQueue<TaskFunction> queue_;  // 排队中的任务
+    bool scheduled_;                 // 已有驱动任务（排队中或执行中）
+    JoinCounter done_;               // 尚未完成的任务和驱动任务
+};
+
+#endif
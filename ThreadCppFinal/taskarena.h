@@ -0,0 +1,193 @@
+#ifndef TASKARENA_H
+#define TASKARENA_H
+
+#include<cstddef>
+#include<cstdint>
+#include<new>
+#include<utility>
+#include<memory_resource>
+
+// 每块的默认大小（字节）
+const std::size_t TASK_ARENA_CHUNK_SIZE = 64 * 1024;
+
+// 预热时逐页写入的步长（字节）
+const std::size_t TASK_ARENA_PAGE_SIZE = 4096;
+
+// 线程私有的增量（bump）分配器，供任务分配临时内存
+// 分配只移动指针，释放是空操作，reset()一次性回收全部内存：
+//   - 普通块在reset后保留复用，稳定后不再调用operator new
+//   - 超过块大小一半的请求单独分配一块，reset时只保留其中最大的一块备用，其余归还系统
+// 实现了 std::pmr::memory_resource，可直接用于 std::pmr::vector 等容器。
+// 非线程安全：只能由所属线程使用（工作线程的arena见 ThreadPool::currentArena）。
+// 内存在所属线程首次使用时才申请，绑定CPU后按首次访问策略落在本地NUMA节点。
+class TaskArena : public std::pmr::memory_resource {
+public:
+    explicit TaskArena(std::size_t chunkSize = TASK_ARENA_CHUNK_SIZE)
+        : chunkSize_(chunkSize)
+        , head_(nullptr)
+        , current_(nullptr)
+        , large_(nullptr)
+        , spare_(nullptr)
+        , ptr_(nullptr)
+        , end_(nullptr)
+        , autoReset_(true)
+    {}
+
+    ~TaskArena() override {
+        release();
+    }
+
+    TaskArena(const TaskArena&) = delete;
+    TaskArena& operator=(const TaskArena&) = delete;
+
+    // 回收全部分配（之前分配的指针全部失效），保留普通块供复用
+    void reset() {
+        // 保留最大的单独块，下次同等大小的请求不再申请
+        while (large_ != nullptr) {
+            Chunk* c = large_;
+            large_ = c->next;
+            if (spare_ == nullptr || c->size > spare_->size) std::swap(c, spare_);
+            if (c != nullptr) ::operator delete(c);
+        }
+        if (spare_ != nullptr) spare_->next = nullptr;
+        current_ = head_;
+        if (current_ != nullptr) {
+            ptr_ = current_->data();
+            end_ = ptr_ + current_->size;
+        } else {
+            ptr_ = end_ = nullptr;
+        }
+    }
+
+    // 回收全部分配并把所有块归还系统
+    void release() {
+        freeList(large_);
+        freeList(head_);
+        freeList(spare_);
+        head_ = current_ = large_ = spare_ = nullptr;
+        ptr_ = end_ = nullptr;
+    }
+
+    // 预先申请第一个普通块并逐页写入（由所属线程在首次分配前调用），首个任务不再触发缺页
+    void prefault() {
+        if (head_ == nullptr) {
+            head_ = current_ = newChunk(chunkSize_);
+            ptr_ = head_->data();
+            end_ = ptr_ + head_->size;
+        }
+        volatile char* data = head_->data();
+        for (std::size_t i = 0; i < head_->size; i += TASK_ARENA_PAGE_SIZE) data[i] = 0;
+    }
+
+    // 工作线程在每个任务返回后是否自动reset（默认是）
+    // 任务需要把arena中的数据留给之后的任务时关闭，用完后由任务自己reset并重新打开
+    bool autoReset() const {
+        return autoReset_;
+    }
+
+    void setAutoReset(bool enable) {
+        autoReset_ = enable;
+    }
+
+    // 当前是否有未回收的分配
+    bool used() const {
+        return large_ != nullptr || current_ != head_
+            || (head_ != nullptr && ptr_ != head_->data());
+    }
+
+    // 已申请的普通块总字节数
+    std::size_t reservedBytes() const {
+        std::size_t n = 0;
+        for (Chunk* c = head_; c != nullptr; c = c->next) n += c->size;
+        return n;
+    }
+
+protected:
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+        char* p = alignUp(ptr_, alignment);
+        if (p != nullptr && p + bytes <= end_) {
+            ptr_ = p + bytes;
+            return p;
+        }
+        return allocateSlow(bytes, alignment);
+    }
+
+    // 单个释放不回收内存，由reset()统一回收
+    void do_deallocate(void*, std::size_t, std::size_t) override {}
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+private:
+    // 块头，数据紧随其后
+    struct alignas(std::max_align_t) Chunk {
+        Chunk* next;
+        std::size_t size;  // 数据区大小
+
+        char* data() {
+            return reinterpret_cast<char*>(this + 1);
+        }
+    };
+
+    static char* alignUp(char* p, std::size_t alignment) {
+        std::uintptr_t v = reinterpret_cast<std::uintptr_t>(p);
+        return reinterpret_cast<char*>((v + alignment - 1) & ~(std::uintptr_t)(alignment - 1));
+    }
+
+    static Chunk* newChunk(std::size_t size) {
+        Chunk* c = static_cast<Chunk*>(::operator new(sizeof(Chunk) + size));
+        c->next = nullptr;
+        c->size = size;
+        return c;
+    }
+
+    static void freeList(Chunk* c) {
+        while (c != nullptr) {
+            Chunk* next = c->next;
+            ::operator delete(c);
+            c = next;
+        }
+    }
+
+    // 当前块放不下：大请求单独分配，否则换到下一个保留块或新申请一块
+    void* allocateSlow(std::size_t bytes, std::size_t alignment) {
+        std::size_t need = bytes + (alignment > alignof(std::max_align_t) ? alignment : 0);
+        if (need > chunkSize_ / 2) {
+            Chunk* c = nullptr;
+            if (spare_ != nullptr && spare_->size >= need) {
+                c = spare_;
+                spare_ = nullptr;
+            } else {
+                c = newChunk(need);
+            }
+            c->next = large_;
+            large_ = c;
+            return alignUp(c->data(), alignment);
+        }
+
+        Chunk* next = current_ != nullptr ? current_->next : head_;
+        if (next == nullptr) {
+            next = newChunk(chunkSize_);
+            if (current_ != nullptr) current_->next = next;
+            else head_ = next;
+        }
+        current_ = next;
+        char* p = alignUp(current_->data(), alignment);
+        ptr_ = p + bytes;
+        end_ = current_->data() + current_->size;
+        return p;
+    }
+
+private:
+    std::size_t chunkSize_;  // 普通块大小
+    Chunk* head_;            // 普通块链表（reset后保留）
+    Chunk* current_;         // 正在使用的普通块
+    Chunk* large_;           // 单独分配的大块
+    Chunk* spare_;           // reset后保留的一个大块
+    char* ptr_;              // 当前块的分配位置
+    char* end_;              // 当前块的末尾
+    bool autoReset_;         // 任务结束后是否自动reset
+};
+
+#endif
@@ -0,0 +1,150 @@
+#ifndef TASKFUNCTION_H
+#define TASKFUNCTION_H
+
+#include<cstddef>
+#include<new>
+#include<utility>
+#include<type_traits>
+
+// 任务内联存储大小（字节）：可调用对象不超过该大小时不分配堆内存
+// 48字节内联区 + 8字节操作表指针 + 可丢弃标记，整个对象正好占一条缓存行
+const std::size_t TASK_INLINE_SIZE = 48;
+
+// 只可移动的 void() 可调用对象包装（类似 unique_function）
+// 与 std::function 相比：
+//   - 不要求可拷贝，可以直接保存 packaged_task / promise 等只可移动对象
+//   - 内联区更大（48字节），常见的"promise + 函数 + 几个参数"无需堆分配
+class TaskFunction {
+public:
+    TaskFunction() noexcept = default;
+    TaskFunction(std::nullptr_t) noexcept {}
+
+    template<typename F, typename D = typename std::decay<F>::type,
+        typename = typename std::enable_if<!std::is_same<D, TaskFunction>::value>::type>
+    TaskFunction(F&& f) {
+        if constexpr (fitsInline<D>()) {
+            new (storage_) D(std::forward<F>(f));
+            ops_ = &InlineOps<D>::ops;
+        } else {
+            *reinterpret_cast<D**>(storage_) = new D(std::forward<F>(f));
+            ops_ = &HeapOps<D>::ops;
+        }
+    }
+
+    TaskFunction(TaskFunction&& other) noexcept {
+        moveFrom(other);
+    }
+
+    TaskFunction& operator=(TaskFunction&& other) noexcept {
+        if (this != &other) {
+            reset();
+            moveFrom(other);
+        }
+        return *this;
+    }
+
+    TaskFunction& operator=(std::nullptr_t) noexcept {
+        reset();
+        return *this;
+    }
+
+    TaskFunction(const TaskFunction&) = delete;
+    TaskFunction& operator=(const TaskFunction&) = delete;
+
+    ~TaskFunction() {
+        reset();
+    }
+
+    // 执行可调用对象（调用前需保证非空）
+    void operator()() {
+        ops_->invoke(storage_);
+    }
+
+    explicit operator bool() const noexcept {
+        return ops_ != nullptr;
+    }
+
+    // 标记为用户提交的任务：线程池SHUTDOWN_ABORT时可以不执行直接销毁（Promise使Future得到broken_promise）
+    // 未标记的是线程池内部任务（分块、驱动任务、续延等），丢弃会让等待方永远等不到，必须执行
+    void markDroppable() noexcept {
+        droppable_ = true;
+    }
+
+    bool droppable() const noexcept {
+        return droppable_;
+    }
+
+    friend bool operator==(const TaskFunction& f, std::nullptr_t) noexcept { return !f; }
+    friend bool operator!=(const TaskFunction& f, std::nullptr_t) noexcept { return static_cast<bool>(f); }
+
+    // 可调用对象类型F是否会内联存放（供调用方做静态检查）
+    template<typename F>
+    static constexpr bool fitsInline() {
+        return sizeof(F) <= TASK_INLINE_SIZE
+            && alignof(F) <= alignof(std::max_align_t)
+            && std::is_nothrow_move_constructible<F>::value;
+    }
+
+private:
+    // 类型擦除的操作表
+    struct Ops {
+        void (*invoke)(void* storage);
+        void (*move)(void* from, void* to) noexcept;   // 移动并销毁源对象
+        void (*destroy)(void* storage) noexcept;
+    };
+
+    // 内联存放：对象直接构造在storage_中
+    template<typename F>
+    struct InlineOps {
+        static F* get(void* s) { return std::launder(reinterpret_cast<F*>(s)); }
+        static void invoke(void* s) { (*get(s))(); }
+        static void move(void* from, void* to) noexcept {
+            new (to) F(std::move(*get(from)));
+            get(from)->~F();
+        }
+        static void destroy(void* s) noexcept { get(s)->~F(); }
+        static constexpr Ops ops = { &invoke, &move, &destroy };
+    };
+
+    // 堆上存放：storage_中只保存对象指针，移动时只转移指针
+    template<typename F>
+    struct HeapOps {
+        static F*& get(void* s) { return *reinterpret_cast<F**>(s); }
+        static void invoke(void* s) { (*get(s))(); }
+        static void move(void* from, void* to) noexcept {
+            *reinterpret_cast<F**>(to) = get(from);
+        }
+        static void destroy(void* s) noexcept { delete get(s); }
+        static constexpr Ops ops = { &invoke, &move, &destroy };
+    };
+
+    void moveFrom(TaskFunction& other) noexcept {
+        if (other.ops_ != nullptr) {
+            other.ops_->move(other.storage_, storage_);
+            ops_ = other.ops_;
+            other.ops_ = nullptr;
+        }
+        droppable_ = other.droppable_;
+        other.droppable_ = false;
+    }
+
+    void reset() noexcept {
+        if (ops_ != nullptr) {
+            ops_->destroy(storage_);
+            ops_ = nullptr;
+        }
+        droppable_ = false;
+    }
+
+private:
+    alignas(std::max_align_t) unsigned char storage_[TASK_INLINE_SIZE];
+    const Ops* ops_ = nullptr;
+    bool droppable_ = false;  // 占用对齐填充，不增加对象大小
+};
+
+template<typename F>
+constexpr TaskFunction::Ops TaskFunction::InlineOps<F>::ops;
+template<typename F>
+constexpr TaskFunction::Ops TaskFunction::HeapOps<F>::ops;
+
+#endif
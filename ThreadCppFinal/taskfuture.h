@@ -0,0 +1,671 @@
+#ifndef TASKFUTURE_H
+#define TASKFUTURE_H
+
+#include<atomic>
+#include<mutex>
+#include<condition_variable>
+#include<chrono>
+#include<exception>
+#include<future>
+#include<new>
+#include<utility>
+#include<type_traits>
+#include<cstdint>
+#include<cstddef>
+#include<memory>
+#include<vector>
+#include<tuple>
+
+#include"slabpool.h"
+#include"taskfunction.h"
+
+// 轻量级 Promise/Future
+// 与 std::promise/std::future 相比：
+//   - 共享状态从slab对象池分配，稳定后提交任务不再调用 operator new
+//   - 共享状态内不含mutex/condition_variable，完成时只做一次原子交换，
+//     只有确实有线程在等待时才去唤醒
+//   - 阻塞等待使用按地址散列的全局等待桶（类似 parking lot），支持超时
+// 接口与 std::future 保持一致（get/wait/wait_for/wait_until/valid），
+// 并可隐式转换为 std::future 以兼容旧代码。
+// 另外支持续延：then() 在前驱完成后把回调投递到线程池执行，
+// when_all/when_any 组合多个Future，整个过程不占用阻塞等待的线程。
+// 在产生该Future的线程池的工作线程上调用 get()/wait() 时，等待期间帮忙执行排队任务。
+
+template<typename T> class Future;
+template<typename T> class Promise;
+
+namespace detail { class FutureStateBase; }
+
+// 续延调度器：线程池创建Promise时设置，then()的回调经它投递回线程池
+// post为空时回调在完成结果的线程上就地执行
+// helpWait：在线程池自己的工作线程上等待时，边执行排队任务边等到state就绪后返回true；
+// 其他线程返回false，由调用方正常阻塞
+struct FutureExecutor {
+    void (*post)(void* ctx, TaskFunction&& task) = nullptr;
+    void* ctx = nullptr;
+    bool (*helpWait)(void* ctx, detail::FutureStateBase* state) = nullptr;
+};
+
+namespace detail {
+
+// 按地址散列的等待桶，所有共享状态共用
+class WaitBuckets {
+public:
+    struct Bucket {
+        std::mutex mtx;
+        std::condition_variable cond;
+    };
+
+    static Bucket& of(const void* addr) {
+        static Bucket buckets[BUCKET_COUNT];
+        std::uintptr_t h = reinterpret_cast<std::uintptr_t>(addr);
+        h ^= h >> 12;
+        return buckets[(h >> 6) & (BUCKET_COUNT - 1)];
+    }
+
+private:
+    static constexpr std::size_t BUCKET_COUNT = 64;
+};
+
+// 共享状态中与结果类型无关的部分
+class FutureStateBase {
+public:
+    static constexpr std::uint32_t STATE_READY = 1;    // 结果已就绪
+    static constexpr std::uint32_t STATE_WAITING = 2;  // 有线程在阻塞等待
+    static constexpr std::uint32_t STATE_CONTINUATION = 4;  // 已挂上续延
+
+    bool isReady() const {
+        return (state_.load(std::memory_order_acquire) & STATE_READY) != 0;
+    }
+
+    void wait() {
+        if (isReady()) return;
+        // 工作线程上等待同一线程池的任务：帮忙执行而不是占着线程阻塞（避免线程耗尽死锁）
+        if (executor_.helpWait != nullptr && executor_.helpWait(executor_.ctx, this)) return;
+        WaitBuckets::Bucket& b = WaitBuckets::of(this);
+        state_.fetch_or(STATE_WAITING, std::memory_order_relaxed);
+        std::unique_lock<std::mutex> lock(b.mtx);
+        b.cond.wait(lock, [this]()->bool { return isReady(); });
+    }
+
+    template<typename Clock, typename Duration>
+    bool waitUntil(const std::chrono::time_point<Clock, Duration>& deadline) {
+        if (isReady()) return true;
+        WaitBuckets::Bucket& b = WaitBuckets::of(this);
+        state_.fetch_or(STATE_WAITING, std::memory_order_relaxed);
+        std::unique_lock<std::mutex> lock(b.mtx);
+        return b.cond.wait_until(lock, deadline, [this]()->bool { return isReady(); });
+    }
+
+    // 挂上续延（每个状态至多一个）：结果已就绪则立即触发，否则由完成方触发
+    // 续延和就绪两个标志位由同一原子变量的RMW设置，恰好有一方看到对方并负责执行
+    // runInline为true时总在当前线程执行，否则经executor投递
+    void attach(TaskFunction&& continuation, bool runInline) {
+        continuation_ = std::move(continuation);
+        continuationInline_ = runInline;
+        std::uint32_t prev = state_.fetch_or(STATE_CONTINUATION, std::memory_order_acq_rel);
+        if (prev & STATE_READY) runContinuation();
+    }
+
+    FutureExecutor executor() const {
+        return executor_;
+    }
+
+    void setExecutor(FutureExecutor executor) {
+        executor_ = executor;
+    }
+
+    // 引用计数：Future和Promise各持有一份
+    void addRef() {
+        refs_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // 返回true表示最后一个引用已释放
+    bool dropRef() {
+        return refs_.fetch_sub(1, std::memory_order_acq_rel) == 1;
+    }
+
+protected:
+    FutureStateBase() = default;
+
+    // 标记就绪（结果已写入之后调用）；有等待者时经由等待桶唤醒
+    // 等待方在桶锁内检查就绪，这里先置位再加桶锁通知，不会丢失唤醒
+    void markReady() {
+        std::uint32_t prev = state_.fetch_or(STATE_READY, std::memory_order_acq_rel);
+        if (prev & STATE_WAITING) {
+            WaitBuckets::Bucket& b = WaitBuckets::of(this);
+            { std::lock_guard<std::mutex> lock(b.mtx); }
+            b.cond.notify_all();
+        }
+        if (prev & STATE_CONTINUATION) runContinuation();
+    }
+
+private:
+    // 取出续延再执行：续延通常持有引用本状态的对象，取出即打破引用环
+    void runContinuation() {
+        TaskFunction continuation(std::move(continuation_));
+        if (!continuationInline_ && executor_.post != nullptr) {
+            executor_.post(executor_.ctx, std::move(continuation));
+        } else {
+            continuation();
+        }
+    }
+
+protected:
+    std::atomic<std::uint32_t> state_{0};
+    std::atomic<std::uint32_t> refs_{2};
+    std::exception_ptr error_;
+    FutureExecutor executor_;
+    TaskFunction continuation_;
+    bool continuationInline_ = false;
+};
+
+// 带结果存储的共享状态
+template<typename T>
+class FutureState : public FutureStateBase {
+public:
+    static FutureState* create() {
+        return new (slabAllocate<FutureState>()) FutureState();
+    }
+
+    static void release(FutureState* s) {
+        if (s != nullptr && s->dropRef()) {
+            s->~FutureState();
+            slabDeallocate<FutureState>(s);
+        }
+    }
+
+    template<typename... Args>
+    void setValue(Args&&... args) {
+        new (storage_) T(std::forward<Args>(args)...);
+        hasValue_ = true;
+        markReady();
+    }
+
+    void setException(std::exception_ptr e) {
+        error_ = std::move(e);
+        markReady();
+    }
+
+    // 取出结果（须已就绪），异常结果重新抛出
+    T take() {
+        if (error_) std::rethrow_exception(error_);
+        return std::move(*value());
+    }
+
+private:
+    FutureState() = default;
+    ~FutureState() {
+        if (hasValue_) value()->~T();
+    }
+
+    T* value() { return std::launder(reinterpret_cast<T*>(storage_)); }
+
+private:
+    alignas(T) unsigned char storage_[sizeof(T)];
+    bool hasValue_ = false;
+};
+
+template<>
+class FutureState<void> : public FutureStateBase {
+public:
+    static FutureState* create() {
+        return new (slabAllocate<FutureState>()) FutureState();
+    }
+
+    static void release(FutureState* s) {
+        if (s != nullptr && s->dropRef()) {
+            s->~FutureState();
+            slabDeallocate<FutureState>(s);
+        }
+    }
+
+    void setValue() {
+        markReady();
+    }
+
+    void setException(std::exception_ptr e) {
+        error_ = std::move(e);
+        markReady();
+    }
+
+    void take() {
+        if (error_) std::rethrow_exception(error_);
+    }
+
+private:
+    FutureState() = default;
+    ~FutureState() = default;
+};
+
+// then()回调的调用方式：能接受Future<T>就传入已就绪的Future（由回调自行处理异常），
+// 否则传入结果值（void时无参数），前驱的异常跳过回调直接传给后继
+// 注意：泛型lambda总是按Future<T>传参
+template<typename T, typename F, bool TakesFuture = std::is_invocable<F&, Future<T>>::value>
+struct ThenResult;
+
+template<typename T, typename F>
+struct ThenResult<T, F, true> {
+    using type = std::invoke_result_t<F&, Future<T>>;
+    static type call(F& f, Future<T>& prev) { return f(std::move(prev)); }
+};
+
+template<typename T, typename F>
+struct ThenResult<T, F, false> {
+    using type = std::invoke_result_t<F&, T>;
+    static type call(F& f, Future<T>& prev) { return f(prev.get()); }
+};
+
+template<typename F>
+struct ThenResult<void, F, false> {
+    using type = std::invoke_result_t<F&>;
+    template<typename P>  // P即Future<void>，写成模板以推迟到Future定义之后实例化
+    static type call(F& f, P& prev) { prev.get(); return f(); }
+};
+
+// 回调返回Future<U>时自动展开：then()得到Future<U>而不是Future<Future<U>>
+template<typename R>
+struct UnwrapFuture {
+    static constexpr bool isFuture = false;
+    using type = R;
+};
+
+template<typename U>
+struct UnwrapFuture<Future<U>> {
+    static constexpr bool isFuture = true;
+    using type = U;
+};
+
+// 组合器访问Future内部状态的入口
+struct FutureAccess {
+    template<typename T>
+    static FutureState<T>* state(Future<T>& f) {
+        return f.state_;
+    }
+
+    // f就绪时在完成线程上执行c（f本身保持有效；空Future视为已就绪）
+    template<typename T>
+    static void subscribe(Future<T>& f, TaskFunction&& c) {
+        if (f.state_ == nullptr) {
+            c();
+            return;
+        }
+        f.state_->attach(std::move(c), true);
+    }
+
+    // inner就绪后把它的结果（值或异常）转交给promise，在完成inner的线程上执行
+    template<typename U>
+    static void forward(Future<U>&& inner, Promise<U>&& promise) {
+        FutureState<U>* s = inner.state_;
+        auto relay = [inner = std::move(inner), promise = std::move(promise)]() mutable {
+            auto get = [&]() -> U { return inner.get(); };
+            promise.run(get);
+        };
+        if (s == nullptr) {
+            relay();
+            return;
+        }
+        s->attach(std::move(relay), true);
+    }
+
+    template<typename T>
+    static FutureExecutor executor(Future<T>& f) {
+        return f.state_ != nullptr ? f.state_->executor() : FutureExecutor();
+    }
+};
+
+} // namespace detail
+
+// 结果的接收端（只可移动）
+template<typename T>
+class Future {
+public:
+    Future() noexcept = default;
+
+    Future(Future&& other) noexcept
+        : state_(other.state_)
+    {
+        other.state_ = nullptr;
+    }
+
+    Future& operator=(Future&& other) noexcept {
+        if (this != &other) {
+            detail::FutureState<T>::release(state_);
+            state_ = other.state_;
+            other.state_ = nullptr;
+        }
+        return *this;
+    }
+
+    Future(const Future&) = delete;
+    Future& operator=(const Future&) = delete;
+
+    ~Future() {
+        detail::FutureState<T>::release(state_);
+    }
+
+    // 是否关联了共享状态（get之后变为false，与std::future一致）
+    bool valid() const noexcept {
+        return state_ != nullptr;
+    }
+
+    // 结果是否已就绪（不阻塞）
+    bool is_ready() const {
+        return state_ != nullptr && state_->isReady();
+    }
+
+    // 阻塞直到就绪并取出结果；任务抛出的异常在这里重新抛出
+    T get() {
+        if (state_ == nullptr) throw std::future_error(std::future_errc::no_state);
+        state_->wait();
+        detail::FutureState<T>* s = state_;
+        state_ = nullptr;
+        struct Releaser {
+            detail::FutureState<T>* s;
+            ~Releaser() { detail::FutureState<T>::release(s); }
+        } releaser{ s };
+        return s->take();
+    }
+
+    void wait() const {
+        if (state_ == nullptr) throw std::future_error(std::future_errc::no_state);
+        state_->wait();
+    }
+
+    template<typename Rep, typename Period>
+    std::future_status wait_for(const std::chrono::duration<Rep, Period>& timeout) const {
+        return wait_until(std::chrono::steady_clock::now() + timeout);
+    }
+
+    template<typename Clock, typename Duration>
+    std::future_status wait_until(const std::chrono::time_point<Clock, Duration>& deadline) const {
+        if (state_ == nullptr) throw std::future_error(std::future_errc::no_state);
+        return state_->waitUntil(deadline) ? std::future_status::ready : std::future_status::timeout;
+    }
+
+    // 续延：本Future就绪后执行fn，返回fn结果的Future；调用后本Future失效
+    // 由线程池产生的Future，fn投递到同一线程池执行，不占用等待的线程
+    // fn的参数形式见detail::ThenResult；fn返回Future<U>时结果自动展开为Future<U>
+    template<typename F>
+    auto then(F&& fn)
+        -> Future<typename detail::UnwrapFuture<typename detail::ThenResult<T, std::decay_t<F>>::type>::type>
+    {
+        using Then = detail::ThenResult<T, std::decay_t<F>>;
+        using Raw = typename Then::type;
+        using R = typename detail::UnwrapFuture<Raw>::type;
+        if (state_ == nullptr) throw std::future_error(std::future_errc::no_state);
+
+        detail::FutureState<T>* s = state_;
+        Promise<R> promise(s->executor());
+        Future<R> result = promise.get_future();
+        s->attach([prev = std::move(*this), promise = std::move(promise),
+            f = std::forward<F>(fn)]() mutable {
+            Future<T> ready(std::move(prev));
+            if constexpr (detail::UnwrapFuture<Raw>::isFuture) {
+                Raw inner;
+                try {
+                    inner = Then::call(f, ready);
+                } catch (...) {
+                    promise.set_exception(std::current_exception());
+                    return;
+                }
+                detail::FutureAccess::forward(std::move(inner), std::move(promise));
+            } else {
+                auto call = [&]() -> R { return Then::call(f, ready); };
+                promise.run(call);
+            }
+        }, false);
+        return result;
+    }
+
+    // 兼容旧接口：转换为std::future（仅为兼容，会额外分配一次内存）
+    operator std::future<T>() && {
+        return std::async(std::launch::deferred,
+            [f = std::move(*this)]() mutable -> T { return f.get(); });
+    }
+
+private:
+    friend class Promise<T>;
+    friend struct detail::FutureAccess;
+
+    explicit Future(detail::FutureState<T>* s) noexcept
+        : state_(s)
+    {}
+
+private:
+    detail::FutureState<T>* state_ = nullptr;
+};
+
+// 结果的写入端（只可移动，通常随任务一起存放在TaskFunction中）
+// 未写入结果就析构时，Future端得到 broken_promise 异常
+template<typename T>
+class Promise {
+public:
+    Promise()
+        : state_(detail::FutureState<T>::create())
+    {}
+
+    // 指定续延调度器：对应Future上的then()回调经它投递
+    explicit Promise(FutureExecutor executor)
+        : state_(detail::FutureState<T>::create())
+    {
+        state_->setExecutor(executor);
+    }
+
+    Promise(Promise&& other) noexcept
+        : state_(other.state_)
+        , futureRetrieved_(other.futureRetrieved_)
+    {
+        other.state_ = nullptr;
+    }
+
+    Promise& operator=(Promise&& other) noexcept {
+        if (this != &other) {
+            abandon();
+            state_ = other.state_;
+            futureRetrieved_ = other.futureRetrieved_;
+            other.state_ = nullptr;
+        }
+        return *this;
+    }
+
+    Promise(const Promise&) = delete;
+    Promise& operator=(const Promise&) = delete;
+
+    ~Promise() {
+        abandon();
+    }
+
+    // 取得对应的Future（只能调用一次）
+    Future<T> get_future() {
+        if (state_ == nullptr) throw std::future_error(std::future_errc::no_state);
+        if (futureRetrieved_) throw std::future_error(std::future_errc::future_already_retrieved);
+        futureRetrieved_ = true;
+        return Future<T>(state_);
+    }
+
+    template<typename... Args>
+    void set_value(Args&&... args) {
+        detail::FutureState<T>* s = detach();
+        s->setValue(std::forward<Args>(args)...);
+        detail::FutureState<T>::release(s);
+    }
+
+    void set_exception(std::exception_ptr e) {
+        detail::FutureState<T>* s = detach();
+        s->setException(std::move(e));
+        detail::FutureState<T>::release(s);
+    }
+
+    // 执行可调用对象并写入其返回值或异常
+    template<typename F>
+    void run(F& f) {
+        try {
+            if constexpr (std::is_void<T>::value) {
+                f();
+                set_value();
+            } else {
+                set_value(f());
+            }
+        } catch (...) {
+            if (state_ != nullptr) set_exception(std::current_exception());
+        }
+    }
+
+private:
+    // 交出共享状态的所有权，之后Promise不再持有它；
+    // 若调用方从未取走Future，先补上Future端那份引用的释放
+    detail::FutureState<T>* detach() {
+        if (state_ == nullptr) throw std::future_error(std::future_errc::promise_already_satisfied);
+        detail::FutureState<T>* s = state_;
+        state_ = nullptr;
+        if (!futureRetrieved_) detail::FutureState<T>::release(s);
+        return s;
+    }
+
+    void abandon() {
+        if (state_ != nullptr) {
+            set_exception(std::make_exception_ptr(
+                std::future_error(std::future_errc::broken_promise)));
+        }
+    }
+
+private:
+    detail::FutureState<T>* state_ = nullptr;
+    bool futureRetrieved_ = false;
+};
+
+// when_any的结果：最先就绪的下标和与输入一一对应的Future
+template<typename Sequence>
+struct WhenAnyResult {
+    std::size_t index;
+    Sequence futures;
+};
+
+// 全部输入就绪后就绪，结果为输入Future本身（各自的值或异常由调用方逐个get）
+// 输入的计数在最后一个完成的线程上递减并交付，不占用任何等待线程
+// 结果Future沿用第一个输入的调度器，其上的then()仍在同一线程池执行
+template<typename T>
+Future<std::vector<Future<T>>> when_all(std::vector<Future<T>> futures) {
+    using Sequence = std::vector<Future<T>>;
+    struct Context {
+        Context(Sequence&& fs, FutureExecutor ex)
+            : futures(std::move(fs)), remaining(futures.size() + 1), promise(ex) {}
+
+        // 计数多1，挂完全部续延后再释放，期间futures不会被交出
+        static void finish(const std::shared_ptr<Context>& ctx) {
+            if (ctx->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                ctx->promise.set_value(std::move(ctx->futures));
+            }
+        }
+
+        Sequence futures;
+        std::atomic<std::size_t> remaining;
+        Promise<Sequence> promise;
+    };
+
+    FutureExecutor ex = futures.empty() ? FutureExecutor() : detail::FutureAccess::executor(futures[0]);
+    auto ctx = std::make_shared<Context>(std::move(futures), ex);
+    Future<Sequence> result = ctx->promise.get_future();
+    for (auto& f : ctx->futures) {
+        detail::FutureAccess::subscribe(f, [ctx]() { Context::finish(ctx); });
+    }
+    Context::finish(ctx);
+    return result;
+}
+
+template<typename... Ts>
+Future<std::tuple<Future<Ts>...>> when_all(Future<Ts>&&... futures) {
+    using Sequence = std::tuple<Future<Ts>...>;
+    struct Context {
+        Context(FutureExecutor ex, Future<Ts>&&... fs)
+            : futures(std::move(fs)...), remaining(sizeof...(Ts) + 1), promise(ex) {}
+
+        static void finish(const std::shared_ptr<Context>& ctx) {
+            if (ctx->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                ctx->promise.set_value(std::move(ctx->futures));
+            }
+        }
+
+        Sequence futures;
+        std::atomic<std::size_t> remaining;
+        Promise<Sequence> promise;
+    };
+
+    FutureExecutor ex;
+    bool found = false;
+    auto pick = [&](auto& f) {
+        if (!found) { ex = detail::FutureAccess::executor(f); found = true; }
+    };
+    (pick(futures), ...);
+    auto ctx = std::make_shared<Context>(ex, std::move(futures)...);
+    Future<Sequence> result = ctx->promise.get_future();
+    std::apply([&](auto&... f) {
+        (detail::FutureAccess::subscribe(f, [ctx]() { Context::finish(ctx); }), ...);
+    }, ctx->futures);
+    Context::finish(ctx);
+    return result;
+}
+
+// 任一输入就绪后就绪；输入为空时index为size_t(-1)且立即就绪
+// 结果中的futures是与输入一一对应的新Future（各输入的结果原样转交）：
+// 输入上挂的是when_any自己的续延，交回未就绪的输入会让调用方的then()与完成方争用同一个续延槽位，
+// 新Future上没有挂任何续延，可以继续then()或再次when_any
+template<typename T>
+Future<WhenAnyResult<std::vector<Future<T>>>> when_any(std::vector<Future<T>> futures) {
+    using Sequence = std::vector<Future<T>>;
+    using Result = WhenAnyResult<Sequence>;
+    struct Context {
+        Context(Sequence&& fs, FutureExecutor ex) : futures(std::move(fs)), promise(ex) {}
+
+        static void finish(const std::shared_ptr<Context>& ctx, std::size_t index) {
+            if (!ctx->done.exchange(true, std::memory_order_acq_rel)) {
+                ctx->promise.set_value(Result{ index, std::move(ctx->futures) });
+            }
+        }
+
+        Sequence futures;
+        std::atomic_bool done{false};
+        Promise<Result> promise;
+    };
+
+    FutureExecutor ex = futures.empty() ? FutureExecutor() : detail::FutureAccess::executor(futures[0]);
+
+    // 为每个有状态的输入准备转交用的Promise，先把对应的新Future放进结果
+    Sequence outputs;
+    outputs.reserve(futures.size());
+    std::vector<Promise<T>> relays;  // 只为有状态的输入创建，按输入顺序排列
+    for (auto& f : futures) {
+        if (detail::FutureAccess::state(f) == nullptr) {
+            outputs.push_back(Future<T>());
+            continue;
+        }
+        relays.emplace_back(detail::FutureAccess::executor(f));
+        outputs.push_back(relays.back().get_future());
+    }
+
+    auto ctx = std::make_shared<Context>(std::move(outputs), ex);
+    Future<Result> result = ctx->promise.get_future();
+    if (futures.empty()) {
+        Context::finish(ctx, static_cast<std::size_t>(-1));
+        return result;
+    }
+
+    // 第一个就绪者会把futures整体交出，之后不能再访问ctx->futures，续延只持有输入和各自的Promise
+    std::size_t r = 0;
+    for (std::size_t i = 0; i < futures.size(); i++) {
+        detail::FutureState<T>* s = detail::FutureAccess::state(futures[i]);
+        if (s == nullptr) {
+            Context::finish(ctx, i);
+            continue;
+        }
+        s->attach([ctx, i, input = std::move(futures[i]), promise = std::move(relays[r++])]() mutable {
+            auto get = [&]() -> T { return input.get(); };
+            promise.run(get);  // 先转交结果，交付时获胜者的新Future已经就绪
+            Context::finish(ctx, i);
+        }, true);
+    }
+    return result;
+}
+
+#endif
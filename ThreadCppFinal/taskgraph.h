@@ -0,0 +1,219 @@
+#ifndef TASKGRAPH_H
+#define TASKGRAPH_H
+
+#include<deque>
+#include<vector>
+#include<atomic>
+#include<exception>
+#include<stdexcept>
+#include<algorithm>
+#include<utility>
+#include<cstddef>
+
+#include"threadpool.h"
+
+// 静态任务依赖图（DAG），在ThreadPool上执行
+// 用法：addNode添加节点，precede(a, b)声明b在a完成后才能执行，run()执行整张图。
+//   - 每个节点带一个原子前驱计数，最后一个前驱完成时由完成它的线程调度该节点：
+//     新就绪的节点中第一个直接在当前线程继续执行（数据还在缓存里），
+//     其余投递到线程池（工作窃取模式下进入当前线程的本地队列）
+//   - 开启关键路径优先后，节点优先级为从它到汇点的最长路径（按cost累加），
+//     根节点和每个节点的后继都按优先级从高到低调度（投递到本地LIFO队列时倒序投递，
+//     所有者先取到的仍是优先级最高的；窃取方从另一端取走优先级较低的）
+//   - 图结构在首次运行时整理（环检测、计算优先级、排序后继），
+//     之后重复运行只重置计数器，不再分配内存
+// 节点抛出的第一个异常在run()结束时重新抛出，之后尚未开始的节点跳过执行。
+// 同一张图不能并发运行，运行期间不能修改。
+class TaskGraph {
+public:
+    using NodeId = std::size_t;
+
+    explicit TaskGraph(ThreadPool& pool)
+        : pool_(pool)
+        , prepared_(false)
+        , criticalPath_(false)
+        , failed_(false)
+        , done_(0)
+    {}
+
+    TaskGraph(const TaskGraph&) = delete;
+    TaskGraph& operator=(const TaskGraph&) = delete;
+
+    // 添加节点；cost为估计耗时，仅用于计算关键路径优先级
+    // fn每次运行图时都会被调用一次
+    template<typename Func>
+    NodeId addNode(Func&& fn, long cost = 1) {
+        nodes_.emplace_back();
+        Node& node = nodes_.back();
+        node.fn = TaskFunction(std::forward<Func>(fn));
+        node.cost = cost;
+        prepared_ = false;
+        return nodes_.size() - 1;
+    }
+
+    // 声明依赖：after 在 before 完成之后才能执行
+    void precede(NodeId before, NodeId after) {
+        if (before >= nodes_.size() || after >= nodes_.size() || before == after) {
+            throw std::invalid_argument("TaskGraph::precede 节点编号无效");
+        }
+        nodes_[before].successors.push_back(after);
+        nodes_[after].predecessors++;
+        prepared_ = false;
+    }
+
+    // 是否按最长剩余路径优先调度（默认关闭，按添加顺序调度）
+    void setCriticalPathPriority(bool enable) {
+        if (criticalPath_ != enable) prepared_ = false;
+        criticalPath_ = enable;
+    }
+
+    // 节点的关键路径优先级（首次运行或调用prepare后有效）
+    long priority(NodeId id) const {
+        return nodes_[id].priority;
+    }
+
+    std::size_t size() const {
+        return nodes_.size();
+    }
+
+    // 整理图结构：检测环、计算优先级、排序后继；图中有环时抛出std::logic_error
+    // run()会按需自动调用，提前调用可把整理的开销移出首次运行
+    void prepare() {
+        if (prepared_) return;
+
+        // Kahn拓扑排序
+        std::size_t n = nodes_.size();
+        std::vector<std::size_t> indegree(n);
+        std::vector<NodeId> order;
+        order.reserve(n);
+        for (NodeId i = 0; i < n; i++) {
+            indegree[i] = nodes_[i].predecessors;
+            if (indegree[i] == 0) order.push_back(i);
+        }
+        for (std::size_t k = 0; k < order.size(); k++) {
+            for (NodeId s : nodes_[order[k]].successors) {
+                if (--indegree[s] == 0) order.push_back(s);
+            }
+        }
+        if (order.size() != n) {
+            throw std::logic_error("TaskGraph 中存在环");
+        }
+
+        // 逆拓扑序计算到汇点的最长路径
+        for (std::size_t k = n; k-- > 0;) {
+            Node& node = nodes_[order[k]];
+            long longest = 0;
+            for (NodeId s : node.successors) longest = std::max(longest, nodes_[s].priority);
+            node.priority = node.cost + longest;
+        }
+
+        roots_.clear();
+        for (NodeId i = 0; i < n; i++) {
+            if (nodes_[i].predecessors == 0) roots_.push_back(i);
+        }
+        if (criticalPath_) {
+            auto higher = [this](NodeId a, NodeId b) { return nodes_[a].priority > nodes_[b].priority; };
+            std::stable_sort(roots_.begin(), roots_.end(), higher);
+            for (Node& node : nodes_) {
+                std::stable_sort(node.successors.begin(), node.successors.end(), higher);
+            }
+        }
+        prepared_ = true;
+    }
+
+    // 执行整张图并阻塞到全部节点完成，等待期间调用线程也帮忙执行任务
+    // 可在工作线程内部调用（嵌套图）
+    void run() {
+        if (nodes_.empty()) return;
+        prepare();
+
+        for (Node& node : nodes_) {
+            node.pending.store(node.predecessors, std::memory_order_relaxed);
+        }
+        failed_.store(false, std::memory_order_relaxed);
+        error_ = nullptr;
+        done_.reset(nodes_.size());
+
+        // 第一个根节点由调用线程执行，其余投递到线程池
+        if (pool_.spawnsToLocalQueue()) {
+            for (std::size_t i = roots_.size(); i-- > 1;) spawn(roots_[i]);
+        } else {
+            for (std::size_t i = 1; i < roots_.size(); i++) spawn(roots_[i]);
+        }
+        execute(roots_[0]);
+
+        pool_.helpUntil(done_);
+        if (error_) std::rethrow_exception(error_);
+    }
+
+private:
+    static constexpr NodeId NO_NODE = static_cast<NodeId>(-1);
+
+    struct Node {
+        TaskFunction fn;
+        std::vector<NodeId> successors;         // 后继（开启关键路径优先时按优先级降序）
+        std::size_t predecessors = 0;           // 静态前驱数
+        std::atomic<std::size_t> pending{0};    // 本轮尚未完成的前驱数
+        long cost = 1;                          // 估计耗时
+        long priority = 0;                      // 到汇点的最长路径
+    };
+
+    // 把节点投递到线程池；队列满时在当前线程执行
+    void spawn(NodeId id) {
+        if (!pool_.trySpawn([this, id]() { execute(id); })) {
+            execute(id);
+        }
+    }
+
+    // 执行节点，然后释放后继：第一个就绪的后继沿用当前线程继续执行，其余投递
+    void execute(NodeId id) {
+        while (id != NO_NODE) {
+            Node& node = nodes_[id];
+            if (!failed_.load(std::memory_order_relaxed)) {
+                try {
+                    node.fn();
+                } catch (...) {
+                    if (!failed_.exchange(true, std::memory_order_relaxed)) {
+                        error_ = std::current_exception();
+                    }
+                }
+            }
+
+            // 就绪后继中排在最前（优先级最高）的留给当前线程，其余投递：
+            // 公共队列先进先出，按顺序投递；本地队列后进先出，倒序投递
+            NodeId next = NO_NODE;
+            if (pool_.spawnsToLocalQueue()) {
+                for (std::size_t k = node.successors.size(); k-- > 0;) {
+                    NodeId s = node.successors[k];
+                    if (nodes_[s].pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                        if (next != NO_NODE) spawn(next);
+                        next = s;
+                    }
+                }
+            } else {
+                for (NodeId s : node.successors) {
+                    if (nodes_[s].pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                        if (next == NO_NODE) next = s;
+                        else spawn(s);
+                    }
+                }
+            }
+            // next尚未完成，计数不会在这里归零，之后继续访问图是安全的
+            done_.done();
+            id = next;
+        }
+    }
+
+private:
+    ThreadPool& pool_;
+    std::deque<Node> nodes_;      // deque扩容不移动已有节点（节点含原子变量）
+    std::vector<NodeId> roots_;   // 无前驱的节点
+    bool prepared_;               // 结构是否已整理
+    bool criticalPath_;           // 是否关键路径优先
+
+    std::atomic_bool failed_;     // 本轮是否已有节点抛出异常
+    std::exception_ptr error_;    // 第一个异常
+    JoinCounter done_;            // 本轮尚未完成的节点数
+};
+
+#endif
@@ -0,0 +1,160 @@
+#ifndef TASKGROUP_H
+#define TASKGROUP_H
+
+#include<atomic>
+#include<exception>
+#include<mutex>
+#include<utility>
+#include<cstddef>
+
+#include"threadpool.h"
+
+// 任务组（结构化并发），在ThreadPool上执行
+// 用法：run(fn)提交属于本组的任务（任务内部也可以继续run），wait()等待组内全部任务完成。
+//   - 完成跟踪只用一个原子计数（JoinCounter），单个任务不分配Future、不分配共享状态，
+//     小的可调用对象直接放在任务的内联存储里
+//   - wait()等待期间帮忙执行排队中的任务，可在工作线程内嵌套使用，固定线程数下也不会死锁
+//   - 可选并发上限：组内同时运行的任务不超过maxConcurrency个。任务先在组内排队，
+//     最多maxConcurrency个驱动任务在线程池中接力执行它们，一个组不会占满所有工作线程
+// 任务抛出的第一个异常在wait()中重新抛出，之后尚未开始的任务跳过执行；
+// cancel()同样跳过尚未开始的任务，但wait()不抛出异常。wait()返回后本组可以继续使用。
+// 析构时自动等待（不抛出异常），任务引用本组时须保证组的生命周期覆盖所有任务。
+class TaskGroup {
+public:
+    // maxConcurrency为0表示不限制
+    explicit TaskGroup(ThreadPool& pool, std::size_t maxConcurrency = 0)
+        : pool_(pool)
+        , maxConcurrency_(maxConcurrency)
+        , active_(0)
+        , failed_(false)
+        , cancelled_(false)
+        , done_(1)  // 组自身持有一个计数，wait()时释放
+    {}
+
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    ~TaskGroup() {
+        join();
+    }
+
+    // 提交一个属于本组的任务
+    template<typename Func>
+    void run(Func&& fn) {
+        done_.add();
+        TaskFunction task([this, fn = std::forward<Func>(fn)]() mutable {
+            execute(fn);
+        });
+        if (maxConcurrency_ == 0) {
+            spawn(std::move(task));
+            return;
+        }
+        bool startDriver = false;
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            backlog_.push(std::move(task));
+            if (active_ < maxConcurrency_) {
+                active_++;
+                startDriver = true;
+            }
+        }
+        if (startDriver) {
+            done_.add();
+            spawn(TaskFunction([this]() { drive(); }));
+        }
+    }
+
+    // 等待组内全部任务完成（等待期间帮忙执行任务），有任务抛出异常时重新抛出第一个
+    void wait() {
+        join();
+        std::exception_ptr error = std::move(error_);
+        error_ = nullptr;
+        failed_.store(false, std::memory_order_relaxed);
+        cancelled_.store(false, std::memory_order_relaxed);
+        if (error) std::rethrow_exception(error);
+    }
+
+    // 跳过组内尚未开始的任务（已在执行的任务照常完成），之后仍需wait()
+    void cancel() {
+        cancelled_.store(true, std::memory_order_relaxed);
+    }
+
+    bool isCancelled() const {
+        return cancelled_.load(std::memory_order_relaxed);
+    }
+
+private:
+    // 释放组自身的计数并等待归零，之后重新持有一个计数以便复用
+    void join() {
+        done_.done();
+        pool_.helpUntil(done_);
+        done_.reset(1);
+    }
+
+    // 投递到线程池；队列满时在当前线程执行
+    void spawn(TaskFunction&& task) {
+        if (!pool_.trySpawn(std::move(task))) {
+            task();
+        }
+    }
+
+    template<typename Func>
+    void execute(Func& fn) {
+        if (!failed_.load(std::memory_order_relaxed) && !cancelled_.load(std::memory_order_relaxed)) {
+            try {
+                fn();
+            } catch (...) {
+                if (!failed_.exchange(true, std::memory_order_relaxed)) {
+                    error_ = std::current_exception();
+                }
+            }
+        }
+        // 计数归零后wait()可能立即返回并销毁本组，这里是最后一次访问
+        done_.done();
+    }
+
+    // 有并发上限时的驱动任务：占用一个并发名额，从组内队列取任务执行
+    // 每执行完一个就把自己重新排到线程池队列末尾（让其他任务有机会执行），
+    // 线程池队列满时在当前线程上继续；组内队列取空时让出名额
+    // 驱动任务自身也持有一个计数，执行期间本组不会被销毁
+    void drive() {
+        for (;;) {
+            TaskFunction body;
+            {
+                std::lock_guard<std::mutex> lock(mtx_);
+                if (backlog_.empty()) {
+                    active_--;
+                    break;
+                }
+                body = std::move(backlog_.front());
+                backlog_.pop();
+            }
+            body();
+            {
+                std::lock_guard<std::mutex> lock(mtx_);
+                if (backlog_.empty()) {
+                    active_--;
+                    break;
+                }
+            }
+            done_.add();
+            if (pool_.trySpawn(TaskFunction([this]() { drive(); }))) break;
+            done_.undo();
+        }
+        done_.done();
+    }
+
+private:
+    ThreadPool& pool_;
+    std::size_t maxConcurrency_;
+    std::mutex mtx_;
+    RingQueue<TaskFunction> backlog_;  // 有并发上限时在组内排队的任务（受mtx_保护）
+    std::size_t active_;               // 运行中的驱动任务数，即占用的并发名额（受mtx_保护）
+
+    std::atomic_bool failed_;          // 本轮是否已有任务抛出异常
+    std::atomic_bool cancelled_;       // 本轮是否已取消
+    std::exception_ptr error_;         // 第一个异常
+    JoinCounter done_;                 // 尚未完成的任务和驱动任务数（加上组自身的一个）
+};
+
+#endif
@@ -0,0 +1,202 @@
+#ifndef TASKTRACE_H
+#define TASKTRACE_H
+
+#include<atomic>
+#include<memory>
+#include<vector>
+#include<string>
+#include<cstdio>
+#include<cstddef>
+#include<cstdint>
+
+// 每个线程轨道默认可记录的事件数
+const std::size_t TRACE_DEFAULT_CAPACITY = 1 << 16;
+
+// 任务标签：提交时附带，在跟踪视图中作为任务名显示
+// 与Perfetto的TRACE_EVENT一致，只保存指针：需为字符串字面量，
+// 或至少存活到导出跟踪数据之后
+struct TaskLabel {
+    explicit TaskLabel(const char* n) : name(n) {}
+    const char* name;
+};
+
+// 一条跟踪记录：每个被跟踪的任务产生两条
+//   SUBMIT 记录在提交线程的轨道上：t0为提交时间
+//   RUN    记录在执行线程的轨道上：t0为出队时间，t1为开始时间，t2为结束时间
+struct TraceRecord {
+    enum Kind : std::uint32_t { SUBMIT = 0, RUN = 1 };
+
+    std::uint64_t id = 0;
+    std::int64_t t0 = 0;
+    std::int64_t t1 = 0;
+    std::int64_t t2 = 0;
+    const char* label = nullptr;
+    Kind kind = SUBMIT;
+};
+
+// 一条轨道的事件缓冲：定长数组，写满后丢弃新事件并计数
+// 写入方先无锁领取下标，写完后置ready标记；读取方只读取已就绪的槽位，
+// 因此可以在任务运行期间随时导出，互不阻塞
+class TraceBuffer {
+public:
+    explicit TraceBuffer(std::size_t capacity)
+        : slots_(new Slot[capacity])
+        , capacity_(capacity)
+    {}
+
+    bool push(const TraceRecord& rec) {
+        std::size_t i = next_.fetch_add(1, std::memory_order_relaxed);
+        if (i >= capacity_) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        slots_[i].rec = rec;
+        slots_[i].ready.store(true, std::memory_order_release);
+        return true;
+    }
+
+    // 依次访问已就绪的记录
+    template<typename Fn>
+    void forEach(Fn&& fn) const {
+        std::size_t n = next_.load(std::memory_order_acquire);
+        if (n > capacity_) n = capacity_;
+        for (std::size_t i = 0; i < n; i++) {
+            if (slots_[i].ready.load(std::memory_order_acquire)) fn(slots_[i].rec);
+        }
+    }
+
+    // 清空（调用时不能有线程正在写入）
+    void clear() {
+        std::size_t n = next_.load(std::memory_order_relaxed);
+        if (n > capacity_) n = capacity_;
+        for (std::size_t i = 0; i < n; i++) slots_[i].ready.store(false, std::memory_order_relaxed);
+        next_.store(0, std::memory_order_relaxed);
+        dropped_.store(0, std::memory_order_relaxed);
+    }
+
+    unsigned long long dropped() const {
+        return dropped_.load(std::memory_order_relaxed);
+    }
+
+private:
+    struct Slot {
+        TraceRecord rec;
+        std::atomic_bool ready{false};
+    };
+
+    std::unique_ptr<Slot[]> slots_;
+    std::size_t capacity_;
+    alignas(64) std::atomic<std::size_t> next_{0};
+    std::atomic<unsigned long long> dropped_{0};
+};
+
+// 任务生命周期跟踪：每个工作线程一条轨道，非工作线程按分片共用若干条轨道
+// 导出为Chrome跟踪格式（JSON），可直接在 chrome://tracing 或 ui.perfetto.dev 中打开：
+//   - 每个任务在执行线程上显示为一个时间片（名称为标签），参数中带排队时间
+//   - 从提交到出队显示为"queue"类别的异步区间
+//   - 提交点与开始执行之间有流向箭头，便于找到排队阻塞和任务扎堆
+class TaskTracer {
+public:
+    TaskTracer(int workerTracks, int externalTracks, std::size_t capacity)
+        : workerTracks_(workerTracks)
+    {
+        for (int i = 0; i < workerTracks + externalTracks; i++) {
+            tracks_.emplace_back(std::make_unique<TraceBuffer>(capacity));
+        }
+    }
+
+    int workerTracks() const {
+        return workerTracks_;
+    }
+
+    std::uint64_t nextId() {
+        return nextId_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void record(int track, const TraceRecord& rec) {
+        tracks_[track]->push(rec);
+    }
+
+    void clear() {
+        for (auto& t : tracks_) t->clear();
+    }
+
+    // 因缓冲写满而丢弃的事件数
+    unsigned long long dropped() const {
+        unsigned long long n = 0;
+        for (const auto& t : tracks_) n += t->dropped();
+        return n;
+    }
+
+    // 导出Chrome跟踪JSON（时间单位微秒，以第一条记录为零点）
+    std::string toChromeJson(int pid = 1) const {
+        std::int64_t origin = INT64_MAX;
+        for (const auto& t : tracks_) {
+            t->forEach([&](const TraceRecord& r) { if (r.t0 < origin) origin = r.t0; });
+        }
+        if (origin == INT64_MAX) origin = 0;
+
+        std::string out = "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+        bool first = true;
+        auto emit = [&](const char* fmt, auto... args) {
+            char buf[512];
+            int n = std::snprintf(buf, sizeof(buf), fmt, args...);
+            if (n <= 0) return;
+            if (!first) out += ",\n";
+            first = false;
+            out.append(buf, static_cast<std::size_t>(n) < sizeof(buf) ? n : sizeof(buf) - 1);
+        };
+        auto us = [origin](std::int64_t ns) { return (ns - origin) / 1000.0; };
+
+        for (int tid = 0; tid < static_cast<int>(tracks_.size()); tid++) {
+            bool worker = tid < workerTracks_;
+            emit("{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":%d,\"tid\":%d,\"args\":{\"name\":\"%s %d\"}}",
+                pid, tid, worker ? "worker" : "external", worker ? tid : tid - workerTracks_);
+            tracks_[tid]->forEach([&](const TraceRecord& r) {
+                std::string name = escape(r.label != nullptr ? r.label : "task");
+                unsigned long long id = static_cast<unsigned long long>(r.id);
+                if (r.kind == TraceRecord::SUBMIT) {
+                    emit("{\"ph\":\"b\",\"cat\":\"queue\",\"name\":\"%s\",\"id\":%llu,\"pid\":%d,\"tid\":%d,\"ts\":%.3f}",
+                        name.c_str(), id, pid, tid, us(r.t0));
+                    emit("{\"ph\":\"s\",\"cat\":\"flow\",\"name\":\"submit\",\"id\":%llu,\"pid\":%d,\"tid\":%d,\"ts\":%.3f}",
+                        id, pid, tid, us(r.t0));
+                } else {
+                    emit("{\"ph\":\"e\",\"cat\":\"queue\",\"name\":\"%s\",\"id\":%llu,\"pid\":%d,\"tid\":%d,\"ts\":%.3f}",
+                        name.c_str(), id, pid, tid, us(r.t0));
+                    emit("{\"ph\":\"X\",\"cat\":\"task\",\"name\":\"%s\",\"pid\":%d,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f,"
+                        "\"args\":{\"id\":%llu,\"dequeued_us\":%.3f}}",
+                        name.c_str(), pid, tid, us(r.t1), (r.t2 - r.t1) / 1000.0, id, us(r.t0));
+                    emit("{\"ph\":\"f\",\"bp\":\"e\",\"cat\":\"flow\",\"name\":\"submit\",\"id\":%llu,\"pid\":%d,\"tid\":%d,\"ts\":%.3f}",
+                        id, pid, tid, us(r.t1));
+                }
+            });
+        }
+        out += "\n]}\n";
+        return out;
+    }
+
+private:
+    // 标签按JSON字符串转义（截断到64字符）
+    static std::string escape(const char* s) {
+        std::string r;
+        for (int i = 0; s[i] != '\0' && i < 64; i++) {
+            char c = s[i];
+            if (c == '"' || c == '\\') {
+                r += '\\';
+                r += c;
+            } else if (static_cast<unsigned char>(c) < 0x20) {
+                r += ' ';
+            } else {
+                r += c;
+            }
+        }
+        return r;
+    }
+
+private:
+    std::vector<std::unique_ptr<TraceBuffer>> tracks_;
+    int workerTracks_;
+    std::atomic<std::uint64_t> nextId_{1};
+};
+
+#endif
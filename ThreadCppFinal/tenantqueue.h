@@ -0,0 +1,187 @@
+#ifndef TENANTQUEUE_H
+#define TENANTQUEUE_H
+
+#include<atomic>
+#include<memory>
+#include<string>
+#include<cstddef>
+#include<cstdint>
+#include<utility>
+
+#include"ringqueue.h"
+#include"lanequeue.h"
+
+// 租户编号（ThreadPool::addTenant返回），0表示不属于任何租户
+using TenantId = std::uint32_t;
+
+// 最多可登记的租户数
+const int TENANT_MAX_COUNT = 64;
+
+// 单个租户的统计快照
+struct TenantStats {
+    std::string name;
+    unsigned weight = 0;            // 权重（每轮可出队的任务数）
+    std::size_t capacity = 0;       // 排队上限
+    std::size_t depth = 0;          // 当前排队数
+    unsigned long long submitted = 0;  // 累计入队数
+    unsigned long long dequeued = 0;   // 累计出队数
+    unsigned long long rejected = 0;   // 因排队已满而提交失败的次数
+    unsigned long long dropped = 0;    // drop-oldest丢弃的任务数
+    double avgWaitUs = 0.0;         // 平均排队时间（微秒）
+    double maxWaitUs = 0.0;         // 最大排队时间（微秒）
+};
+
+// 多租户队列：每个租户一条独立的有界FIFO，租户之间按加权差额轮转（DRR）出队
+// 轮到某个租户时它可以连续出队weight个任务，之后排到轮转队尾；
+// 租户排空时退出轮转，再有任务时重新排到队尾（空闲期间不攒额度）
+// 非线程安全，由调用方加锁；租户登记后不会移除，统计可无锁读取
+template<typename T>
+class TenantQueue {
+public:
+    TenantQueue() = default;
+    TenantQueue(const TenantQueue&) = delete;
+    TenantQueue& operator=(const TenantQueue&) = delete;
+
+    // 登记一个租户，返回编号（从1开始）；已达TENANT_MAX_COUNT时返回0
+    TenantId add(std::string name, unsigned weight, std::size_t capacity) {
+        int n = count_.load(std::memory_order_relaxed);
+        if (n >= TENANT_MAX_COUNT) return 0;
+        tenants_[n].reset(new Tenant(std::move(name), weight == 0 ? 1 : weight, capacity == 0 ? 1 : capacity));
+        count_.store(n + 1, std::memory_order_release);
+        return static_cast<TenantId>(n + 1);
+    }
+
+    bool valid(TenantId id) const {
+        return id != 0 && id <= static_cast<TenantId>(count_.load(std::memory_order_acquire));
+    }
+
+    void setWeight(TenantId id, unsigned weight) {
+        tenant(id).weight.store(weight == 0 ? 1 : weight, std::memory_order_relaxed);
+    }
+
+    bool full(TenantId id) const {
+        const Tenant& t = tenant(id);
+        return t.items.size() >= t.capacity;
+    }
+
+    void push(TenantId id, T&& task) {
+        Tenant& t = tenant(id);
+        t.items.emplace(detail::LaneItem<T>{ std::move(task), detail::laneNowNs() });
+        t.counters.onPush();
+        t.submitted.fetch_add(1, std::memory_order_relaxed);
+        if (!t.active) {
+            t.active = true;
+            t.credit = 0;
+            active_.emplace(id);
+        }
+        size_++;
+    }
+
+    // 按轮转顺序出队，全部为空时返回false；waitNs非空时写入排队时间
+    bool pop(T& task, std::int64_t* waitNs = nullptr) {
+        if (size_ == 0) return false;
+        TenantId id = active_.front();
+        while (tenant(id).items.empty()) {
+            // popOldest取空的租户：到这里才移出轮转
+            tenant(id).active = false;
+            active_.pop();
+            id = active_.front();
+        }
+        Tenant& t = tenant(id);
+        if (t.credit == 0) t.credit = t.weight.load(std::memory_order_relaxed);  // 新的一轮
+        take(t, task, waitNs);
+        t.credit--;
+        if (t.items.empty()) {
+            t.active = false;
+            t.credit = 0;
+            active_.pop();
+        } else if (t.credit == 0) {
+            active_.pop();
+            active_.emplace(id);
+        }
+        return true;
+    }
+
+    // 取出某个租户最早入队的任务（drop-oldest只挤掉同一租户的任务），租户为空时返回false
+    bool popOldest(TenantId id, T& task) {
+        Tenant& t = tenant(id);
+        if (t.items.empty()) return false;
+        take(t, task, nullptr);
+        t.dropped.fetch_add(1, std::memory_order_relaxed);
+        // 排空的租户留在轮转队列中，轮到时发现为空再移出
+        return true;
+    }
+
+    void onRejected(TenantId id) {
+        tenant(id).rejected.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    std::size_t size() const {
+        return size_;
+    }
+
+    bool empty() const {
+        return size_ == 0;
+    }
+
+    TenantStats stats(TenantId id) const {
+        TenantStats s;
+        if (!valid(id)) return s;
+        const Tenant& t = tenant(id);
+        LaneStats lane = t.counters.snapshot();
+        s.name = t.name;
+        s.weight = t.weight.load(std::memory_order_relaxed);
+        s.capacity = t.capacity;
+        s.depth = lane.depth;
+        s.submitted = t.submitted.load(std::memory_order_relaxed);
+        s.dequeued = lane.dequeued;
+        s.rejected = t.rejected.load(std::memory_order_relaxed);
+        s.dropped = t.dropped.load(std::memory_order_relaxed);
+        s.avgWaitUs = lane.avgWaitUs;
+        s.maxWaitUs = lane.maxWaitUs;
+        return s;
+    }
+
+private:
+    struct Tenant {
+        Tenant(std::string n, unsigned w, std::size_t cap)
+            : name(std::move(n)), weight(w), capacity(cap)
+        {}
+
+        const std::string name;
+        std::atomic<unsigned> weight;
+        const std::size_t capacity;
+        RingQueue<detail::LaneItem<T>> items;
+        unsigned credit = 0;   // 本轮剩余可出队数
+        bool active = false;   // 是否在轮转队列中
+        detail::LaneCounters counters;
+        std::atomic<unsigned long long> submitted{0};
+        std::atomic<unsigned long long> rejected{0};
+        std::atomic<unsigned long long> dropped{0};
+    };
+
+    Tenant& tenant(TenantId id) {
+        return *tenants_[id - 1];
+    }
+
+    const Tenant& tenant(TenantId id) const {
+        return *tenants_[id - 1];
+    }
+
+    void take(Tenant& t, T& task, std::int64_t* waitNs) {
+        detail::LaneItem<T>& item = t.items.front();
+        task = std::move(item.task);
+        std::int64_t wait = t.counters.onPop(item.enqueuedNs);
+        if (waitNs != nullptr) *waitNs = wait;
+        t.items.pop();
+        size_--;
+    }
+
+private:
+    std::unique_ptr<Tenant> tenants_[TENANT_MAX_COUNT];
+    std::atomic_int count_{0};
+    RingQueue<TenantId> active_;   // 有排队任务的租户（轮转顺序）
+    std::size_t size_ = 0;
+};
+
+#endif
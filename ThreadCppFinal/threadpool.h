@@ -2,7 +2,6 @@
 #define THREADPOOL_H
 
 #include<vector>
-#include<queue>
 #include<memory>
 #include<atomic>
 #include<mutex>
@@ -11,7 +10,37 @@
 #include<unordered_map>
 #include<thread>
 #include<future>
-#include<iostream>
+#include<cstdint>
+#include<algorithm>
+#include<iterator>
+#include<type_traits>
+#include<exception>
+#include<optional>
+#include<stdexcept>
+#include<chrono>
+
+#include"workstealingqueue.h"
+#include"mpmcqueue.h"
+#include"idleregistry.h"
+#include"taskfunction.h"
+#include"slabpool.h"
+#include"taskfuture.h"
+#include"cotask.h"
+#include"ioreactor.h"
+#include"ringqueue.h"
+#include"lanequeue.h"
+#include"topology.h"
+#include"taskarena.h"
+#include"poolstats.h"
+#include"poollog.h"
+#include"tasktrace.h"
+#include"timerwheel.h"
+#include"cancellation.h"
+#include"tenantqueue.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#include<immintrin.h>
+#endif
 
 // 任务队列最大阈值
 const int TASK_MAX_THRESHHOLD = INT32_MAX;
@@ -20,10 +49,183 @@ const int THREAD_MAX_THRESHHOLD = 10;
 // 线程最大空闲时间（秒，CACHED模式回收线程用）
 const int THREAD_MAX_IDLE_TIME = 60;
 
+// CACHED模式的弹性伸缩策略（由独立的控制器线程执行）
+struct ElasticPolicy {
+    // 积压任务按最近吞吐估算的排队时间超过该值时扩容（越大越不容易扩容）
+    std::chrono::microseconds growWait{1000};
+    // 有积压时控制器复查的间隔
+    std::chrono::microseconds sampleInterval{1000};
+    // 多余线程在整个观察窗口内都空闲才回收（窗口长度）
+    std::chrono::seconds shrinkIdle{THREAD_MAX_IDLE_TIME};
+    // 每次最多新增的线程数
+    int maxGrowStep = 4;
+};
+
 // 线程池工作模式枚举
 enum class PoolMode {
     MODE_FIXED,   // 固定数量线程
     MODE_CACHED,  // 动态数量线程
+    MODE_WORK_STEALING,  // 固定数量线程 + 每线程本地双端队列，空闲时随机窃取
+};
+
+// 工作窃取模式下，从全局注入队列一次搬运到本地队列的最大任务数
+const int WORK_STEALING_BATCH_SIZE = 32;
+
+// 任务队列后端枚举
+enum class QueueMode {
+    QUEUE_LOCKED,     // 按优先级分通道的环形队列 + 互斥锁（默认）
+    QUEUE_LOCK_FREE,  // 按优先级分通道的有界无锁环形队列（Vyukov MPMC）
+};
+
+// 任务队列满时submitTask的处理策略（setOverflowPolicy）
+// trySubmit/submitFor不受策略影响：前者从不等待，后者最多等待给定时间，失败时返回空
+enum class OverflowPolicy {
+    OVERFLOW_BLOCK,        // 等待空位，超过等待时限仍满则提交失败（默认，时限默认1秒）
+    OVERFLOW_REJECT,       // 立即提交失败
+    OVERFLOW_CALLER_RUNS,  // 在提交线程上直接执行（提交方自然降速）
+    OVERFLOW_DROP_OLDEST,  // 丢弃最早入队的任务（其Future得到broken_promise）腾出位置
+};
+
+// 提交结果
+enum class SubmitStatus {
+    SUBMIT_OK,          // 已入队
+    SUBMIT_QUEUE_FULL,  // 队列满（未等待）
+    SUBMIT_TIMEOUT,     // 等待空位超时
+    SUBMIT_SHUTDOWN,    // 线程池已调用shutdown，不再接受外部提交
+};
+
+// shutdown的方式
+enum class ShutdownMode {
+    SHUTDOWN_DRAIN,  // 已入队的任务全部执行完后线程退出（析构函数使用）
+    SHUTDOWN_ABORT,  // 尚未开始的用户任务直接丢弃（其Future得到broken_promise），执行中的任务照常完成；
+                     // 线程池内部任务（并行分块、任务组/strand驱动、续延等）仍会执行，等待方不会卡住
+};
+
+// 提交失败的任务，其Future在get()时抛出该异常
+class TaskRejectedError : public std::runtime_error {
+public:
+    explicit TaskRejectedError(SubmitStatus status)
+        : std::runtime_error(status == SubmitStatus::SUBMIT_TIMEOUT ? "等待任务队列空位超时"
+            : status == SubmitStatus::SUBMIT_SHUTDOWN ? "线程池已关闭" : "任务队列已满")
+        , status_(status)
+    {}
+
+    SubmitStatus status() const noexcept {
+        return status_;
+    }
+
+private:
+    SubmitStatus status_;
+};
+
+// submitBefore的任务到截止时间仍未开始执行而被跳过，其Future在get()时抛出该异常
+class DeadlineExpiredError : public std::runtime_error {
+public:
+    DeadlineExpiredError()
+        : std::runtime_error("任务在截止时间之前未能开始执行")
+    {}
+};
+
+// 任务组状态表超过该大小时清理已没有排队任务的组（之后按表大小的两倍）
+const std::size_t GROUP_SWEEP_MIN = 64;
+
+// OVERFLOW_BLOCK策略的默认等待时限
+const std::chrono::milliseconds SUBMIT_BLOCK_DEFAULT_TIMEOUT{1000};
+// 工作线程等待空位时，每次检查之间最长的休眠时间（其余时间帮忙执行排队任务）
+const std::chrono::microseconds SUBMIT_HELP_WAIT_SLICE{100};
+
+// 工作线程的CPU绑定方式
+// 启用绑定后线程按NUMA节点分组：每个节点有自己的注入队列（submitTaskOn/submitTaskNear），
+// 取任务和窃取时先找本节点，再跨节点
+enum class AffinityMode {
+    AFFINITY_NONE,  // 不绑定（默认）
+    AFFINITY_CORE,  // 每个线程绑定一个CPU核
+    AFFINITY_NODE,  // 每个线程绑定到所在节点的全部CPU（节点内由系统调度）
+};
+
+// 无锁队列在未设置容量阈值时的默认容量
+const int LOCK_FREE_QUE_DEFAULT_CAPACITY = 1 << 16;
+
+// 空闲线程休眠前的自适应自旋次数范围（自旋拿到任务则加倍，否则减半）
+const int IDLE_SPIN_MIN = 64;
+const int IDLE_SPIN_MAX = 4096;
+// 自旋中前若干次只执行pause，之后改为yield让出CPU
+const int SPIN_PAUSE_COUNT = 64;
+// 挂有I/O反应器时，忙碌的工作线程每执行这么多个任务顺带收割一次I/O完成
+const int IO_POLL_INTERVAL = 64;
+
+// setPrefault时每个工作线程启动时预先写入的栈空间（字节）
+const std::size_t PREFAULT_STACK_SIZE = 64 * 1024;
+
+// 自旋等待时的CPU提示（降低功耗并让出超线程资源）
+inline void cpuRelax() {
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+    _mm_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
+
+// 分叉-合并计数器：统计尚未完成的子任务，全部完成后唤醒等待方
+// 等待方必须经由wait()/waitFor()在锁内确认完成后才能销毁计数器，
+// 这样最后一个done()的通知不会访问已销毁的对象
+class JoinCounter {
+public:
+    explicit JoinCounter(size_t pending = 1)
+        : pending_(pending)
+        , finished_(false)
+    {}
+
+    JoinCounter(const JoinCounter&) = delete;
+    JoinCounter& operator=(const JoinCounter&) = delete;
+
+    // 新增n个待完成的子任务
+    void add(size_t n = 1) {
+        pending_.fetch_add(n, std::memory_order_relaxed);
+    }
+
+    // 撤销一个尚未开始的子任务（调用方仍持有至少一个计数，不会归零）
+    void undo() {
+        pending_.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    // 完成一个子任务，最后一个完成者负责通知
+    void done() {
+        if (pending_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            std::lock_guard<std::mutex> lock(mtx_);
+            finished_ = true;
+            cond_.notify_all();
+        }
+    }
+
+    // 重新设置待完成数以便复用（只能在上一轮已wait返回、没有线程等待时调用）
+    void reset(size_t pending) {
+        pending_.store(pending, std::memory_order_relaxed);
+        std::lock_guard<std::mutex> lock(mtx_);
+        finished_ = false;
+    }
+
+    // 无锁快速判断（仅作提示，销毁前仍需调用wait）
+    bool finished() const {
+        return pending_.load(std::memory_order_acquire) == 0;
+    }
+
+    void wait() {
+        std::unique_lock<std::mutex> lock(mtx_);
+        cond_.wait(lock, [&]()->bool { return finished_; });
+    }
+
+    template<typename Rep, typename Period>
+    bool waitFor(const std::chrono::duration<Rep, Period>& timeout) {
+        std::unique_lock<std::mutex> lock(mtx_);
+        return cond_.wait_for(lock, timeout, [&]()->bool { return finished_; });
+    }
+
+private:
+    std::atomic<size_t> pending_;
+    std::mutex mtx_;
+    std::condition_variable cond_;
+    bool finished_;
 };
 
 // 线程类封装
@@ -32,18 +234,20 @@ public:
     // 线程函数对象类型（接受线程ID参数）
     using ThreadFunc = std::function<void(int)>;
 
-    // 构造函数（初始化线程函数和生成唯一线程ID）
-    Thread(ThreadFunc func)
-        : func_(func)
-        , threadId_(generateId_++)  // 使用静态原子变量生成唯一ID
+    // 构造函数（线程ID由所属线程池分配，在线程池内唯一）
+    Thread(ThreadFunc func, int threadId)
+        : func_(std::move(func))
+        , threadId_(threadId)
     {}
 
-    ~Thread() = default;
+    // 析构时join（与std::jthread相同）：线程退出后由线程池在其他线程上析构
+    ~Thread() {
+        if (thread_.joinable()) thread_.join();
+    }
 
-    // 启动线程（立即分离运行）
+    // 启动线程（可join，不再分离）
     void start() {
-        std::thread t(func_, threadId_);  // 创建线程并传入线程ID
-        t.detach();  // 分离线程使其自主运行
+        thread_ = std::thread(func_, threadId_);  // 创建线程并传入线程ID
     }
 
     // 获取线程ID
@@ -53,12 +257,65 @@ public:
 
 private:
     ThreadFunc func_;
-    static int generateId_;  // 静态线程ID生成器
     int threadId_;           // 当前线程ID
+    std::thread thread_;
+};
+
+class ThreadPool;
+
+// 定时任务的句柄（只含线程池指针和定时器编号，可拷贝）
+class TimerHandle {
+public:
+    TimerHandle() noexcept = default;
+
+    // 取消定时器（O(1)）：尚未触发的一次性任务不再执行，其Future得到broken_promise；
+    // 周期任务不再触发（正在执行的这一次照常完成）。已触发、已取消或句柄无效时返回false
+    // 线程池销毁后不可再调用
+    bool cancel() const;
+
+    bool valid() const noexcept {
+        return pool_ != nullptr && id_ != 0;
+    }
+
+    TimerId id() const noexcept {
+        return id_;
+    }
+
+private:
+    friend class ThreadPool;
+
+    TimerHandle(ThreadPool* pool, TimerId id) noexcept
+        : pool_(pool)
+        , id_(id)
+    {}
+
+    ThreadPool* pool_ = nullptr;
+    TimerId id_ = 0;
 };
 
-// 静态成员初始化（线程ID从0开始）
-int Thread::generateId_ = 0;
+// submitAfter/submitAt的返回值：Future加上取消定时器的句柄（不需要取消时可直接移动给Future）
+template<typename T>
+class ScheduledFuture : public Future<T> {
+public:
+    ScheduledFuture() noexcept = default;
+
+    ScheduledFuture(Future<T>&& future, TimerHandle timer) noexcept
+        : Future<T>(std::move(future))
+        , timer_(timer)
+    {}
+
+    // 同TimerHandle::cancel
+    bool cancel() const {
+        return timer_.cancel();
+    }
+
+    TimerHandle timer() const noexcept {
+        return timer_;
+    }
+
+private:
+    TimerHandle timer_;
+};
 
 // 线程池核心类
 class ThreadPool {
@@ -72,17 +329,74 @@ public:
         , taskQueMaxThreshHold_(TASK_MAX_THRESHHOLD)  // 任务队列最大容量
         , threadSizeThreshHold_(THREAD_MAX_THRESHHOLD)// 最大线程数阈值
         , poolMode_(PoolMode::MODE_FIXED)  // 默认固定模式
+        , queueMode_(QueueMode::QUEUE_LOCKED)  // 默认加锁队列
+        , affinityMode_(AffinityMode::AFFINITY_NONE)  // 默认不绑定CPU
+        , topologySet_(false)
         , isPoolRunning_(false)        // 运行状态标记
     {}
 
+private:
+    struct DefaultPoolTag {};
+
+    explicit ThreadPool(DefaultPoolTag)
+        : ThreadPool()
+    {
+        setLazyStart(true);
+        int n = static_cast<int>(std::thread::hardware_concurrency());
+        start(n > 0 ? n : 1);
+    }
+
+public:
+
     // 析构函数（安全关闭线程池）
+    // 等同于shutdown(SHUTDOWN_DRAIN)并一直等待所有线程退出
     ~ThreadPool() {
+        shutdown(ShutdownMode::SHUTDOWN_DRAIN, std::chrono::milliseconds::max());
+    }
+
+    // 关闭线程池：之后其他线程的提交直接失败（SUBMIT_SHUTDOWN），阻塞中的提交者也立即失败；
+    // 本线程池工作线程内的提交仍然接受（执行中的任务派生的子任务照常完成）
+    // DRAIN执行完已入队的任务，ABORT丢弃尚未开始的用户任务（含租户队列，内部任务仍执行），未触发的定时任务都被丢弃
+    // 最多等待timeout：所有工作线程退出并被join时返回true；超时返回false（执行中的任务不会被打断），
+    // 之后可以再次调用（例如改用ABORT）继续等待；不要在本线程池的工作线程内调用
+    bool shutdown(ShutdownMode mode = ShutdownMode::SHUTDOWN_DRAIN,
+        std::chrono::milliseconds timeout = std::chrono::milliseconds::max())
+    {
+        stopTimer();       // 先丢弃未触发的定时任务，之后不再有定时任务入队
+        stopController();  // 再停控制器，之后线程数不再变化
+        shuttingDown_.store(true, std::memory_order_release);
+        std::vector<Task> aborted;  // 在锁外销毁
+        if (mode == ShutdownMode::SHUTDOWN_ABORT) {
+            aborting_.store(true, std::memory_order_release);  // 工作线程取到的任务不再执行
+            std::lock_guard<std::mutex> lock(tenantMtx_);
+            Task task;
+            while (tenants_.pop(task)) aborted.push_back(std::move(task));
+        }
+        {
+            std::lock_guard<std::mutex> lock(tenantMtx_);
+            tenantNotFull_.notify_all();
+        }
+        dropped_.fetch_add(aborted.size(), std::memory_order_relaxed);
+        aborted.clear();
+
         isPoolRunning_ = false;
-        std::unique_lock<std::mutex> lock(taskQueMtx_);
-        notEmpty_.notify_all();  // 唤醒所有等待线程
-        exitCond_.wait(lock, [&]()->bool { 
-            return threads_.size() == 0; // 等待所有线程退出
-        });
+        idle_.notifyAll();  // 唤醒所有休眠线程
+        wakeIoPoller();     // 以及阻塞在I/O反应器上的线程
+        std::vector<std::unique_ptr<Thread>> exited;  // 在锁外析构（join）
+        bool done = true;
+        {
+            std::unique_lock<std::mutex> lock(taskQueMtx_);
+            // 延迟启动：之后不再创建线程；还有任务却一个线程都没有时补一个把它们执行（或丢弃）掉
+            int pending = lazyPending_.exchange(0, std::memory_order_acq_rel);
+            if (pending > 0 && threads_.empty() && hasPendingWork()) spawnWorker(initThreadSize_ - pending);
+            notFull_.notify_all();  // 阻塞中的提交者
+            auto allExited = [&]()->bool { return threads_.size() == 0; };
+            if (timeout == std::chrono::milliseconds::max()) exitCond_.wait(lock, allExited);
+            else done = exitCond_.wait_for(lock, timeout, allExited);
+            exited.swap(exitedThreads_);
+        }
+        if (!done) POOL_LOG_WARN("关闭线程池超时，仍有线程在执行任务");
+        return done;
     }
 
     // 设置线程池模式（运行中不可修改）
@@ -91,17 +405,57 @@ public:
         poolMode_ = mode;
     }
 
+    // 设置任务队列后端（运行中不可修改）
+    // QUEUE_LOCK_FREE的容量由setTaskQueMaxThreshHold决定（向上取整为2的幂）
+    void setQueueMode(QueueMode mode) {
+        if (checkRunningState()) return;
+        queueMode_ = mode;
+    }
+
     // 设置初始线程数（运行前设置）
     void setInitThreadSize(int size) {
         initThreadSize_ = size;
     }
 
+    // 延迟启动（运行中不可修改）：start()不创建线程，提交任务时若没有可用的线程才创建一个，
+    // 直到达到初始线程数。只提交少量任务的短命程序不必为每个核心创建线程
+    void setLazyStart(bool enable) {
+        if (checkRunningState()) return;
+        lazyStart_ = enable;
+    }
+
+    // 预热（运行中不可修改）：工作线程启动时先逐页写入一段栈空间和arena的第一个块，
+    // 缺页集中在线程启动时发生（绑定CPU时落在本地节点），而不是落在最初的几个任务上
+    void setPrefault(bool enable) {
+        if (checkRunningState()) return;
+        prefault_ = enable;
+    }
+
+    // 进程共享的默认线程池：首次调用时以延迟启动方式启动（线程数为CPU核心数），进程退出时析构
+    // 适合命令行工具等不想自己管理线程池的场合；不要对它调用shutdown或修改配置，
+    // 也不要在其他静态对象的析构函数中向它提交任务
+    static ThreadPool& defaultPool() {
+        static ThreadPool pool(DefaultPoolTag{});
+        return pool;
+    }
+
     // 设置任务队列最大容量（运行中不可修改）
     void setTaskQueMaxThreshHold(int threshHold) {
         if (checkRunningState()) return;
         taskQueMaxThreshHold_ = threshHold;
     }
 
+    // 设置队列满时submitTask的处理策略（运行中不可修改）
+    // blockTimeout只对OVERFLOW_BLOCK有效，传入std::chrono::milliseconds::max()表示一直等待；
+    // 在本线程池的工作线程上等待时会帮忙执行排队中的任务，腾出空位，不会因所有线程都在提交而卡死
+    void setOverflowPolicy(OverflowPolicy policy,
+        std::chrono::milliseconds blockTimeout = SUBMIT_BLOCK_DEFAULT_TIMEOUT)
+    {
+        if (checkRunningState()) return;
+        overflowPolicy_ = policy;
+        blockTimeout_ = blockTimeout;
+    }
+
     // 设置线程数阈值（仅CACHED模式有效）
     void setThreadSizeThreshHold(int threshHold) {
         if (checkRunningState()) return;
@@ -109,203 +463,2676 @@ public:
             threadSizeThreshHold_ = threshHold;
     }
 
-    // 提交任务接口（可变参数模板+完美转发）
+    // 设置弹性伸缩策略（仅CACHED模式有效，运行中不可修改）
+    void setElasticPolicy(const ElasticPolicy& policy) {
+        if (checkRunningState()) return;
+        elastic_ = policy;
+    }
+
+    // 设置工作线程的CPU绑定方式（运行中不可修改）
+    // 线程按节点轮流分配（线程i位于节点 i % 节点数），节点内依次使用各个CPU
+    void setAffinityMode(AffinityMode mode) {
+        if (checkRunningState()) return;
+        affinityMode_ = mode;
+    }
+
+    // 指定CPU拓扑（运行中不可修改），不设置时在start()中自动探测
+    // 可用于只使用部分CPU，或在容器内覆盖探测结果
+    void setCpuTopology(const CpuTopology& topology) {
+        if (checkRunningState()) return;
+        topology_ = topology;
+        topologySet_ = true;
+    }
+
+#if defined(THREADPOOL_HAS_IO_REACTOR)
+    // 挂接I/O反应器（运行中不可修改）：工作线程休眠前收割I/O完成，其中一个空闲线程阻塞在反应器上，
+    // 完成回调、Future续延和协程恢复都作为任务投递到本线程池
+    // 反应器的生命周期须长于线程池，且不要再由其他线程调用它的poll()
+    void setIoReactor(IoReactor* reactor) {
+        if (checkRunningState()) return;
+        reactor_ = reactor;
+        if (reactor_ != nullptr) reactor_->setExecutor(executor());
+    }
+#endif
+
+    // 参与调度的NUMA节点数（未启用CPU绑定时为1）
+    int numaNodeCount() const {
+        return nodeQues_.empty() ? 1 : static_cast<int>(nodeQues_.size());
+    }
+
+    // 当前工作线程所在节点（线程池内编号），非本线程池线程返回-1
+    int currentNumaNode() const {
+        Worker* self = currentWorker();
+        if (self == nullptr || self->pool != this) return -1;
+        return self->node;
+    }
+
+    // 当前线程在本线程池中的槽位下标（与submitTo的worker参数对应），非本线程池线程返回-1
+    int currentWorkerIndex() const {
+        Worker* self = currentWorker();
+        if (self == nullptr || self->pool != this) return -1;
+        return self->index;
+    }
+
+    // 提交任务接口（可变参数模板+完美转发），按普通优先级排队
+    // 返回轻量级Future（可隐式转换为std::future兼容旧代码）
     template<typename Func, typename... Args>
-    auto submitTask(Func&& func, Args&&... args) -> std::future<decltype(func(args...))> {
+    auto submitTask(Func&& func, Args&&... args) -> Future<decltype(func(args...))> {
+        return submitTask(TaskPriority::PRIORITY_NORMAL,
+            std::forward<Func>(func), std::forward<Args>(args)...);
+    }
+
+    // 按指定优先级提交任务：高优先级通道先出队，低优先级通道连续被跳过
+    // LANE_AGING_LIMIT次后必定被服务一次，不会饿死
+    // 工作窃取模式下工作线程内部提交的高/普通优先级任务仍进入本地队列（下一个就执行），
+    // 低优先级任务进入全局低优先级通道，不挤占本地队列
+    template<typename Func, typename... Args>
+    auto submitTask(TaskPriority priority, Func&& func, Args&&... args) -> Future<decltype(func(args...))> {
         // 推导任务返回类型
         using RType = decltype(func(args...));
-        
-        // 封装任务到packaged_task（支持获取future）
-        auto task = std::make_shared<std::packaged_task<RType()>>(
-            std::bind(std::forward<Func>(func), std::forward<Args>(args)...));
-        
-        // 获取future对象用于异步获取结果
-        std::future<RType> result = task->get_future();
-
-        // 加锁操作任务队列
-        std::unique_lock<std::mutex> lock(taskQueMtx_);
 
-        // 任务队列满时等待1秒（带超时的条件变量等待）
-        if (!notFull_.wait_for(lock, std::chrono::seconds(1),
-            [&]()->bool { return taskQue_.size() < (size_t)taskQueMaxThreshHold_; })) 
-        {
-            // 超时后返回空任务future
-            std::cerr << "任务队列已满，提交失败" << std::endl;
-            auto task = std::make_shared<std::packaged_task<RType()>>(
-                []()->RType { return RType(); });
-            (*task)();
-            return task->get_future();
+        Future<RType> result;
+        Task task = packTask(result, nullptr, std::forward<Func>(func), std::forward<Args>(args)...);
+        return submitTaskWith(std::move(task), std::move(result), priority);
+    }
+
+    // 带标签提交：开启跟踪（startTrace）时标签作为任务名出现在导出的跟踪数据中，
+    // 未开启跟踪时与submitTask相同
+    template<typename Func, typename... Args>
+    auto submitTask(TaskLabel label, Func&& func, Args&&... args) -> Future<decltype(func(args...))> {
+        return submitTask(label, TaskPriority::PRIORITY_NORMAL,
+            std::forward<Func>(func), std::forward<Args>(args)...);
+    }
+
+    template<typename Func, typename... Args>
+    auto submitTask(TaskLabel label, TaskPriority priority, Func&& func, Args&&... args)
+        -> Future<decltype(func(args...))>
+    {
+        using RType = decltype(func(args...));
+
+        Future<RType> result;
+        Task task = packTask(result, label.name, std::forward<Func>(func), std::forward<Args>(args)...);
+        return submitTaskWith(std::move(task), std::move(result), priority);
+    }
+
+    // 非阻塞提交：队列满时立即返回空（任务不执行），不受OverflowPolicy影响
+    template<typename Func, typename... Args>
+    auto trySubmit(Func&& func, Args&&... args) -> std::optional<Future<decltype(func(args...))>> {
+        return trySubmit(TaskPriority::PRIORITY_NORMAL, std::forward<Func>(func), std::forward<Args>(args)...);
+    }
+
+    template<typename Func, typename... Args>
+    auto trySubmit(TaskPriority priority, Func&& func, Args&&... args)
+        -> std::optional<Future<decltype(func(args...))>>
+    {
+        return submitFor(std::chrono::nanoseconds::zero(), priority,
+            std::forward<Func>(func), std::forward<Args>(args)...);
+    }
+
+    // 限时提交：队列满时最多等待timeout，仍满则返回空（任务不执行），不受OverflowPolicy影响
+    template<typename Rep, typename Period, typename Func, typename... Args>
+    auto submitFor(const std::chrono::duration<Rep, Period>& timeout, Func&& func, Args&&... args)
+        -> std::optional<Future<decltype(func(args...))>>
+    {
+        return submitFor(timeout, TaskPriority::PRIORITY_NORMAL, std::forward<Func>(func), std::forward<Args>(args)...);
+    }
+
+    template<typename Rep, typename Period, typename Func, typename... Args>
+    auto submitFor(const std::chrono::duration<Rep, Period>& timeout, TaskPriority priority, Func&& func, Args&&... args)
+        -> std::optional<Future<decltype(func(args...))>>
+    {
+        using RType = decltype(func(args...));
+
+        Future<RType> result;
+        Task task = packTask(result, nullptr, std::forward<Func>(func), std::forward<Args>(args)...);
+        EnqueueOptions opts;
+        opts.wait = std::chrono::duration_cast<std::chrono::nanoseconds>(timeout);
+        opts.droppable = true;
+        if (enqueueTask(task, priority, opts) != SubmitStatus::SUBMIT_OK) {
+            rejected_.fetch_add(1, std::memory_order_relaxed);
+            return std::nullopt;
         }
+        return std::optional<Future<RType>>(std::move(result));
+    }
 
-        // 任务入队（封装为void()类型）
-        taskQue_.emplace([task]() {
-            (*task)();  // 执行打包的任务
-        });
-        taskSize_++;  // 原子计数增加
+    // 延迟提交：delay之后把任务放入任务队列（按OverflowPolicy入队），返回可取消的Future
+    // 定时器由一个独立的定时器线程推进（分层时间轮，精度TIMER_TICK，到期后不早于设定时间入队），
+    // 插入和取消都是O(1)，大量挂起的定时器只占内存，不增加唤醒次数；第一次使用时才创建该线程
+    template<typename Rep, typename Period, typename Func, typename... Args>
+    auto submitAfter(const std::chrono::duration<Rep, Period>& delay, Func&& func, Args&&... args)
+        -> ScheduledFuture<decltype(func(args...))>
+    {
+        return submitAfter(delay, TaskPriority::PRIORITY_NORMAL, std::forward<Func>(func), std::forward<Args>(args)...);
+    }
+
+    template<typename Rep, typename Period, typename Func, typename... Args>
+    auto submitAfter(const std::chrono::duration<Rep, Period>& delay, TaskPriority priority, Func&& func, Args&&... args)
+        -> ScheduledFuture<decltype(func(args...))>
+    {
+        return submitAt(std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(delay),
+            priority, std::forward<Func>(func), std::forward<Args>(args)...);
+    }
+
+    // 定时提交：到when时把任务放入任务队列（非steady_clock的时间点按提交时的差值换算）
+    template<typename Clock, typename Duration, typename Func, typename... Args>
+    auto submitAt(const std::chrono::time_point<Clock, Duration>& when, Func&& func, Args&&... args)
+        -> ScheduledFuture<decltype(func(args...))>
+    {
+        return submitAt(when, TaskPriority::PRIORITY_NORMAL, std::forward<Func>(func), std::forward<Args>(args)...);
+    }
 
-        // 通知消费者有任务可执行
-        notEmpty_.notify_all();
+    template<typename Clock, typename Duration, typename Func, typename... Args>
+    auto submitAt(const std::chrono::time_point<Clock, Duration>& when, TaskPriority priority, Func&& func, Args&&... args)
+        -> ScheduledFuture<decltype(func(args...))>
+    {
+        using RType = decltype(func(args...));
+
+        Future<RType> result;
+        Task task = packTask(result, nullptr, std::forward<Func>(func), std::forward<Args>(args)...);
+        TimerId id = addTimer(toSteady(when), std::chrono::nanoseconds::zero(), priority, task);
+        return ScheduledFuture<RType>(std::move(result), TimerHandle(this, id));
+    }
+
+    // 周期提交：每隔period把fn(args...)放入任务队列一次（第一次在period之后），直到取消或线程池销毁
+    // 固定频率：上一次执行结束后才安排下一次，执行时间超过周期时错过的次数直接跳过，不会重叠执行
+    // fn抛出的异常只记录日志，不影响之后的执行
+    template<typename Rep, typename Period, typename Func, typename... Args>
+    TimerHandle submitEvery(const std::chrono::duration<Rep, Period>& period, Func&& func, Args&&... args) {
+        return submitEvery(period, TaskPriority::PRIORITY_NORMAL, std::forward<Func>(func), std::forward<Args>(args)...);
+    }
+
+    template<typename Rep, typename Period, typename Func, typename... Args>
+    TimerHandle submitEvery(const std::chrono::duration<Rep, Period>& period, TaskPriority priority, Func&& func, Args&&... args) {
+        std::chrono::nanoseconds interval = std::max<std::chrono::nanoseconds>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(period), TIMER_TICK);
+        Task task([fn = std::bind(std::forward<Func>(func), std::forward<Args>(args)...)]() mutable {
+            fn();
+        });
+        TimerId id = addTimer(std::chrono::steady_clock::now() + interval, interval, priority, task);
+        return TimerHandle(this, id);
+    }
 
-        // CACHED模式动态创建线程逻辑：
-        if (poolMode_ == PoolMode::MODE_CACHED 
-            && taskSize_ > idleThreadSize_  // 任务数超过空闲线程
-            && curThreadSize_ < threadSizeThreshHold_) // 未达线程数上限
+    // 取消定时器（同TimerHandle::cancel）
+    bool cancelTimer(TimerId id) {
+        Task fn;  // 在锁外销毁
         {
-            std::cout << ">>> 创建新线程..." << std::endl;
-            // 创建新线程并启动
-            auto ptr = std::make_unique<Thread>(
-                std::bind(&ThreadPool::threadFunc, this, std::placeholders::_1));
-            int threadId = ptr->getId();
-            threads_.emplace(threadId, std::move(ptr));
-            threads_[threadId]->start();  // 启动线程
-            curThreadSize_++;    // 当前线程数增加
-            idleThreadSize_++;  // 空闲数增加（新线程会立即取任务）
+            std::lock_guard<std::mutex> lock(timerMtx_);
+            TimerNode* node = timers_.find(id);
+            if (node == nullptr || node->cancelled) return false;
+            if (node->state == TimerNode::TIMER_PENDING) {
+                fn = timers_.release(node);
+            } else {
+                node->cancelled = true;  // 周期任务正在执行，结束后由执行方释放
+            }
         }
+        return true;
+    }
 
-        return result;  // 返回future给调用者
+    // 带截止时间提交：到deadline仍未开始执行的任务被跳过（不执行），其Future得到DeadlineExpiredError
+    // 适合过期即无用的任务（例如调用方已经超时的请求）：积压时出队后只做一次时间比较就丢弃
+    template<typename Clock, typename Duration, typename Func, typename... Args>
+    auto submitBefore(const std::chrono::time_point<Clock, Duration>& deadline, Func&& func, Args&&... args)
+        -> Future<decltype(func(args...))>
+    {
+        return submitBefore(deadline, TaskPriority::PRIORITY_NORMAL, std::forward<Func>(func), std::forward<Args>(args)...);
     }
 
-    // 启动线程池（可指定初始线程数）
-    void start(int initThreadSize = int(std::thread::hardware_concurrency())) {
-        isPoolRunning_ = true;  // 设置运行标志
-        initThreadSize_ = initThreadSize;  // 可覆盖初始线程数
-        curThreadSize_ = initThreadSize;   // 设置当前线程数
+    template<typename Clock, typename Duration, typename Func, typename... Args>
+    auto submitBefore(const std::chrono::time_point<Clock, Duration>& deadline, TaskPriority priority, Func&& func, Args&&... args)
+        -> Future<decltype(func(args...))>
+    {
+        using RType = decltype(func(args...));
 
-        // 创建指定数量的线程对象
-        for (int i = 0; i < initThreadSize_; i++) {
-            // 绑定线程函数threadFunc，传入线程ID
-            auto ptr = std::make_unique<Thread>(
-                std::bind(&ThreadPool::threadFunc, this, std::placeholders::_1));
-            int threadId = ptr->getId();
-            threads_.emplace(threadId, std::move(ptr));  // 存入线程表
-        }
-        
-        // 启动所有线程
-        for (int i = 0; i < initThreadSize_; i++) {
-            threads_[i]->start();  // 启动线程（detach运行）
-            idleThreadSize_++;     // 空闲数递增
-        }
+        std::chrono::steady_clock::time_point due = toSteady(deadline);
+        Future<RType> result;
+        Task task = packTaskUnless(result, [this, due]() {
+            if (std::chrono::steady_clock::now() <= due) return std::exception_ptr();
+            expired_.fetch_add(1, std::memory_order_relaxed);
+            return std::make_exception_ptr(DeadlineExpiredError());
+        }, std::forward<Func>(func), std::forward<Args>(args)...);
+        return submitTaskWith(std::move(task), std::move(result), priority);
     }
 
-    // 禁止拷贝构造和赋值
-    ThreadPool(const ThreadPool&) = delete;
-    ThreadPool& operator=(const ThreadPool&) = delete;
+    // 可取消提交：出队时令牌已取消的任务不执行，其Future得到TaskCancelledError
+    // 已开始执行的任务不会被打断，需要时由任务自己轮询令牌
+    template<typename Func, typename... Args>
+    auto submitTask(CancellationToken token, Func&& func, Args&&... args) -> Future<decltype(func(args...))> {
+        return submitTask(std::move(token), TaskPriority::PRIORITY_NORMAL,
+            std::forward<Func>(func), std::forward<Args>(args)...);
+    }
 
-private:
-    // 线程函数（所有工作线程执行此函数）
-    void threadFunc(int threadid) {
-        auto lastTime = std::chrono::high_resolution_clock().now(); // 记录最后活跃时间
-        
-        // 无限循环处理任务
-        for (;;) {
-            Task task;  // 定义任务对象
-            
-            {   // 加锁区开始
-                std::unique_lock<std::mutex> lock(taskQueMtx_);
-                std::cout << "线程ID:" << std::this_thread::get_id() 
-                          << " 尝试获取任务..." << std::endl;
-
-                // 等待任务队列非空（带退出机制）
-                while (taskQue_.size() == 0) {
-                    // 检查线程池是否关闭
-                    if (!isPoolRunning_) {
-                        threads_.erase(threadid);  // 从线程表移除
-                        std::cout << "线程ID:" << std::this_thread::get_id()
-                                  << " 退出！" << std::endl;
-                        exitCond_.notify_all();  // 通知析构函数
-                        return;  // 直接结束线程函数
-                    }
+    template<typename Func, typename... Args>
+    auto submitTask(CancellationToken token, TaskPriority priority, Func&& func, Args&&... args)
+        -> Future<decltype(func(args...))>
+    {
+        using RType = decltype(func(args...));
 
-                    // CACHED模式处理线程超时回收
-                    if (poolMode_ == PoolMode::MODE_CACHED) {
-                        // 带超时的等待（1秒）
-                        if (std::cv_status::timeout == 
-                            notEmpty_.wait_for(lock, std::chrono::seconds(1))) 
-                        {
-                            auto now = std::chrono::high_resolution_clock().now();
-                            auto dur = std::chrono::duration_cast<std::chrono::seconds>(
-                                now - lastTime);
-                            // 超时且空闲超时，且线程数大于初始值
-                            if (dur.count() >= THREAD_MAX_IDLE_TIME 
-                                && curThreadSize_ > initThreadSize_) 
-                            {
-                                threads_.erase(threadid);  // 移出线程表
-                                curThreadSize_--;    // 当前线程数减1
-                                idleThreadSize_--;  // 空闲数减1
-                                std::cout << "线程ID:" << std::this_thread::get_id()
-                                          << " 因空闲超时退出！" << std::endl;
-                                return;  // 结束线程函数
-                            }
-                        }
-                    }
-                    else {  // FIXED模式无限等待
-                        notEmpty_.wait(lock);
-                    }
-                }  // end while
+        Future<RType> result;
+        Task task = packTaskUnless(result, [this, token = std::move(token)]() {
+            return token.stop_requested() ? cancelledError() : std::exception_ptr();
+        }, std::forward<Func>(func), std::forward<Args>(args)...);
+        return submitTaskWith(std::move(task), std::move(result), priority);
+    }
+
+#if defined(__cpp_lib_jthread)
+    // std::stop_token版本（C++20）
+    template<typename Func, typename... Args>
+    auto submitTask(std::stop_token token, Func&& func, Args&&... args) -> Future<decltype(func(args...))> {
+        return submitTask(std::move(token), TaskPriority::PRIORITY_NORMAL,
+            std::forward<Func>(func), std::forward<Args>(args)...);
+    }
 
-                // 获取任务前减少空闲计数
-                idleThreadSize_--;
+    template<typename Func, typename... Args>
+    auto submitTask(std::stop_token token, TaskPriority priority, Func&& func, Args&&... args)
+        -> Future<decltype(func(args...))>
+    {
+        using RType = decltype(func(args...));
 
-                std::cout << "线程ID:" << std::this_thread::get_id() 
-                          << " 获取任务成功！" << std::endl;
+        Future<RType> result;
+        Task task = packTaskUnless(result, [this, token = std::move(token)]() {
+            return token.stop_requested() ? cancelledError() : std::exception_ptr();
+        }, std::forward<Func>(func), std::forward<Args>(args)...);
+        return submitTaskWith(std::move(task), std::move(result), priority);
+    }
+#endif
 
-                // 从队列取出任务
-                task = taskQue_.front();
-                taskQue_.pop();
-                taskSize_--;  // 原子计数减1
+    // 分组提交：之后可用cancelGroup(group)一次取消该组所有尚未开始的任务；group为0时等同于submitTask
+    template<typename Func, typename... Args>
+    auto submitToGroup(GroupId group, Func&& func, Args&&... args) -> Future<decltype(func(args...))> {
+        return submitToGroup(group, TaskPriority::PRIORITY_NORMAL,
+            std::forward<Func>(func), std::forward<Args>(args)...);
+    }
 
-                // 通知生产者可以继续提交任务
-                if (taskQue_.size() > 0) {
-                    notEmpty_.notify_all();  // 还有其他任务
-                }
+    template<typename Func, typename... Args>
+    auto submitToGroup(GroupId group, TaskPriority priority, Func&& func, Args&&... args)
+        -> Future<decltype(func(args...))>
+    {
+        using RType = decltype(func(args...));
 
-                notFull_.notify_all();  // 队列有空位
-            }  // 自动释放锁
+        if (group == 0) {
+            return submitTask(priority, std::forward<Func>(func), std::forward<Args>(args)...);
+        }
+        Future<RType> result;
+        Task task = packTaskUnless(result, [this, state = groupState(group)]() {
+            return state->stopped.load(std::memory_order_acquire) ? cancelledError() : std::exception_ptr();
+        }, std::forward<Func>(func), std::forward<Args>(args)...);
+        EnqueueOptions opts = overflowOptions(true);
+        opts.group = group;
+        return submitTaskWith(std::move(task), std::move(result), priority, opts);
+    }
 
-            // 执行任务（在锁外执行）
-            if (task != nullptr) {
-                task();  // 执行函数对象
+    // 取消一个组：该组已提交、尚未开始的任务都不再执行（Future得到TaskCancelledError），
+    // 已在执行的任务照常完成；之后再用同一编号提交的任务属于新的一轮，正常执行
+    // 全局加锁队列中的任务在这里一次遍历全部移出（立即腾出队列空位），
+    // 其他队列（无锁队列、本地队列、节点队列）中的任务在出队时跳过
+    // 返回一次遍历移出的任务数
+    size_t cancelGroup(GroupId group) {
+        std::vector<Task> removed;
+        {
+            // 移出期间一直持有groupMtx_：同一编号的新一轮提交要等移出结束才能创建新状态，
+            // 队列里按编号匹配到的都是已取消这一轮的任务
+            std::lock_guard<std::mutex> lock(groupMtx_);
+            auto it = groups_.find(group);
+            if (it == groups_.end()) return 0;
+            it->second->stopped.store(true, std::memory_order_release);
+            groups_.erase(it);
+            if (queueMode_ == QueueMode::QUEUE_LOCKED) {
+                std::lock_guard<std::mutex> queLock(taskQueMtx_);
+                taskSize_ -= static_cast<int>(taskQue_.extractGroup(group, removed));
             }
+        }
+        if (removed.empty()) return 0;
+        if (blockedProducers_.load(std::memory_order_acquire) > 0) notFull_.notify_all();
+        for (Task& task : removed) {
+            task();  // 令牌已取消：只写入TaskCancelledError，不调用任务函数
+        }
+        return removed.size();
+    }
 
-            // 执行完成后更新空闲计数和时间戳
-            idleThreadSize_++;
-            lastTime = std::chrono::high_resolution_clock().now();
-        }  // end for
+    // 登记一个租户：同一线程池内的多个服务各用一个租户，任务进入各自独立的有界队列，
+    // 按权重轮转出队（权重2的租户在都有积压时得到约两倍的吞吐），一个租户积压不会挤占其他租户
+    // maxQueued为该租户的排队上限，0表示取任务队列最大容量；已登记TENANT_MAX_COUNT个时返回0
+    TenantId addTenant(const std::string& name, unsigned weight = 1, size_t maxQueued = 0) {
+        std::lock_guard<std::mutex> lock(tenantMtx_);
+        TenantId id = tenants_.add(name, weight, maxQueued != 0 ? maxQueued : (size_t)taskQueMaxThreshHold_);
+        if (id == 0) POOL_LOG_WARN("租户数已达上限%d，登记失败", TENANT_MAX_COUNT);
+        return id;
     }
 
-    // 检查线程池是否在运行
-    bool checkRunningState() const {
-        return isPoolRunning_;
+    // 调整租户权重（之后的轮次生效）
+    void setTenantWeight(TenantId tenant, unsigned weight) {
+        std::lock_guard<std::mutex> lock(tenantMtx_);
+        if (tenants_.valid(tenant)) tenants_.setWeight(tenant, weight);
     }
 
-private:
-    // 线程列表（使用线程ID映射管理）
-    std::unordered_map<int, std::unique_ptr<Thread>> threads_;
+    // 提交到租户：租户排队已满时按OverflowPolicy处理（只影响这个租户，
+    // drop-oldest只挤掉同一租户的任务）；租户编号无效时等同于submitTask
+    // 租户任务不直接进入全局队列，而是由最多与线程数相同的"轮转任务"从各租户队列中按权重取出执行，
+    // 轮转任务是普通的池内任务，任何工作线程都可以执行或窃取它：
+    // 只有一个租户有任务时它可以用满所有线程，不会有空闲的算力
+    template<typename Func, typename... Args>
+    auto submitToTenant(TenantId tenant, Func&& func, Args&&... args) -> Future<decltype(func(args...))> {
+        using RType = decltype(func(args...));
+        if (!tenants_.valid(tenant)) {
+            return submitTask(std::forward<Func>(func), std::forward<Args>(args)...);
+        }
 
-    // 初始线程数量
-    int initThreadSize_;
-    // 线程数量上限阈值
-    int threadSizeThreshHold_;
-    // 当前线程总数（原子操作）
-    std::atomic_int curThreadSize_;
-    // 空闲线程数量（原子操作）
-    std::atomic_int idleThreadSize_;
+        Future<RType> result;
+        Task task = packTask(result, nullptr, std::forward<Func>(func), std::forward<Args>(args)...);
+        SubmitStatus status = enqueueTenant(tenant, task);
+        if (status == SubmitStatus::SUBMIT_OK) {
+            return result;
+        }
+        if (overflowPolicy_ == OverflowPolicy::OVERFLOW_CALLER_RUNS && status != SubmitStatus::SUBMIT_SHUTDOWN) {
+            callerRan_.fetch_add(1, std::memory_order_relaxed);
+            task();
+            return result;
+        }
+        task = nullptr;
+        return submitFailed<RType>(status);
+    }
 
-    // 任务队列相关
-    using Task = std::function<void()>;  // 任务类型
-    std::queue<Task> taskQue_;          // 任务队列
-    std::atomic_int taskSize_;          // 当前任务数
-    int taskQueMaxThreshHold_;          // 任务队列最大容量
+    // 租户的排队深度、吞吐和排队时间统计（编号无效时返回空的统计）
+    TenantStats tenantStats(TenantId tenant) const {
+        return tenants_.stats(tenant);
+    }
 
-    // 同步机制
-    std::mutex taskQueMtx_;              // 任务队列互斥锁
-    std::condition_variable notFull_;    // 队列未满条件变量
-    std::condition_variable notEmpty_;   // 队列非空条件变量
-    std::condition_variable exitCond_;   // 线程退出通知条件变量
+    // 提交到指定NUMA节点（线程池内编号）：任务进入该节点的注入队列，
+    // 优先由该节点的线程执行，节点线程都忙时其他节点的线程也会来取（不会饿死）
+    // 未启用CPU绑定、只有一个节点或编号无效时等同于submitTask
+    // 唤醒不区分节点，被唤醒的其他节点线程找不到本地任务时会跨节点取走它
+    template<typename Func, typename... Args>
+    auto submitTaskOn(int node, Func&& func, Args&&... args) -> Future<decltype(func(args...))> {
+        using RType = decltype(func(args...));
+        if (node < 0 || node >= static_cast<int>(nodeQues_.size())) {
+            return submitTask(std::forward<Func>(func), std::forward<Args>(args)...);
+        }
 
-    // 运行模式
-    PoolMode poolMode_;
-    // 线程池运行状态（原子标记）
-    std::atomic_bool isPoolRunning_;
-};
+        Future<RType> result;
+        Task task = packTask(result, nullptr, std::forward<Func>(func), std::forward<Args>(args)...);
+
+        // 工作窃取模式下，同节点工作线程提交的任务直接进入本地队列
+        Worker* self = currentWorker();
+        if (poolMode_ == PoolMode::MODE_WORK_STEALING && self != nullptr
+            && self->pool == this && self->node == node) {
+            self->localQue.push(newTaskNode(std::move(task)));
+            countSubmitted(1);
+            wakeWorker();
+            return result;
+        }
+
+        NodeQueue& nq = *nodeQues_[node];
+        {
+            std::lock_guard<std::mutex> lock(nq.mtx);
+            if (nq.que.size() < (size_t)taskQueMaxThreshHold_ && !rejectingSubmit()) {
+                nq.que.emplace(detail::LaneItem<Task>{ std::move(task), detail::laneNowNs() });
+                nq.size.fetch_add(1, std::memory_order_relaxed);
+                nodeTaskSize_.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+        // 节点队列已满（或已关闭）：退回全局队列（沿用其阻塞等待与失败语义）
+        if (task != nullptr) {
+            return submitTaskWith(std::move(task), std::move(result), TaskPriority::PRIORITY_NORMAL);
+        }
+        countSubmitted(1);
+        wakeWorker();
+        requestGrowth();
+        return result;
+    }
+
+    // 提交到addr所在内存页的NUMA节点（页面需已分配，查不到时等同于submitTask）
+    template<typename Func, typename... Args>
+    auto submitTaskNear(const void* addr, Func&& func, Args&&... args) -> Future<decltype(func(args...))> {
+        int node = nodeQues_.empty() ? -1 : topology_.indexOfNode(memoryNodeOf(addr));
+        return submitTaskOn(node, std::forward<Func>(func), std::forward<Args>(args)...);
+    }
+
+    // 提交到指定工作线程（槽位下标，0 <= worker < 槽位数）：任务进入该线程的专属队列，
+    // 只由占用这个槽位的线程执行，不会被其他线程取走或窃取；同一槽位的任务按提交顺序逐个执行，
+    // 因此按槽位拆分的状态（每个分片固定交给一个槽位）无需加锁，数据留在同一个核心的缓存里
+    // 工作线程取任务时先看专属队列；专属队列已满时提交失败（不退回全局队列，以免破坏串行）
+    // 槽位上还没有线程（延迟启动尚未创建、CACHED模式已回收）时先为它创建线程
+    // 该线程被长任务占住时专属任务只能等待；只需要串行而不在意由哪个线程执行时用Strand
+    // 下标无效时等同于submitTask
+    template<typename Func, typename... Args>
+    auto submitTo(int worker, Func&& func, Args&&... args) -> Future<decltype(func(args...))> {
+        using RType = decltype(func(args...));
+        if (worker < 0 || worker >= static_cast<int>(workers_.size())) {
+            return submitTask(std::forward<Func>(func), std::forward<Args>(args)...);
+        }
+        if (rejectingSubmit()) return submitFailed<RType>(SubmitStatus::SUBMIT_SHUTDOWN);
+
+        Future<RType> result;
+        Task task = packTask(result, nullptr, std::forward<Func>(func), std::forward<Args>(args)...);
+        SubmitStatus status = pushToWorker(worker, task, true);
+        if (status != SubmitStatus::SUBMIT_OK) return submitFailed<RType>(status);
+        return result;
+    }
+
+    // 批量提交：对[begin, end)中每个元素提交一个fn(元素)任务
+    // 只加一次锁批量入队，只唤醒min(N, 空闲线程数)个线程；返回的Future数组一次性分配
+    template<typename Iter, typename Func>
+    auto submitBatch(Iter begin, Iter end, Func&& fn)
+        -> std::vector<Future<decltype(fn(*begin))>>
+    {
+        using RType = decltype(fn(*begin));
+        using Item = typename std::iterator_traits<Iter>::value_type;
+
+        size_t n = static_cast<size_t>(std::distance(begin, end));
+        std::vector<Future<RType>> results;
+        std::vector<Task> tasks;
+        results.reserve(n);
+        tasks.reserve(n);
+
+        for (Iter it = begin; it != end; ++it) {
+            Promise<RType> promise(executor());
+            results.emplace_back(promise.get_future());
+            tasks.emplace_back([promise = std::move(promise),
+                f = std::bind(fn, Item(*it))]() mutable {
+                promise.run(f);
+            });
+        }
+
+        // 未能入队的任务按OverflowPolicy处理，与submitTask一致
+        EnqueueOptions opts = overflowOptions(true);
+        size_t pushed = enqueueBatch(tasks, opts);
+        for (size_t i = pushed; i < n; i++) {
+            if (overflowPolicy_ == OverflowPolicy::OVERFLOW_CALLER_RUNS && !rejectingSubmit()) {
+                callerRan_.fetch_add(1, std::memory_order_relaxed);
+                tasks[i]();
+            } else {
+                results[i] = submitFailed<RType>(failedStatus(opts));
+            }
+        }
+        return results;
+    }
+
+    // 区间批量提交：对[first, last)中的每个下标i执行fn(i)
+    // 所有任务共享一个计数器和一个聚合Future，单个任务不再分配共享状态
+    // 任一任务抛出异常时，聚合Future在全部结束后抛出第一个异常
+    template<typename Index, typename Func>
+    Future<void> submitRange(Index first, Index last, Func&& fn) {
+        static_assert(std::is_integral<Index>::value, "submitRange 的下标必须是整数类型");
+
+        // 区间共享状态：由最后一个完成的任务释放
+        struct RangeState {
+            RangeState(Func&& f, size_t n, FutureExecutor ex)
+                : fn(std::forward<Func>(f)), remaining(n), done(ex) {}
+
+            // 完成count个任务，最后一个完成者设置结果并释放状态
+            void finish(size_t count) {
+                if (remaining.fetch_sub(count, std::memory_order_acq_rel) != count) return;
+                if (error) done.set_exception(error);
+                else done.set_value();
+                delete this;
+            }
+
+            typename std::decay<Func>::type fn;
+            std::atomic<size_t> remaining;
+            std::atomic_bool failed{false};
+            std::exception_ptr error;
+            Promise<void> done;
+        };
+
+        if (!(first < last)) {
+            Promise<void> empty;
+            Future<void> result = empty.get_future();
+            empty.set_value();
+            return result;
+        }
+
+        size_t n = static_cast<size_t>(last - first);
+        auto* state = new RangeState(std::forward<Func>(fn), n, executor());
+        Future<void> result = state->done.get_future();
+
+        // 每个任务只捕获状态指针和下标，放在任务的内联存储中
+        std::vector<Task> tasks;
+        tasks.reserve(n);
+        for (Index i = first; i < last; ++i) {
+            tasks.emplace_back([state, i]() {
+                try {
+                    state->fn(i);
+                } catch (...) {
+                    if (!state->failed.exchange(true)) {
+                        state->error = std::current_exception();
+                    }
+                }
+                state->finish(1);
+            });
+        }
+
+        // 分块任务持有共享状态，drop-oldest时不会被丢弃；未能入队的部分按OverflowPolicy处理：
+        // CALLER_RUNS就地执行，其余策略使聚合Future抛出TaskRejectedError
+        EnqueueOptions opts = overflowOptions(false);
+        size_t pushed = enqueueBatch(tasks, opts);
+        if (pushed < n) {
+            if (overflowPolicy_ == OverflowPolicy::OVERFLOW_CALLER_RUNS && !rejectingSubmit()) {
+                callerRan_.fetch_add(n - pushed, std::memory_order_relaxed);
+                for (size_t i = pushed; i < n; i++) tasks[i]();
+            } else {
+                POOL_LOG_WARN("任务队列已满，%zu个任务提交失败", n - pushed);
+                rejected_.fetch_add(n - pushed, std::memory_order_relaxed);
+                if (!state->failed.exchange(true)) {
+                    state->error = std::make_exception_ptr(TaskRejectedError(failedStatus(opts)));
+                }
+                state->finish(n - pushed);
+            }
+        }
+        return result;
+    }
+
+    // 并行for：对[first, last)中每个下标i执行fn(i)
+    // 采用惰性二分拆分：执行者每处理完一个粒度块，若本地已没有可被窃取的任务，
+    // 就把剩余区间拆出一半交给其他线程，负载不均时自动均衡。
+    // 调用线程参与计算，等待期间帮忙执行队列中的任务，工作线程内嵌套调用也不会死锁。
+    // grain为最小拆分粒度，0表示按线程数自动选择；fn抛出的第一个异常会在调用方重新抛出
+    template<typename Index, typename Func>
+    void parallel_for(Index first, Index last, Func&& fn, Index grain = 0) {
+        static_assert(std::is_integral<Index>::value, "parallel_for 的下标必须是整数类型");
+        if (!(first < last)) return;
+
+        auto body = [&fn](Index b, Index e) {
+            for (Index i = b; i < e; ++i) fn(i);
+        };
+        forkJoin(first, last, grain, body);
+    }
+
+    // 并行归约：返回 init ⊕ map(first) ⊕ ... ⊕ map(last-1)，⊕为combine
+    // 每个线程把结果累加到自己的缓存行对齐槽位，不使用共享原子变量，最后由调用方合并。
+    // 各块的合并顺序不确定，combine需满足结合律和交换律
+    template<typename Index, typename T, typename MapFunc, typename CombineFunc>
+    T parallel_reduce(Index first, Index last, T init,
+        MapFunc&& map, CombineFunc&& combine, Index grain = 0)
+    {
+        static_assert(std::is_integral<Index>::value, "parallel_reduce 的下标必须是整数类型");
+        if (!(first < last)) return init;
+
+        // 每个线程槽位一个部分结果，避免伪共享
+        struct alignas(CACHE_LINE_SIZE) Partial {
+            std::optional<T> value;
+        };
+        std::vector<Partial> partials(workers_.size());
+        Partial external;          // 非本线程池线程（调用方）的部分结果
+        std::mutex externalMtx;    // 可能有多个外部线程帮忙执行
+
+        auto merge = [&combine](std::optional<T>& slot, T&& acc) {
+            if (slot) slot = combine(std::move(*slot), std::move(acc));
+            else slot = std::move(acc);
+        };
+
+        auto body = [&](Index b, Index e) {
+            T acc = map(b);
+            for (Index i = b + 1; i < e; ++i) {
+                acc = combine(std::move(acc), map(i));
+            }
+            Worker* self = currentWorker();
+            if (self != nullptr && self->pool == this) {
+                merge(partials[self->index].value, std::move(acc));
+            } else {
+                std::lock_guard<std::mutex> lock(externalMtx);
+                merge(external.value, std::move(acc));
+            }
+        };
+        forkJoin(first, last, grain, body);
+
+        T result = std::move(init);
+        for (auto& p : partials) {
+            if (p.value) result = combine(std::move(result), std::move(*p.value));
+        }
+        if (external.value) result = combine(std::move(result), std::move(*external.value));
+        return result;
+    }
+
+#if defined(THREADPOOL_HAS_COROUTINES)
+    // co_await pool.schedule()：挂起当前协程，由工作线程恢复执行
+    // 队列满且按OverflowPolicy未能入队时不挂起，协程在当前线程上继续（CALLER_RUNS即为提交方执行）
+    struct ScheduleAwaiter {
+        ThreadPool* pool;
+        TaskPriority priority;
+
+        bool await_ready() const noexcept { return false; }
+        bool await_suspend(std::coroutine_handle<> handle) {
+            return pool->post(handle, priority);
+        }
+        void await_resume() const noexcept {}
+    };
+
+    ScheduleAwaiter schedule(TaskPriority priority = TaskPriority::PRIORITY_NORMAL) {
+        return ScheduleAwaiter{ this, priority };
+    }
+
+    // 投递一个协程句柄，由工作线程直接resume（任务内只存放句柄，不经std::function，不分配内存）
+    // 队列满且按OverflowPolicy未能入队时返回false，句柄仍由调用方负责
+    bool post(std::coroutine_handle<> handle, TaskPriority priority = TaskPriority::PRIORITY_NORMAL) {
+        Task task([handle]() { handle.resume(); });
+        return enqueueTask(task, priority, overflowOptions(false)) == SubmitStatus::SUBMIT_OK;
+    }
+
+    // 在工作线程上运行协程任务直到完成，返回其结果的Future
+    // 任务内部co_await其他CoTask或schedule()时不占用线程，少量线程即可承载大量挂起中的任务
+    template<typename T>
+    Future<T> spawn(CoTask<T> task) {
+        Promise<T> promise(executor());
+        Future<T> result = promise.get_future();
+        runSpawned(*this, std::move(task), std::move(promise));
+        return result;
+    }
+#endif
+
+    // 等待future就绪并取出结果，等待期间在当前线程上执行排队中的任务
+    // 任意线程都可调用；工作线程上直接调用future.get()也会自动帮忙（仅限本线程池产生的Future），
+    // 因此任务内等待子任务不会占住线程，固定线程数下递归分治也不会死锁
+    // 注意：帮忙执行的任务运行在调用方的栈上，等待时不应持有这些任务也会获取的锁
+    template<typename T>
+    T waitFor(Future<T>& future) {
+        if (!future.valid()) throw std::future_error(std::future_errc::no_state);
+        helpUntil([&]()->bool { return future.is_ready(); },
+            [&]() { future.wait_for(std::chrono::milliseconds(1)); });
+        return future.get();
+    }
+
+    template<typename T>
+    T waitFor(Future<T>&& future) {
+        return waitFor(future);
+    }
+
+    // std::future版本（例如由Future转换而来或来自其他来源）
+    template<typename T>
+    T waitFor(std::future<T>& future) {
+        if (!future.valid()) throw std::future_error(std::future_errc::no_state);
+        auto ready = [&]()->bool {
+            return future.wait_for(std::chrono::seconds(0)) != std::future_status::timeout;
+        };
+        helpUntil(ready, [&]() { future.wait_for(std::chrono::milliseconds(1)); });
+        return future.get();
+    }
+
+    // 启动线程池（可指定初始线程数）
+    void start(int initThreadSize = int(std::thread::hardware_concurrency())) {
+        if (shuttingDown_.load(std::memory_order_acquire)) {
+            POOL_LOG_WARN("线程池已关闭，start被忽略");
+            return;
+        }
+        isPoolRunning_ = true;  // 设置运行标志
+        initThreadSize_ = initThreadSize;  // 可覆盖初始线程数
+        curThreadSize_ = initThreadSize;   // 设置当前线程数
+
+        // 无锁后端：按容量阈值创建环形队列（未设置阈值时使用默认容量）
+        if (queueMode_ == QueueMode::QUEUE_LOCK_FREE) {
+            int capacity = taskQueMaxThreshHold_ == TASK_MAX_THRESHHOLD
+                ? LOCK_FREE_QUE_DEFAULT_CAPACITY : taskQueMaxThreshHold_;
+            lockFreeQue_ = std::make_unique<LockFreeLaneQueue<Task>>(static_cast<size_t>(capacity));
+        }
+
+        // 为每个线程创建私有状态，线程函数额外绑定自己的槽位下标
+        // CACHED模式按最大线程数预留槽位，回收线程后槽位可复用
+        int slots = workerSlots();
+        for (int i = 0; i < slots; i++) {
+            workers_.emplace_back(std::make_unique<Worker>(this, i));
+        }
+        for (int i = slots - 1; i >= initThreadSize_; i--) {
+            freeSlots_.push_back(i);
+        }
+        assignPlacement();
+
+        // 创建并启动初始线程；延迟启动时只登记数量，由之后的提交按需创建
+        {
+            std::lock_guard<std::mutex> lock(taskQueMtx_);
+            if (lazyStart_) {
+                lazyPending_.store(initThreadSize_, std::memory_order_release);
+            } else {
+                for (int i = 0; i < initThreadSize_; i++) spawnWorker(i);
+            }
+        }
+
+        // CACHED模式由控制器线程负责扩容和回收
+        if (poolMode_ == PoolMode::MODE_CACHED) {
+            controller_ = std::thread(&ThreadPool::controllerLoop, this);
+        }
+
+        // 启动前就有定时任务时创建定时器线程
+        std::lock_guard<std::mutex> lock(timerMtx_);
+        if (timers_.size() > 0) startTimerThread();
+    }
+
+    // 当前线程总数（CACHED模式随负载变化；延迟启动时包括尚未创建的初始线程）
+    int threadCount() const {
+        return curThreadSize_.load(std::memory_order_relaxed);
+    }
+
+    // 被唤醒后却没有拿到任务的次数（用于观察唤醒是否精准）
+    long long wastedWakeupCount() const {
+        long long n = 0;
+        for (const auto& w : workers_) n += w->stats.spuriousWakeups.load(std::memory_order_relaxed);
+        return n;
+    }
+
+    // 统计快照：汇总各工作线程的计数器和直方图（读取不加锁，各项之间不是严格一致的瞬间）
+    PoolStats stats() const {
+        PoolStats st;
+        for (const auto& w : workers_) {
+            const WorkerStats& ws = w->stats;
+            st.tasksSubmitted += ws.submitted.load(std::memory_order_relaxed);
+            st.tasksCompleted += ws.executed.load(std::memory_order_relaxed);
+            st.steals += ws.steals.load(std::memory_order_relaxed);
+            st.failedSteals += ws.failedSteals.load(std::memory_order_relaxed);
+            st.parks += ws.parks.load(std::memory_order_relaxed);
+            st.wakeups += ws.wakeups.load(std::memory_order_relaxed);
+            st.spuriousWakeups += ws.spuriousWakeups.load(std::memory_order_relaxed);
+            st.parkedSeconds += ws.parkedNs.load(std::memory_order_relaxed) / 1e9;
+            ws.queueWait.snapshotInto(st.queueWait);
+            ws.runTime.snapshotInto(st.runTime);
+        }
+        for (const auto& ext : externalStats_) {
+            st.tasksSubmitted += ext.submitted.load(std::memory_order_relaxed);
+            st.tasksCompleted += ext.executed.load(std::memory_order_relaxed);
+        }
+        st.threadsCreated = threadsCreated_.load(std::memory_order_relaxed);
+        st.threadsRetired = threadsRetired_.load(std::memory_order_relaxed);
+        st.tasksRejected = rejected_.load(std::memory_order_relaxed);
+        st.tasksDropped = dropped_.load(std::memory_order_relaxed);
+        st.tasksCallerRan = callerRan_.load(std::memory_order_relaxed);
+        st.tasksExpired = expired_.load(std::memory_order_relaxed);
+        st.tasksCancelled = cancelled_.load(std::memory_order_relaxed);
+        st.timersFired = timersFired_.load(std::memory_order_relaxed);
+        st.threads = curThreadSize_.load(std::memory_order_relaxed);
+        st.parkedThreads = idle_.idleCount();
+        return st;
+    }
+
+    // 当前在空闲登记表中休眠的线程数
+    int parkedThreadCount() const {
+        return idle_.idleCount();
+    }
+
+    // 当前工作线程的临时内存arena（任意线程池的工作线程；其他线程返回nullptr）
+    // 每个任务返回后自动reset，任务内的临时缓冲区无需逐个释放；
+    // 需要跨任务保留内容时调用 setAutoReset(false)
+    // 注意：任务等待子任务时可能在同一线程上帮忙执行其他任务，
+    // 这些嵌套任务共用同一个arena，只有最外层任务返回后才会reset
+    static TaskArena* currentArena() {
+        Worker* self = currentWorker();
+        return self != nullptr ? &self->arena : nullptr;
+    }
+
+    // pmr适配：工作线程上返回其arena，其他线程返回 std::pmr::get_default_resource()
+    static std::pmr::memory_resource* currentMemoryResource() {
+        TaskArena* arena = currentArena();
+        if (arena != nullptr) return arena;
+        return std::pmr::get_default_resource();
+    }
+
+    // 工作线程绑定的CPU（线程池内编号index为槽位下标；未启用绑定时为空）
+    std::vector<int> workerCpus(int index) const {
+        if (index < 0 || index >= static_cast<int>(workers_.size())) return {};
+        return workers_[index]->cpus;
+    }
+
+    // 全局队列中某个优先级通道的排队深度和排队时间统计（不含工作窃取模式的本地队列）
+    LaneStats laneStats(TaskPriority priority) const {
+        if (queueMode_ == QueueMode::QUEUE_LOCK_FREE) {
+            if (lockFreeQue_ == nullptr) return LaneStats();
+            return lockFreeQue_->stats(priority);
+        }
+        return taskQue_.stats(priority);
+    }
+
+    // 开始跟踪之后提交的任务（提交、出队、开始、结束时间及执行线程）
+    // eventsPerThread为每条线程轨道的事件容量（以第一次调用为准），写满后丢弃新事件
+    // 再次调用会清空之前的记录，此时不应有被跟踪的任务正在执行
+    void startTrace(size_t eventsPerThread = TRACE_DEFAULT_CAPACITY) {
+        if (tracer_ == nullptr) {
+            int tracks = static_cast<int>(workers_.size());
+            if (tracks < workerSlots()) tracks = workerSlots();
+            tracer_ = std::make_unique<TaskTracer>(tracks, EXTERNAL_STATS_STRIPES, eventsPerThread);
+        } else {
+            tracer_->clear();
+        }
+        activeTracer_.store(tracer_.get(), std::memory_order_release);
+    }
+
+    // 停止跟踪新提交的任务（已被跟踪的任务执行完时仍会记录），记录保留到下次startTrace
+    void stopTrace() {
+        activeTracer_.store(nullptr, std::memory_order_release);
+    }
+
+    // 导出Chrome跟踪格式的JSON（可在 chrome://tracing 或 ui.perfetto.dev 中打开）
+    // 可在任务运行期间调用，只包含已写完的记录
+    std::string traceJson() const {
+        if (tracer_ == nullptr) return "{\"traceEvents\":[]}\n";
+        return tracer_->toChromeJson();
+    }
+
+    // 把跟踪数据写入文件，成功返回true
+    bool dumpTrace(const std::string& path) const {
+        std::string json = traceJson();
+        std::FILE* fp = std::fopen(path.c_str(), "wb");
+        if (fp == nullptr) {
+            POOL_LOG_WARN("无法写入跟踪文件 %s", path.c_str());
+            return false;
+        }
+        bool ok = std::fwrite(json.data(), 1, json.size(), fp) == json.size();
+        return std::fclose(fp) == 0 && ok;
+    }
+
+    // 因轨道写满而丢弃的跟踪事件数
+    unsigned long long traceDroppedCount() const {
+        return tracer_ == nullptr ? 0 : tracer_->dropped();
+    }
+
+    // 禁止拷贝构造和赋值
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+private:
+    friend class TaskGraph;  // 需要trySpawn/helpUntil调度就绪节点
+    friend class TaskGroup;  // 需要trySpawn/helpUntil投递组内任务、等待时帮忙执行
+    friend class Strand;     // 需要trySpawn/trySpawnTo投递驱动任务、executor/helpUntil
+
+    using Task = TaskFunction;  // 任务类型（只可移动，小对象内联存储）
+
+    // 本地双端队列只能存指针：任务节点从slab池分配，避免每次push都new
+    static Task* newTaskNode(Task&& task) {
+        return new (slabAllocate<Task>()) Task(std::move(task));
+    }
+
+    // 取出节点中的任务并归还节点
+    static Task takeTaskNode(Task* node) {
+        Task task(std::move(*node));
+        node->~Task();
+        slabDeallocate<Task>(node);
+        return task;
+    }
+
+    // 共享状态从slab池分配；promise与绑定后的函数一起放进任务的内联存储，
+    // 小任务从提交到取得结果不调用operator new
+    // 开启跟踪时再包一层记录生命周期（未开启时只多一次原子读）
+    template<typename RType, typename Func, typename... Args>
+    Task packTask(Future<RType>& result, const char* label, Func&& func, Args&&... args) {
+        Promise<RType> promise(executor());
+        result = promise.get_future();
+        Task task([promise = std::move(promise),
+            fn = std::bind(std::forward<Func>(func), std::forward<Args>(args)...)]() mutable {
+            promise.run(fn);
+        });
+        TaskTracer* tracer = activeTracer_.load(std::memory_order_acquire);
+        if (tracer != nullptr) task = traceTask(tracer, label, std::move(task));
+        task.markDroppable();  // 用户任务：ABORT时可以丢弃
+        return task;
+    }
+
+    // 同packTask，但执行前先调用skip()：返回非空的异常时不调用func，直接把该异常写入Future
+    // 用于出队时跳过已取消、已过期的任务（不抛出异常，跳过的代价只有一次检查和一次结果写入）
+    template<typename RType, typename Skip, typename Func, typename... Args>
+    Task packTaskUnless(Future<RType>& result, Skip&& skip, Func&& func, Args&&... args) {
+        Promise<RType> promise(executor());
+        result = promise.get_future();
+        Task task([promise = std::move(promise), skip = std::forward<Skip>(skip),
+            fn = std::bind(std::forward<Func>(func), std::forward<Args>(args)...)]() mutable {
+            std::exception_ptr error = skip();
+            if (error) {
+                promise.set_exception(std::move(error));
+                return;
+            }
+            promise.run(fn);
+        });
+        TaskTracer* tracer = activeTracer_.load(std::memory_order_acquire);
+        if (tracer != nullptr) task = traceTask(tracer, nullptr, std::move(task));
+        task.markDroppable();
+        return task;
+    }
+
+    // 被取消而跳过的任务写入Future的异常
+    std::exception_ptr cancelledError() {
+        cancelled_.fetch_add(1, std::memory_order_relaxed);
+        return std::make_exception_ptr(TaskCancelledError());
+    }
+
+    // 任务组当前一轮的取消状态（不存在时创建）
+    // 表变大时顺带清理已没有排队任务的组（只有表本身持有其状态），均摊O(1)
+    std::shared_ptr<detail::CancelState> groupState(GroupId group) {
+        std::lock_guard<std::mutex> lock(groupMtx_);
+        auto it = groups_.find(group);
+        if (it != groups_.end()) return it->second;
+        if (groups_.size() >= groupSweepAt_) {
+            for (auto iter = groups_.begin(); iter != groups_.end();) {
+                if (iter->second.use_count() == 1) iter = groups_.erase(iter);
+                else ++iter;
+            }
+            groupSweepAt_ = std::max(GROUP_SWEEP_MIN, groups_.size() * 2);
+        }
+        auto state = std::make_shared<detail::CancelState>();
+        groups_.emplace(group, state);
+        return state;
+    }
+
+    // 记录提交事件，并把任务包装为执行时记录出队、开始、结束时间
+    Task traceTask(TaskTracer* tracer, const char* label, Task&& task) {
+        std::uint64_t id = tracer->nextId();
+        TraceRecord rec;
+        rec.id = id;
+        rec.t0 = detail::laneNowNs();
+        rec.label = label;
+        rec.kind = TraceRecord::SUBMIT;
+        tracer->record(traceTrack(tracer), rec);
+
+        return Task([this, tracer, id, label, inner = std::move(task)]() mutable {
+            TraceRecord run;
+            run.id = id;
+            run.label = label;
+            run.kind = TraceRecord::RUN;
+            run.t1 = detail::laneNowNs();
+            run.t0 = run.t1;
+            Worker* self = currentWorker();
+            if (self != nullptr && self->pool == this && self->dequeueNs != 0) {
+                run.t0 = self->dequeueNs;
+                self->dequeueNs = 0;  // 嵌套执行的任务不沿用外层的出队时间
+            }
+            int track = traceTrack(tracer);
+            inner();
+            run.t2 = detail::laneNowNs();
+            tracer->record(track, run);
+        });
+    }
+
+    // 当前线程的跟踪轨道：工作线程用自己的槽位，其他线程按分片
+    int traceTrack(const TaskTracer* tracer) const {
+        Worker* self = currentWorker();
+        if (self != nullptr && self->pool == this && self->index < tracer->workerTracks()) {
+            return self->index;
+        }
+        return tracer->workerTracks() + externalStripe();
+    }
+
+    // 一次入队在队列满时的处理方式
+    struct EnqueueOptions {
+        std::chrono::nanoseconds wait{0};  // 最长等待时间（max表示一直等待）
+        bool dropOldest = false;           // 丢弃最早入队的任务腾出位置
+        bool droppable = false;            // 本任务之后能否被丢弃（只有用户提交的任务可以）
+        GroupId group = 0;                 // 所属任务组（加锁队列中记录，供cancelGroup一次移出）
+    };
+
+    // submitTask按OverflowPolicy得到的入队方式
+    EnqueueOptions overflowOptions(bool droppable) const {
+        EnqueueOptions opts;
+        if (overflowPolicy_ == OverflowPolicy::OVERFLOW_BLOCK) opts.wait = toWaitLimit(blockTimeout_);
+        opts.dropOldest = overflowPolicy_ == OverflowPolicy::OVERFLOW_DROP_OLDEST;
+        opts.droppable = droppable;
+        return opts;
+    }
+
+    // 等待时长换算为纳秒：超过一年视为一直等待（避免计算截止时间时溢出）
+    template<typename Rep, typename Period>
+    static std::chrono::nanoseconds toWaitLimit(const std::chrono::duration<Rep, Period>& d) {
+        using Seconds = std::chrono::duration<double>;
+        if (d <= d.zero()) return std::chrono::nanoseconds::zero();
+        if (Seconds(d) >= Seconds(std::chrono::hours(24 * 365))) return std::chrono::nanoseconds::max();
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(d);
+    }
+
+    SubmitStatus failedStatus(const EnqueueOptions& opts) const {
+        if (rejectingSubmit()) return SubmitStatus::SUBMIT_SHUTDOWN;
+        return opts.wait > std::chrono::nanoseconds::zero() ? SubmitStatus::SUBMIT_TIMEOUT : SubmitStatus::SUBMIT_QUEUE_FULL;
+    }
+
+    // shutdown之后拒绝外部提交；本线程池的工作线程仍可提交
+    bool rejectingSubmit() const {
+        if (!shuttingDown_.load(std::memory_order_acquire)) return false;
+        Worker* self = currentWorker();
+        return self == nullptr || self->pool != this;
+    }
+
+    // 把打包好的任务按OverflowPolicy放入队列
+    template<typename RType>
+    Future<RType> submitTaskWith(Task&& task, Future<RType>&& result, TaskPriority priority) {
+        return submitTaskWith(std::move(task), std::move(result), priority, overflowOptions(true));
+    }
+
+    template<typename RType>
+    Future<RType> submitTaskWith(Task&& task, Future<RType>&& result, TaskPriority priority, const EnqueueOptions& opts) {
+        SubmitStatus status = enqueueTask(task, priority, opts);
+        if (status == SubmitStatus::SUBMIT_OK) {
+            return std::move(result);  // 返回Future给调用者
+        }
+        if (overflowPolicy_ == OverflowPolicy::OVERFLOW_CALLER_RUNS && status != SubmitStatus::SUBMIT_SHUTDOWN) {
+            callerRan_.fetch_add(1, std::memory_order_relaxed);
+            task();  // 结果经任务内的Promise写入result
+            return std::move(result);
+        }
+        task = nullptr;
+        return submitFailed<RType>(status);
+    }
+
+    // 把任务放入队列（按模式和队列后端选择入队路径），失败时task保持不变，由调用方处理
+    SubmitStatus enqueueTask(Task& task, TaskPriority priority, const EnqueueOptions& opts) {
+        if (rejectingSubmit()) return SubmitStatus::SUBMIT_SHUTDOWN;
+
+        // 工作窃取模式下，工作线程内部提交的任务直接进入本地队列（无锁）
+        if (poolMode_ == PoolMode::MODE_WORK_STEALING && priority != TaskPriority::PRIORITY_LOW) {
+            Worker* self = currentWorker();
+            if (self != nullptr && self->pool == this) {
+                self->localQue.push(newTaskNode(std::move(task)));
+                detail::bumpCounter(self->stats.submitted);
+                wakeWorker();
+                return SubmitStatus::SUBMIT_OK;
+            }
+        }
+
+        // 无锁后端：入队不持有taskQueMtx_，仅在有线程休眠时才加锁唤醒
+        if (queueMode_ == QueueMode::QUEUE_LOCK_FREE) {
+            SubmitStatus status = pushLockFree(task, priority, opts);
+            if (status != SubmitStatus::SUBMIT_OK) {
+                return status;
+            }
+            countSubmitted(1);
+            wakeWorker();
+            requestGrowth();
+            return SubmitStatus::SUBMIT_OK;
+        }
+
+        Task victim;             // drop-oldest挤出的任务（在锁外处理）
+        bool victimDroppable = false;
+        {
+            // 加锁操作任务队列
+            std::unique_lock<std::mutex> lock(taskQueMtx_);
+            if (opts.dropOldest && taskQue_.size() >= (size_t)taskQueMaxThreshHold_
+                && taskQue_.popOldest(victim, victimDroppable)) {
+                taskSize_--;
+            }
+
+            // 任务入队（按优先级进入对应通道），队列满时按opts等待
+            bool pushed = waitForSpace(lock, opts.wait, [&]()->bool {
+                if (taskQue_.size() >= (size_t)taskQueMaxThreshHold_) return false;
+                taskQue_.push(std::move(task), priority, opts.droppable, opts.group);
+                taskSize_++;  // 原子计数增加
+                return true;
+            });
+            if (!pushed) {
+                return failedStatus(opts);
+            }
+        }
+        countSubmitted(1);
+
+        // 只唤醒一个空闲线程（在锁外通知）
+        wakeWorker();
+        // CACHED模式：积压时通知控制器扩容
+        requestGrowth();
+        if (victim != nullptr) discardVictim(victim, victimDroppable);
+        return SubmitStatus::SUBMIT_OK;
+    }
+
+    // 任务放入租户队列，必要时再启动一个轮转任务；失败时task保持不变
+    SubmitStatus enqueueTenant(TenantId tenant, Task& task) {
+        Task victim;  // drop-oldest挤出的同租户任务（在锁外丢弃）
+        bool startPump = false;
+        {
+            std::unique_lock<std::mutex> lock(tenantMtx_);
+            if (rejectingSubmit()) return SubmitStatus::SUBMIT_SHUTDOWN;
+            if (overflowPolicy_ == OverflowPolicy::OVERFLOW_DROP_OLDEST && tenants_.full(tenant)) {
+                tenants_.popOldest(tenant, victim);
+            }
+            if (tenants_.full(tenant)) {
+                std::chrono::nanoseconds wait = overflowPolicy_ == OverflowPolicy::OVERFLOW_BLOCK
+                    ? toWaitLimit(blockTimeout_) : std::chrono::nanoseconds::zero();
+                if (!waitForTenantSpace(lock, tenant, wait)) {
+                    if (rejectingSubmit()) return SubmitStatus::SUBMIT_SHUTDOWN;
+                    if (overflowPolicy_ != OverflowPolicy::OVERFLOW_CALLER_RUNS) tenants_.onRejected(tenant);
+                    return wait > std::chrono::nanoseconds::zero() ? SubmitStatus::SUBMIT_TIMEOUT : SubmitStatus::SUBMIT_QUEUE_FULL;
+                }
+            }
+            tenants_.push(tenant, std::move(task));
+            if (tenantPumps_ < std::max(1, curThreadSize_.load(std::memory_order_relaxed))) {
+                tenantPumps_++;
+                startPump = true;
+            }
+        }
+        if (victim != nullptr) discardVictim(victim, true);
+        if (startPump) {
+            // 轮转任务不可丢弃、不受OverflowPolicy影响：全局队列满时等待空位
+            // 与shutdown竞争而未能入队时在当前线程上开始轮转（之后经trySpawn交给工作线程）
+            Task pump([this]() { pumpTenants(); });
+            EnqueueOptions opts;
+            opts.wait = std::chrono::nanoseconds::max();
+            if (enqueueTask(pump, TaskPriority::PRIORITY_NORMAL, opts) != SubmitStatus::SUBMIT_OK) pump();
+        }
+        return SubmitStatus::SUBMIT_OK;
+    }
+
+    // 等待租户队列出现空位（持有tenantMtx_调用），与waitForSpace相同：
+    // 本线程池的工作线程不干等，而是帮忙执行租户任务
+    bool waitForTenantSpace(std::unique_lock<std::mutex>& lock, TenantId tenant, std::chrono::nanoseconds wait) {
+        if (wait <= std::chrono::nanoseconds::zero()) return false;
+
+        using Clock = std::chrono::steady_clock;
+        const bool forever = wait == std::chrono::nanoseconds::max();
+        const Clock::time_point deadline = forever ? Clock::time_point::max() : Clock::now() + wait;
+        Worker* self = currentWorker();
+        const bool helping = self != nullptr && self->pool == this;
+
+        tenantBlocked_++;
+        bool ok = false;
+        for (;;) {
+            if (rejectingSubmit()) break;
+            if (!tenants_.full(tenant)) {
+                ok = true;
+                break;
+            }
+            if (!forever && Clock::now() >= deadline) break;
+            Task pending;
+            if (helping && tenants_.pop(pending)) {
+                lock.unlock();
+                pending();
+                pending = nullptr;
+                lock.lock();
+                continue;
+            }
+            Clock::time_point slice = Clock::now() + SUBMIT_HELP_WAIT_SLICE;
+            if (helping) tenantNotFull_.wait_until(lock, forever ? slice : std::min(deadline, slice));
+            else if (forever) tenantNotFull_.wait(lock);
+            else tenantNotFull_.wait_until(lock, deadline);
+        }
+        tenantBlocked_--;
+        return ok;
+    }
+
+    // 轮转任务：按权重从租户队列取一个任务执行，之后把自己重新排到全局队列末尾
+    // （与其他池内任务交替执行），全局队列满时在当前线程上继续；租户队列取空时退出
+    void pumpTenants() {
+        for (;;) {
+            Task task;
+            {
+                std::lock_guard<std::mutex> lock(tenantMtx_);
+                if (!tenants_.pop(task)) {
+                    tenantPumps_--;
+                    return;
+                }
+                if (tenantBlocked_ > 0) tenantNotFull_.notify_all();
+            }
+            task();
+            task = nullptr;
+            {
+                std::lock_guard<std::mutex> lock(tenantMtx_);
+                if (tenants_.empty()) {
+                    tenantPumps_--;
+                    return;
+                }
+            }
+            if (trySpawn(Task([this]() { pumpTenants(); }))) return;
+        }
+    }
+
+    // 队列满时等待空位：tryPut在持有taskQueMtx_时调用，放入成功返回true
+    // 本线程池的工作线程不干等，而是帮忙执行排队中的任务（自己腾出空位），
+    // 找不到任务时最多休眠SUBMIT_HELP_WAIT_SLICE再检查
+    template<typename TryPut>
+    bool waitForSpace(std::unique_lock<std::mutex>& lock, std::chrono::nanoseconds wait, TryPut tryPut) {
+        if (tryPut()) return true;
+        if (wait <= std::chrono::nanoseconds::zero()) return false;
+
+        using Clock = std::chrono::steady_clock;
+        const bool forever = wait == std::chrono::nanoseconds::max();
+        const Clock::time_point deadline = forever ? Clock::time_point::max() : Clock::now() + wait;
+        Worker* self = currentWorker();
+        const bool helping = self != nullptr && self->pool == this;
+
+        blockedProducers_++;
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        bool ok = false;
+        for (;;) {
+            if (rejectingSubmit()) break;  // shutdown唤醒等待中的外部提交者
+            if (tryPut()) {
+                ok = true;
+                break;
+            }
+            if (!forever && Clock::now() >= deadline) break;
+            if (helping) {
+                lock.unlock();
+                bool ran = runPendingTask();
+                lock.lock();
+                if (ran) continue;
+                Clock::time_point slice = Clock::now() + SUBMIT_HELP_WAIT_SLICE;
+                notFull_.wait_until(lock, forever ? slice : std::min(deadline, slice));
+            } else if (forever) {
+                notFull_.wait(lock);
+            } else {
+                notFull_.wait_until(lock, deadline);
+            }
+        }
+        blockedProducers_--;
+        return ok;
+    }
+
+    // drop-oldest挤出的任务：用户任务直接丢弃（析构时其Promise使Future得到broken_promise），
+    // 内部任务（续延、区间分块、协程恢复等）丢弃会破坏等待方，改为在当前线程上执行
+    void discardVictim(Task& victim, bool droppable) {
+        if (droppable) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            victim = nullptr;
+            return;
+        }
+        victim();
+        victim = nullptr;
+    }
+
+    // 按拓扑为每个槽位分配节点和CPU，并创建各节点的注入队列
+    // 线程i位于节点 i % 节点数，节点内第 i / 节点数 个CPU（线程多于CPU时循环复用）
+    void assignPlacement() {
+        if (affinityMode_ == AffinityMode::AFFINITY_NONE) return;
+        if (!topologySet_) topology_ = CpuTopology::detect();
+        int nodes = topology_.nodeCount();
+        if (nodes == 0) return;
+
+        for (auto& w : workers_) {
+            int node = w->index % nodes;
+            const std::vector<int>& cpus = topology_.nodes[node];
+            w->node = node;
+            if (affinityMode_ == AffinityMode::AFFINITY_CORE) {
+                w->cpus.assign(1, cpus[(w->index / nodes) % cpus.size()]);
+            } else {
+                w->cpus = cpus;
+            }
+        }
+        // 只有一个节点时无需分组，节点提交直接走全局队列
+        if (nodes > 1) {
+            for (int n = 0; n < nodes; n++) {
+                nodeQues_.emplace_back(std::make_unique<NodeQueue>());
+            }
+        }
+    }
+
+    // 从节点注入队列取一个任务：local为true只取node自己的队列，否则依次取其他节点
+    bool popNode(int node, bool local, Task& task) {
+        if (nodeTaskSize_.load(std::memory_order_relaxed) == 0) return false;
+        int n = static_cast<int>(nodeQues_.size());
+        for (int i = 0; i < n; i++) {
+            int target = local ? node : (node + 1 + i) % n;
+            if (!local && target == node) continue;
+            NodeQueue& nq = *nodeQues_[target];
+            if (nq.size.load(std::memory_order_relaxed) > 0) {
+                std::lock_guard<std::mutex> lock(nq.mtx);
+                if (!nq.que.empty()) {
+                    detail::LaneItem<Task>& item = nq.que.front();
+                    task = std::move(item.task);
+                    recordQueueWait(detail::laneNowNs() - item.enqueuedNs);
+                    nq.que.pop();
+                    nq.size.fetch_sub(1, std::memory_order_relaxed);
+                    nodeTaskSize_.fetch_sub(1, std::memory_order_relaxed);
+                    return true;
+                }
+            }
+            if (local) break;
+        }
+        return false;
+    }
+
+    // 按模式和队列后端创建线程对象（index为线程在workers_中的槽位）
+    std::unique_ptr<Thread> createThread(int index) {
+        void (ThreadPool::*func)(int, int) = &ThreadPool::threadFunc;
+        if (poolMode_ == PoolMode::MODE_WORK_STEALING) func = &ThreadPool::stealingThreadFunc;
+        else if (queueMode_ == QueueMode::QUEUE_LOCK_FREE) func = &ThreadPool::lockFreeThreadFunc;
+        return std::make_unique<Thread>(
+            [this, func, index](int threadid) { (this->*func)(threadid, index); }, nextThreadId_++);
+    }
+
+    // 创建并启动一个线程（调用方需持有taskQueMtx_），线程ID按本线程池的计数分配
+    void spawnWorker(int index) {
+        {
+            std::lock_guard<std::mutex> lock(workers_[index]->inboxMtx);
+            workers_[index]->live = true;
+        }
+        auto ptr = createThread(index);
+        Thread* thread = ptr.get();
+        threads_.emplace(thread->getId(), std::move(ptr));  // 存入线程表
+        thread->start();
+        idleThreadSize_++;  // 空闲数增加（新线程会立即取任务）
+    }
+
+    // 延迟启动：已创建的线程都在执行任务时，为新入队的任务按需创建线程，返回创建的数量
+    // 每次最多创建demand个，累计不超过初始线程数
+    int spawnLazily(int demand) {
+        if (lazyPending_.load(std::memory_order_acquire) == 0) return 0;
+        std::lock_guard<std::mutex> lock(taskQueMtx_);
+        return spawnLazilyLocked(demand);
+    }
+
+    // 同spawnLazily（调用方需持有taskQueMtx_）
+    int spawnLazilyLocked(int demand) {
+        int pending = lazyPending_.load(std::memory_order_relaxed);
+        if (pending == 0) return 0;
+        // 排队中的任务多于没有在执行任务的线程（正在启动、找任务或休眠）时补足差额
+        int queued = std::max(demand, pendingTaskCount() + nodeTaskSize_.load(std::memory_order_relaxed));
+        int spawned = initThreadSize_ - pending;
+        int available = 0;
+        for (int i = 0; i < spawned && available < queued; i++) {
+            if (!workers_[i]->busy.load(std::memory_order_relaxed)) available++;
+        }
+        if (available >= queued) return 0;
+        int n = std::min(queued - available, pending);
+        for (int i = 0; i < n; i++) {
+            spawnWorker(spawned + i);  // 初始线程的槽位依次使用
+        }
+        lazyPending_.store(pending - n, std::memory_order_release);
+        return n;
+    }
+
+    // CACHED模式新增一个线程（调用方需持有taskQueMtx_）
+    void growThread() {
+        if (freeSlots_.empty()) return;  // 槽位用尽（已达线程数上限）
+        int index = freeSlots_.back();
+        freeSlots_.pop_back();
+
+        POOL_LOG_DEBUG(">>> 创建新线程（槽位%d）", index);
+        spawnWorker(index);  // 创建新线程并启动
+        curThreadSize_++;    // 当前线程数增加
+        threadsCreated_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // 批量入队：按模式选择入队路径，入队结束后唤醒min(N, 空闲线程数)个线程
+    // 队列满时按opts处理（每次等待最多opts.wait），返回成功入队的任务数（tasks的前若干个）
+    size_t enqueueBatch(std::vector<Task>& tasks, const EnqueueOptions& opts) {
+        size_t n = tasks.size();
+        if (n == 0) return 0;
+
+        // 工作窃取模式下，工作线程内部批量提交直接压入本地队列
+        if (poolMode_ == PoolMode::MODE_WORK_STEALING) {
+            Worker* self = currentWorker();
+            if (self != nullptr && self->pool == this) {
+                for (auto& t : tasks) {
+                    self->localQue.push(newTaskNode(std::move(t)));
+                }
+                detail::bumpCounter(self->stats.submitted, n);
+                idle_.notifyMany(static_cast<int>(n));
+                return n;
+            }
+        }
+        if (rejectingSubmit()) return 0;
+
+        size_t pushed = 0;    // 已入队数
+        size_t notified = 0;  // 已为其唤醒线程的任务数
+        auto wakeForPushed = [&](bool locked) {
+            int n = static_cast<int>(pushed - notified);
+            idle_.notifyMany(n - (locked ? spawnLazilyLocked(n) : spawnLazily(n)));
+            notified = pushed;
+        };
+        const TaskPriority normal = TaskPriority::PRIORITY_NORMAL;
+
+        if (queueMode_ == QueueMode::QUEUE_LOCK_FREE) {
+            for (; pushed < n; pushed++) {
+                if (lockFreeQue_->tryPush(std::move(tasks[pushed]), normal, opts.droppable)) continue;
+                // 队列满：先唤醒消费者，再按opts重试或等待
+                wakeForPushed(false);
+                if (pushLockFree(tasks[pushed], normal, opts) != SubmitStatus::SUBMIT_OK) break;
+            }
+        } else {
+            std::unique_lock<std::mutex> lock(taskQueMtx_);
+            while (pushed < n) {
+                // 一次性放入所有能放下的任务
+                size_t before = pushed;
+                while (pushed < n && taskQue_.size() < (size_t)taskQueMaxThreshHold_) {
+                    taskQue_.push(std::move(tasks[pushed++]), normal, opts.droppable);
+                }
+                taskSize_ += static_cast<int>(pushed - before);
+                if (pushed == n || opts.dropOldest) break;
+
+                // 放不下：先唤醒消费者腾出空间，再等待放入下一个
+                wakeForPushed(true);
+                bool ok = waitForSpace(lock, opts.wait, [&]()->bool {
+                    if (taskQue_.size() >= (size_t)taskQueMaxThreshHold_) return false;
+                    taskQue_.push(std::move(tasks[pushed++]), normal, opts.droppable);
+                    taskSize_++;
+                    return true;
+                });
+                if (!ok) break;
+            }
+        }
+
+        wakeForPushed(false);
+        countSubmitted(pushed);
+        requestGrowth();
+
+        // drop-oldest：放不下的逐个挤掉最早入队的任务
+        if (opts.dropOldest) {
+            while (pushed < n && enqueueTask(tasks[pushed], normal, opts) == SubmitStatus::SUBMIT_OK) pushed++;
+        }
+        return pushed;
+    }
+
+    // 积压任务数：排队中的任务（含各节点队列）减去空闲线程数
+    int taskBacklog() const {
+        return pendingTaskCount() + nodeTaskSize_.load(std::memory_order_relaxed) - idleThreadSize_;
+    }
+
+    // CACHED模式：有积压且未达线程上限时通知控制器（提交路径上只做无锁判断，不创建线程）
+    void requestGrowth() {
+        if (poolMode_ != PoolMode::MODE_CACHED) return;
+        if (taskBacklog() <= 0 || curThreadSize_ >= threadSizeThreshHold_) return;
+        if (ctrlPoked_.load(std::memory_order_relaxed)
+            || ctrlPoked_.exchange(true, std::memory_order_acq_rel)) return;
+        std::lock_guard<std::mutex> lock(ctrlMtx_);
+        ctrlCond_.notify_one();
+    }
+
+    // 弹性伸缩控制器（CACHED模式的独立线程）
+    // 扩容：积压任务按最近吞吐估算的排队时间超过growWait时，一次最多新增maxGrowStep个线程；
+    //       吞吐为0（线程都阻塞在任务里）时视为无限等待，立即扩容
+    // 缩容：线程数超过初始值时，按整个观察窗口（shrinkIdle）内最少的多余空闲线程数回收，
+    //       每次唤醒空闲最久的线程让它退出
+    // 没有积压且线程数等于初始值时无限休眠，直到提交方通知
+    void controllerLoop() {
+        using Clock = std::chrono::steady_clock;
+        Clock::time_point lastSample = Clock::now();
+        Clock::time_point windowStart = lastSample;
+        unsigned long long lastCompleted = executedTasks();
+        double rate = 0;               // 最近吞吐（任务/秒，指数平滑）
+        int minSpare = INT32_MAX;      // 观察窗口内最少的多余空闲线程数
+        auto shrinkSample = std::min<Clock::duration>(elastic_.shrinkIdle / 8, std::chrono::seconds(1));
+
+        std::unique_lock<std::mutex> lock(ctrlMtx_);
+        while (!ctrlStop_) {
+            auto woken = [&]()->bool { return ctrlStop_ || ctrlPoked_.load(std::memory_order_relaxed); };
+            if (taskBacklog() > 0 && curThreadSize_ < threadSizeThreshHold_) {
+                ctrlCond_.wait_for(lock, elastic_.sampleInterval, woken);
+            } else if (curThreadSize_ > initThreadSize_) {
+                ctrlCond_.wait_for(lock, shrinkSample, woken);
+            } else {
+                ctrlCond_.wait(lock, woken);
+            }
+            if (ctrlStop_) break;
+            ctrlPoked_.store(false, std::memory_order_relaxed);
+            lock.unlock();
+
+            Clock::time_point now = Clock::now();
+            double dt = std::chrono::duration<double>(now - lastSample).count();
+            if (dt > 0) {
+                unsigned long long completed = executedTasks();
+                double instant = static_cast<double>(completed - lastCompleted) / dt;
+                rate = rate == 0 ? instant : (rate + instant) / 2;
+                lastCompleted = completed;
+                lastSample = now;
+            }
+
+            int backlog = taskBacklog();
+            if (backlog > 0 && curThreadSize_ < threadSizeThreshHold_) {
+                double waitUs = rate > 0 ? backlog / rate * 1e6 : 1e18;
+                if (waitUs >= static_cast<double>(elastic_.growWait.count())) {
+                    std::lock_guard<std::mutex> guard(taskQueMtx_);
+                    for (int i = 0; i < std::min(backlog, elastic_.maxGrowStep); i++) {
+                        if (curThreadSize_ >= threadSizeThreshHold_) break;
+                        growThread();
+                    }
+                }
+            }
+
+            // 缩容：有积压时重新开始观察窗口
+            int spare = backlog < 0 ? -backlog : 0;
+            if (curThreadSize_ <= initThreadSize_ || spare == 0) {
+                windowStart = now;
+                minSpare = INT32_MAX;
+            } else {
+                minSpare = std::min(minSpare, spare);
+                if (now - windowStart >= elastic_.shrinkIdle) {
+                    int retire = std::min(minSpare, curThreadSize_ - initThreadSize_);
+                    retireRequests_.fetch_add(retire, std::memory_order_acq_rel);
+                    for (int i = 0; i < retire; i++) idle_.notifyOldest();
+                    windowStart = now;
+                    minSpare = INT32_MAX;
+                }
+            }
+            lock.lock();
+        }
+    }
+
+    // 停止控制器线程（析构时调用）
+    void stopController() {
+        if (!controller_.joinable()) return;
+        {
+            std::lock_guard<std::mutex> lock(ctrlMtx_);
+            ctrlStop_ = true;
+        }
+        ctrlCond_.notify_one();
+        controller_.join();
+    }
+
+    // 任意时钟的时间点换算为steady_clock
+    template<typename Clock, typename Duration>
+    static std::chrono::steady_clock::time_point toSteady(const std::chrono::time_point<Clock, Duration>& tp) {
+        using Steady = std::chrono::steady_clock;
+        if constexpr (std::is_same<Clock, Steady>::value) {
+            return std::chrono::time_point_cast<Steady::duration>(tp);
+        } else {
+            return Steady::now() + std::chrono::duration_cast<Steady::duration>(tp - Clock::now());
+        }
+    }
+
+    // 当前时间所在的tick（向下取整）
+    std::uint64_t nowTick() const {
+        auto elapsed = std::chrono::steady_clock::now() - timerOrigin_;
+        return static_cast<std::uint64_t>(elapsed / TIMER_TICK);
+    }
+
+    // 时间点对应的到期tick（向上取整，定时任务不会早于设定时间入队）
+    std::uint64_t tickAt(std::chrono::steady_clock::time_point tp) const {
+        if (tp <= timerOrigin_) return 0;
+        auto elapsed = tp - timerOrigin_;
+        return static_cast<std::uint64_t>((elapsed + TIMER_TICK - std::chrono::steady_clock::duration(1)) / TIMER_TICK);
+    }
+
+    // 登记一个定时器，period为0表示一次性；成功时task被移走
+    // 线程池正在销毁时返回0，task保持不变（由调用方销毁，一次性任务的Future得到broken_promise）
+    TimerId addTimer(std::chrono::steady_clock::time_point when, std::chrono::nanoseconds period,
+        TaskPriority priority, Task& task)
+    {
+        TimerId id = 0;
+        bool wake = false;
+        {
+            std::lock_guard<std::mutex> lock(timerMtx_);
+            if (timerStop_) return 0;
+            TimerNode* node = timers_.allocate();
+            node->expiry = tickAt(when);
+            node->period = static_cast<std::uint64_t>((period + TIMER_TICK - std::chrono::nanoseconds(1)) / TIMER_TICK);
+            node->priority = priority;
+            node->fn = std::move(task);
+            id = TimerWheel::idOf(node);
+            wake = armTimer(node);
+            startTimerThread();
+        }
+        if (wake) timerCond_.notify_one();
+        return id;
+    }
+
+    // 把节点挂到时间轮上（调用方持有timerMtx_），比定时器线程计划醒来的时间更早时返回true，
+    // 由调用方在锁外唤醒它；时间轮为空时先把它的时间推进到当前，避免长时间空闲后补转空槽
+    bool armTimer(TimerNode* node) {
+        if (timers_.pending() == 0) timers_.advance(nowTick(), [](TimerNode*) {});
+        timers_.insert(node);
+        if (node->expiry >= timerWakeTick_) return false;
+        timerWakeTick_ = node->expiry;
+        return true;
+    }
+
+    // 线程池已启动且定时器线程尚未创建时创建它（调用方持有timerMtx_）
+    void startTimerThread() {
+        if (!timerThread_.joinable() && isPoolRunning_) {
+            timerThread_ = std::thread(&ThreadPool::timerLoop, this);
+        }
+    }
+
+    // 一个到期的定时器：一次性任务直接是用户任务，周期任务是执行并重新挂回的包装
+    struct FiredTimer {
+        Task task;
+        TimerNode* periodic;  // 周期定时器的节点（一次性为nullptr）
+        TaskPriority priority;
+    };
+
+    // 定时器线程：推进时间轮，在锁外把到期的任务放入任务队列
+    // 没有定时器时一直休眠；否则睡到时间轮给出的下一个tick，期间有更早到期的定时器加入时被唤醒
+    void timerLoop() {
+        std::vector<FiredTimer> fired;
+        std::unique_lock<std::mutex> lock(timerMtx_);
+        while (!timerStop_) {
+            timers_.advance(nowTick(), [&](TimerNode* node) {
+                TaskPriority priority = node->priority;
+                if (node->period == 0) {
+                    fired.push_back(FiredTimer{ timers_.release(node), nullptr, priority });
+                } else {
+                    fired.push_back(FiredTimer{ Task([this, node]() { runPeriodic(node); }), node, priority });
+                }
+            });
+            if (!fired.empty()) {
+                lock.unlock();
+                dispatchTimers(fired);
+                fired.clear();
+                lock.lock();
+                continue;
+            }
+            std::uint64_t next = timers_.nextTick();
+            timerWakeTick_ = next;
+            if (next == TimerWheel::NO_TICK) {
+                timerCond_.wait(lock);
+            } else {
+                timerCond_.wait_until(lock, timerOrigin_ + TIMER_TICK * static_cast<long long>(next));
+            }
+            timerWakeTick_ = 0;  // 处理期间加入的定时器不必唤醒（处理完会重新计算）
+        }
+    }
+
+    // 把到期的定时任务按OverflowPolicy放入队列（定时器线程即提交方：CALLER_RUNS时在定时器线程上执行）
+    // 周期任务的包装不可丢弃（丢弃后节点无法再挂回），入队失败时跳过这一次
+    void dispatchTimers(std::vector<FiredTimer>& fired) {
+        for (FiredTimer& f : fired) {
+            timersFired_.fetch_add(1, std::memory_order_relaxed);
+            SubmitStatus status = enqueueTask(f.task, f.priority, overflowOptions(f.periodic == nullptr));
+            if (status == SubmitStatus::SUBMIT_OK) continue;
+            if (overflowPolicy_ == OverflowPolicy::OVERFLOW_CALLER_RUNS) {
+                callerRan_.fetch_add(1, std::memory_order_relaxed);
+                f.task();
+                continue;
+            }
+            rejected_.fetch_add(1, std::memory_order_relaxed);
+            POOL_LOG_WARN("任务队列已满，到期的定时任务未能提交");
+            if (f.periodic != nullptr) finishPeriodic(f.periodic);
+            f.task = nullptr;
+        }
+    }
+
+    // 执行一次周期任务，之后按周期重新挂回时间轮
+    void runPeriodic(TimerNode* node) {
+        try {
+            node->fn();
+        } catch (const std::exception& e) {
+            POOL_LOG_ERROR("周期任务抛出异常：%s", e.what());
+        } catch (...) {
+            POOL_LOG_ERROR("周期任务抛出未知异常");
+        }
+        finishPeriodic(node);
+    }
+
+    // 周期任务的一次执行结束：已取消（或线程池正在销毁）则释放节点，否则挂回下一个周期
+    void finishPeriodic(TimerNode* node) {
+        Task fn;  // 在锁外销毁
+        bool wake = false;
+        {
+            std::lock_guard<std::mutex> lock(timerMtx_);
+            if (node->cancelled || timerStop_) {
+                fn = timers_.release(node);
+            } else {
+                std::uint64_t now = nowTick();
+                node->expiry += node->period;
+                if (node->expiry <= now) {
+                    node->expiry += ((now - node->expiry) / node->period + 1) * node->period;
+                }
+                wake = armTimer(node);
+            }
+        }
+        if (wake) timerCond_.notify_one();
+    }
+
+    // 停止定时器线程（析构时调用）：未触发的定时任务被丢弃（一次性任务的Future得到broken_promise），
+    // 正在执行的周期任务执行完后释放
+    void stopTimer() {
+        std::vector<Task> dropped;  // 在锁外销毁
+        {
+            std::lock_guard<std::mutex> lock(timerMtx_);
+            timerStop_ = true;
+            timers_.drain([&](TimerNode* node) { dropped.push_back(timers_.release(node)); });
+        }
+        timerCond_.notify_one();
+        if (timerThread_.joinable()) timerThread_.join();
+    }
+
+    // 一次分叉-合并调用的共享状态（位于调用方栈上）
+    template<typename Index, typename Body>
+    struct ForkJoinState {
+        ForkJoinState(Body& b, Index g) : body(b), grain(g) {}
+
+        Body& body;
+        Index grain;
+        JoinCounter join;                 // 根区间占一个计数
+        std::atomic_bool failed{false};
+        std::exception_ptr error;         // 第一个异常
+    };
+
+    // 执行[first, last)：根区间在调用线程上运行，之后帮忙执行直到全部完成
+    template<typename Index, typename Body>
+    void forkJoin(Index first, Index last, Index grain, Body& body) {
+        if (grain <= 0) {
+            // 默认每个线程约8块，给惰性拆分留出余地
+            Index threads = static_cast<Index>(std::max(1, curThreadSize_.load()));
+            grain = static_cast<Index>((last - first) / (threads * 8));
+            if (grain < 1) grain = 1;
+        }
+
+        ForkJoinState<Index, Body> state(body, grain);
+        runSplit(&state, first, last);
+        state.join.done();
+        helpUntil(state.join);
+
+        if (state.error) std::rethrow_exception(state.error);
+    }
+
+    // 惰性二分：区间大于粒度时，若应当拆分就把后一半作为新任务交出，否则先做一个粒度块
+    template<typename Index, typename Body>
+    void runSplit(ForkJoinState<Index, Body>* st, Index b, Index e) {
+        while (e - b > st->grain) {
+            if (st->failed.load(std::memory_order_relaxed)) return;
+
+            if (shouldSplit()) {
+                Index mid = b + (e - b) / 2;
+                st->join.add();
+                if (trySpawn([this, st, mid, e]() {
+                        runSplit(st, mid, e);
+                        st->join.done();
+                    })) {
+                    e = mid;
+                    continue;
+                }
+                st->join.undo();  // 队列已满，继续在本线程处理
+            }
+
+            Index chunkEnd = b + st->grain;
+            runChunk(st, b, chunkEnd);
+            b = chunkEnd;
+        }
+        runChunk(st, b, e);
+    }
+
+    // 执行一个粒度块，只记录第一个异常，之后的块直接跳过
+    template<typename Index, typename Body>
+    static void runChunk(ForkJoinState<Index, Body>* st, Index b, Index e) {
+        if (st->failed.load(std::memory_order_relaxed)) return;
+        try {
+            st->body(b, e);
+        } catch (...) {
+            if (!st->failed.exchange(true)) {
+                st->error = std::current_exception();
+            }
+        }
+    }
+
+    // 是否应当拆分：工作窃取模式下本地队列已被偷空；其余情况排队任务少于线程数
+    bool shouldSplit() const {
+        Worker* self = currentWorker();
+        if (poolMode_ == PoolMode::MODE_WORK_STEALING && self != nullptr && self->pool == this) {
+            return self->localQue.empty();
+        }
+        return pendingTaskCount() < curThreadSize_;
+    }
+
+    // 当前线程调用trySpawn是否进入自己的本地队列：本地队列由所有者按LIFO取出（后投递的先执行），
+    // 需要按顺序执行的调用方应倒序投递
+    bool spawnsToLocalQueue() const {
+        Worker* self = currentWorker();
+        return poolMode_ == PoolMode::MODE_WORK_STEALING && self != nullptr && self->pool == this;
+    }
+
+    // 非阻塞地提交一个内部任务，队列满时返回false（由调用方自己执行）
+    bool trySpawn(Task&& task) {
+        Worker* self = currentWorker();
+        if (poolMode_ == PoolMode::MODE_WORK_STEALING && self != nullptr && self->pool == this) {
+            self->localQue.push(newTaskNode(std::move(task)));
+            detail::bumpCounter(self->stats.submitted);
+            wakeWorker();
+            return true;
+        }
+
+        if (queueMode_ == QueueMode::QUEUE_LOCK_FREE) {
+            if (!lockFreeQue_->tryPush(std::move(task))) return false;
+        } else {
+            std::lock_guard<std::mutex> lock(taskQueMtx_);
+            if (taskQue_.size() >= (size_t)taskQueMaxThreshHold_) return false;
+            taskQue_.emplace(std::move(task));
+            taskSize_++;
+        }
+        countSubmitted(1);
+        wakeWorker();
+        requestGrowth();
+        return true;
+    }
+
+    // 非阻塞地把内部任务投递到指定槽位的专属队列（不受容量限制，内部任务不可丢弃）
+    // 槽位无效或线程池关闭后槽位上已没有线程时返回false（由调用方自己执行）
+    bool trySpawnTo(int worker, Task&& task) {
+        if (worker < 0 || worker >= static_cast<int>(workers_.size())) return false;
+        return pushToWorker(worker, task, false) == SubmitStatus::SUBMIT_OK;
+    }
+
+    // 放入槽位的专属队列并唤醒该槽位的线程，失败时task保持不变
+    // 槽位上没有线程时先创建（见reviveWorker），线程池关闭后无法创建时返回SUBMIT_SHUTDOWN
+    SubmitStatus pushToWorker(int index, Task& task, bool bounded) {
+        Worker& w = *workers_[index];
+        for (;;) {
+            {
+                std::lock_guard<std::mutex> lock(w.inboxMtx);
+                if (w.live) {
+                    if (bounded && w.inbox.size() >= (size_t)taskQueMaxThreshHold_) {
+                        return SubmitStatus::SUBMIT_QUEUE_FULL;
+                    }
+                    w.inbox.emplace(detail::LaneItem<Task>{ std::move(task), detail::laneNowNs() });
+                    w.inboxSize.fetch_add(1, std::memory_order_relaxed);
+                    break;
+                }
+            }
+            if (!reviveWorker(index)) return SubmitStatus::SUBMIT_SHUTDOWN;
+        }
+        countSubmitted(1);
+        // 只有这个槽位的线程能取走任务：它在休眠就直接唤醒它，
+        // 否则它正在执行任务或找任务，之后会先检查专属队列
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (!idle_.notify(&w.waiter)) wakeIoPoller();
+        return SubmitStatus::SUBMIT_OK;
+    }
+
+    // 为没有线程的槽位创建线程：延迟启动时依次创建到该槽位为止，CACHED模式复用已回收的槽位
+    // 槽位已有线程时直接返回true；线程池已关闭（线程正在退出）时返回false
+    bool reviveWorker(int index) {
+        std::lock_guard<std::mutex> lock(taskQueMtx_);
+        {
+            std::lock_guard<std::mutex> inboxLock(workers_[index]->inboxMtx);
+            if (workers_[index]->live) return true;
+        }
+        if (!isPoolRunning_ || shuttingDown_.load(std::memory_order_relaxed)) return false;
+        int pending = lazyPending_.load(std::memory_order_relaxed);
+        int spawned = initThreadSize_ - pending;
+        if (index < initThreadSize_ && index >= spawned) {
+            for (int i = spawned; i <= index; i++) spawnWorker(i);
+            lazyPending_.store(pending - (index + 1 - spawned), std::memory_order_release);
+            return true;
+        }
+        auto it = std::find(freeSlots_.begin(), freeSlots_.end(), index);
+        if (it == freeSlots_.end()) return false;
+        freeSlots_.erase(it);
+        spawnWorker(index);
+        curThreadSize_++;
+        threadsCreated_.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    // 在当前线程上执行一个排队中的任务，没有任务时返回false
+    // 供等待子任务完成的线程（工作线程或外部线程）帮忙干活
+    bool runPendingTask() {
+        Task task;
+        Worker* self = currentWorker();
+        if (self != nullptr && self->pool != this) self = nullptr;
+
+        if (self != nullptr && popInbox(self, task)) {
+            // 专属队列的任务只有本线程能执行，等待中的任务可能正依赖它
+        } else if (poolMode_ == PoolMode::MODE_WORK_STEALING) {
+            Task* ptr = nullptr;
+            if (self != nullptr ? findTask(self, ptr)
+                : (popGlobal(nullptr, ptr) || stealTask(nullptr, ptr))) {
+                task = takeTaskNode(ptr);
+            } else if (self != nullptr || !popNode(-1, false, task)) {
+                return false;
+            }
+        } else {
+            bool found = self != nullptr
+                ? popFromNodes(self, task)
+                : (queueMode_ == QueueMode::QUEUE_LOCK_FREE ? popLockFree(task) : popLocked(task))
+                    || popNode(-1, false, task);
+            if (!found) return false;
+        }
+
+        if (task != nullptr) task();
+        if (self != nullptr) detail::bumpCounter(self->stats.executed);
+        else externalStats_[externalStripe()].executed.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    // 等待计数器归零，期间尽量帮忙执行任务；实在无事可做时短暂休眠后再检查
+    void helpUntil(JoinCounter& join) {
+        helpUntil([&]()->bool { return join.finished(); },
+            [&]() { join.waitFor(std::chrono::milliseconds(1)); });
+        join.wait();
+    }
+
+    // 通用的边干活边等待：done()为true时返回，连续找不到任务时调用waitBriefly()短暂阻塞
+    template<typename Done, typename WaitBriefly>
+    void helpUntil(Done done, WaitBriefly waitBriefly) {
+        int idleRounds = 0;
+        while (!done()) {
+            // 等待的结果可能来自I/O：没有线程收割时由等待方自己收割
+            if (runPendingTask() || pollIo()) {
+                idleRounds = 0;
+                continue;
+            }
+            if (++idleRounds < SPIN_PAUSE_COUNT) {
+                cpuRelax();
+                continue;
+            }
+            waitBriefly();
+        }
+    }
+
+    // Future在本线程池工作线程上阻塞等待时的回调（见FutureExecutor::helpWait）
+    static bool helpWaitFuture(void* ctx, detail::FutureStateBase* state) {
+        ThreadPool* pool = static_cast<ThreadPool*>(ctx);
+        Worker* self = currentWorker();
+        if (self == nullptr || self->pool != pool) return false;
+        pool->helpUntil([state]()->bool { return state->isReady(); },
+            [state]() { state->waitUntil(std::chrono::steady_clock::now() + std::chrono::milliseconds(1)); });
+        return true;
+    }
+
+    // 本线程池的续延调度器：Future::then()的回调经它回到线程池执行
+    FutureExecutor executor() {
+        FutureExecutor ex;
+        ex.post = &ThreadPool::postContinuation;
+        ex.helpWait = &ThreadPool::helpWaitFuture;
+        ex.ctx = this;
+        return ex;
+    }
+
+    // 投递续延：工作线程上进入本地队列；队列满或线程池已关闭时就地执行
+    static void postContinuation(void* ctx, TaskFunction&& task) {
+        ThreadPool* pool = static_cast<ThreadPool*>(ctx);
+        if (!pool->isPoolRunning_ || !pool->trySpawn(std::move(task))) {
+            task();
+        }
+    }
+
+#if defined(THREADPOOL_HAS_COROUTINES)
+    // spawn的驱动协程：切到工作线程，等待任务完成后写入promise，结束时自行销毁
+    // 先销毁任务的协程帧再写入结果，Future就绪时帧占用的内存已经归还
+    template<typename T>
+    static detail::CoDetached runSpawned(ThreadPool& pool, CoTask<T> task, Promise<T> promise) {
+        co_await pool.schedule();
+        try {
+            if constexpr (std::is_void<T>::value) {
+                co_await task;
+                task = CoTask<T>();
+                promise.set_value();
+            } else {
+                T value = co_await task;
+                task = CoTask<T>();
+                promise.set_value(std::move(value));
+            }
+        } catch (...) {
+            task = CoTask<T>();
+            promise.set_exception(std::current_exception());
+        }
+    }
+#endif
+
+    // 提交失败时返回的结果：get()抛出TaskRejectedError
+    template<typename RType>
+    Future<RType> submitFailed(SubmitStatus status) {
+        rejected_.fetch_add(1, std::memory_order_relaxed);
+        if (status == SubmitStatus::SUBMIT_TIMEOUT) {
+            POOL_LOG_WARN("等待任务队列空位超时，提交失败");
+        } else if (status == SubmitStatus::SUBMIT_SHUTDOWN) {
+            POOL_LOG_DEBUG("线程池已关闭，提交失败");
+        } else {
+            POOL_LOG_DEBUG("任务队列已满，提交失败");
+        }
+        Promise<RType> promise;
+        Future<RType> result = promise.get_future();
+        promise.set_exception(std::make_exception_ptr(TaskRejectedError(status)));
+        return result;
+    }
+
+    // 当前排队中的任务数（无锁后端为近似值）
+    int pendingTaskCount() const {
+        if (queueMode_ == QueueMode::QUEUE_LOCK_FREE) {
+            return static_cast<int>(lockFreeQue_->size());
+        }
+        return taskSize_;
+    }
+
+    // 无锁入队：先短暂自旋重试（drop-oldest时挤出所在通道的队头），仍满则按opts等待
+    // 失败时task保持不变
+    SubmitStatus pushLockFree(Task& task, TaskPriority priority, const EnqueueOptions& opts) {
+        const bool retry = opts.dropOldest || opts.wait > std::chrono::nanoseconds::zero();
+        for (int i = 0; i < SPIN_PAUSE_COUNT; i++) {
+            if (lockFreeQue_->tryPush(std::move(task), priority, opts.droppable)) return SubmitStatus::SUBMIT_OK;
+            if (!retry) return SubmitStatus::SUBMIT_QUEUE_FULL;
+            if (opts.dropOldest) {
+                Task victim;
+                bool droppable = false;
+                if (lockFreeQue_->tryPopLane(priority, victim, droppable)) {
+                    discardVictim(victim, droppable);
+                    continue;
+                }
+            }
+            cpuRelax();
+        }
+        if (opts.wait <= std::chrono::nanoseconds::zero()) return SubmitStatus::SUBMIT_QUEUE_FULL;
+
+        std::unique_lock<std::mutex> lock(taskQueMtx_);
+        bool ok = waitForSpace(lock, opts.wait,
+            [&]()->bool { return lockFreeQue_->tryPush(std::move(task), priority, opts.droppable); });
+        return ok ? SubmitStatus::SUBMIT_OK : SubmitStatus::SUBMIT_TIMEOUT;
+    }
+
+    // 出队后唤醒一个因队列满而阻塞的生产者（没有阻塞者时不加锁）
+    void notifyBlockedProducer() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (blockedProducers_.load(std::memory_order_relaxed) > 0) {
+            std::lock_guard<std::mutex> lock(taskQueMtx_);
+            notFull_.notify_one();
+        }
+    }
+
+    // 加锁后端取一个任务（队列为空时不加锁）
+    bool popLocked(Task& task) {
+        if (taskSize_ == 0) return false;
+
+        std::unique_lock<std::mutex> lock(taskQueMtx_);
+        POOL_LOG_TRACE("线程ID:%lu 尝试获取任务...", detail::poolThreadTag());
+        if (taskQue_.empty()) return false;
+
+        POOL_LOG_TRACE("线程ID:%lu 获取任务成功！", detail::poolThreadTag());
+
+        // 从队列取出任务（按优先级）
+        std::int64_t waitNs = 0;
+        taskQue_.pop(task, &waitNs);
+        taskSize_--;  // 原子计数减1
+        recordQueueWait(waitNs);
+
+        // 只在确有生产者阻塞时通知（队列有空位）
+        if (blockedProducers_ > 0) {
+            notFull_.notify_one();
+        }
+        return true;
+    }
+
+    // 无锁后端取一个任务
+    bool popLockFree(Task& task) {
+        std::int64_t waitNs = 0;
+        if (!lockFreeQue_->tryPop(task, &waitNs)) return false;
+        recordQueueWait(waitNs);
+        notifyBlockedProducer();
+        return true;
+    }
+
+    // 线程函数（FIXED/CACHED模式，加锁后端）
+    void threadFunc(int threadid, int index) {
+        Worker* self = workers_[index].get();
+        if (!nodeQues_.empty()) {
+            workerLoop(threadid, self, [this, self](Task& task) { return popFromNodes(self, task); });
+            return;
+        }
+        workerLoop(threadid, self,
+            [this](Task& task) { return popLocked(task); });
+    }
+
+    // 无锁后端的线程函数（FIXED/CACHED模式）
+    void lockFreeThreadFunc(int threadid, int index) {
+        Worker* self = workers_[index].get();
+        if (!nodeQues_.empty()) {
+            workerLoop(threadid, self, [this, self](Task& task) { return popFromNodes(self, task); });
+            return;
+        }
+        workerLoop(threadid, self,
+            [this](Task& task) { return popLockFree(task); });
+    }
+
+    // 工作线程的私有状态（本地队列仅工作窃取模式使用）
+    struct Worker {
+        Worker(ThreadPool* p, int idx)
+            : pool(p)
+            , index(idx)
+            , rng(0x9E3779B9u * static_cast<std::uint32_t>(idx + 1))
+        {}
+
+        ThreadPool* pool;                   // 所属线程池（区分同进程内多个线程池）
+        int index;                          // 在workers_中的槽位下标
+        WorkStealingQueue<Task*> localQue;  // 本地双端队列
+        std::uint32_t rng;                  // 选取窃取目标的随机数状态（xorshift32）
+        int node = 0;                       // 所在NUMA节点（线程池内编号）
+        std::vector<int> cpus;              // 绑定的CPU（为空表示不绑定）
+        TaskArena arena;                    // 任务临时内存（只由本线程使用）
+        WorkerStats stats;                  // 本线程的统计计数器（只由本线程写入）
+        std::int64_t dequeueNs = 0;         // 当前任务的出队时间（供任务跟踪使用）
+        std::atomic_bool busy{false};       // 正在执行任务（仅延迟启动时维护）
+        IdleRegistry::Waiter waiter;        // 休眠对象（submitTo据此唤醒指定线程）
+        std::mutex inboxMtx;                // 保护inbox和live
+        RingQueue<detail::LaneItem<Task>> inbox;  // submitTo指定给本槽位的任务（不可窃取）
+        std::atomic<size_t> inboxSize{0};   // inbox长度（无锁读取的近似值）
+        bool live = false;                  // 槽位上有线程（受inboxMtx保护）
+    };
+
+    // NUMA节点的注入队列（size为无锁读取的近似值）
+    struct alignas(CACHE_LINE_SIZE) NodeQueue {
+        std::mutex mtx;
+        RingQueue<detail::LaneItem<Task>> que;  // 任务 + 入队时间
+        std::atomic<size_t> size{0};
+    };
+
+    // FIXED/CACHED模式取任务：本节点队列 -> 全局队列 -> 其他节点队列
+    bool popFromNodes(Worker* self, Task& task) {
+        if (popNode(self->node, true, task)) return true;
+        bool found = queueMode_ == QueueMode::QUEUE_LOCK_FREE ? popLockFree(task) : popLocked(task);
+        return found || popNode(self->node, false, task);
+    }
+
+    // 记录一次入队：本线程池的工作线程计入自己的计数器，其他线程计入分片
+    void countSubmitted(size_t n) {
+        if (n == 0) return;
+        Worker* self = currentWorker();
+        if (self != nullptr && self->pool == this) {
+            detail::bumpCounter(self->stats.submitted, n);
+        } else {
+            externalStats_[externalStripe()].submitted.fetch_add(n, std::memory_order_relaxed);
+        }
+    }
+
+    // 记录出队任务的排队时间（只统计本线程池的工作线程取出的任务）
+    void recordQueueWait(std::int64_t waitNs) {
+        Worker* self = currentWorker();
+        if (self != nullptr && self->pool == this) {
+            self->stats.queueWait.record(static_cast<std::uint64_t>(waitNs < 0 ? 0 : waitNs));
+        }
+    }
+
+    // 已执行完的任务总数（供控制器估算吞吐）
+    unsigned long long executedTasks() const {
+        unsigned long long n = 0;
+        for (const auto& w : workers_) n += w->stats.executed.load(std::memory_order_relaxed);
+        for (const auto& ext : externalStats_) n += ext.executed.load(std::memory_order_relaxed);
+        return n;
+    }
+
+    // 非工作线程固定使用的计数器分片
+    static int externalStripe() {
+        static std::atomic_int next{0};
+        thread_local int stripe = next.fetch_add(1, std::memory_order_relaxed) % EXTERNAL_STATS_STRIPES;
+        return stripe;
+    }
+
+    // 逐页写入当前栈帧下方的一段栈空间
+    static void prefaultStack() {
+        volatile char stack[PREFAULT_STACK_SIZE];
+        for (std::size_t i = 0; i < sizeof(stack); i += TASK_ARENA_PAGE_SIZE) stack[i] = 0;
+    }
+
+    // 当前线程对应的Worker（非工作线程为nullptr）
+    static Worker*& currentWorker() {
+        thread_local Worker* worker = nullptr;
+        return worker;
+    }
+
+    // 是否还有待执行的任务（全局队列或任意本地队列非空）
+    bool hasPendingWork() const {
+        if (pendingTaskCount() > 0) return true;
+        if (nodeTaskSize_.load(std::memory_order_relaxed) > 0) return true;
+        if (poolMode_ != PoolMode::MODE_WORK_STEALING) return false;
+        for (const auto& w : workers_) {
+            if (!w->localQue.empty()) return true;
+        }
+        return false;
+    }
+
+    // 从本线程的专属队列取一个任务（为空时不加锁）
+    bool popInbox(Worker* self, Task& task) {
+        if (self->inboxSize.load(std::memory_order_relaxed) == 0) return false;
+        std::lock_guard<std::mutex> lock(self->inboxMtx);
+        if (self->inbox.empty()) return false;
+        detail::LaneItem<Task>& item = self->inbox.front();
+        task = std::move(item.task);
+        recordQueueWait(detail::laneNowNs() - item.enqueuedNs);
+        self->inbox.pop();
+        self->inboxSize.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    // 线程退出前关闭专属队列：仍有任务时返回false（线程应继续执行），
+    // 否则之后的submitTo会为该槽位重新创建线程
+    bool closeInbox(Worker* self) {
+        std::lock_guard<std::mutex> lock(self->inboxMtx);
+        if (!self->inbox.empty()) return false;
+        self->live = false;
+        return true;
+    }
+
+    // 是否有当前线程可以执行的任务（公共队列或自己的专属队列）
+    bool hasWorkFor(Worker* self) const {
+        return self->inboxSize.load(std::memory_order_relaxed) > 0 || hasPendingWork();
+    }
+
+    // 从全局注入队列批量取任务：返回一个，其余搬入本地队列供自己和他人窃取
+    // self为nullptr（非工作线程帮忙执行）时只取一个
+    bool popGlobal(Worker* self, Task*& task) {
+        if (pendingTaskCount() == 0) return false;  // 快速路径：不加锁
+
+        // 无锁后端：逐个出队搬运，无需持有taskQueMtx_
+        if (queueMode_ == QueueMode::QUEUE_LOCK_FREE) {
+            size_t batch = lockFreeQue_->size() / workers_.size() + 1;
+            if (batch > (size_t)WORK_STEALING_BATCH_SIZE) batch = WORK_STEALING_BATCH_SIZE;
+            if (self == nullptr) batch = 1;
+
+            Task t;
+            std::int64_t waitNs = 0;
+            if (!lockFreeQue_->tryPop(t, &waitNs)) return false;
+            recordQueueWait(waitNs);
+            task = newTaskNode(std::move(t));
+            Task* rest[WORK_STEALING_BATCH_SIZE];
+            size_t got = 1;
+            while (got < batch && lockFreeQue_->tryPop(t, &waitNs)) {
+                recordQueueWait(waitNs);
+                rest[got++] = newTaskNode(std::move(t));
+            }
+            for (size_t i = got; i-- > 1;) {
+                self->localQue.push(rest[i]);
+            }
+            notifyBlockedProducer();
+            return true;
+        }
+
+        std::unique_lock<std::mutex> lock(taskQueMtx_);
+        if (taskQue_.empty()) return false;
+
+        // 按线程数均分，避免一个线程把全局队列搬空
+        size_t batch = taskQue_.size() / workers_.size() + 1;
+        if (batch > (size_t)WORK_STEALING_BATCH_SIZE) batch = WORK_STEALING_BATCH_SIZE;
+        if (batch > taskQue_.size()) batch = taskQue_.size();
+        if (self == nullptr) batch = 1;
+
+        // 按优先级取出；本地队列是LIFO，先取出的（优先级高的）最后压入，最先被自己执行
+        Task t;
+        std::int64_t waitNs = 0;
+        taskQue_.pop(t, &waitNs);
+        recordQueueWait(waitNs);
+        task = newTaskNode(std::move(t));
+        Task* rest[WORK_STEALING_BATCH_SIZE];
+        for (size_t i = 1; i < batch; i++) {
+            taskQue_.pop(t, &waitNs);
+            recordQueueWait(waitNs);
+            rest[i] = newTaskNode(std::move(t));
+        }
+        for (size_t i = batch; i-- > 1;) {
+            self->localQue.push(rest[i]);
+        }
+        taskSize_ -= static_cast<int>(batch);
+
+        // 一次腾出多个空位，唤醒所有阻塞的生产者
+        if (blockedProducers_ > 0) {
+            notFull_.notify_all();
+        }
+        return true;
+    }
+
+    // 从随机选取的其他线程窃取任务（self为nullptr表示非工作线程）
+    // 按节点分组时，sameNode为true只窃取同节点线程，为false只窃取其他节点线程
+    bool stealTask(Worker* self, Task*& task, bool sameNode = true) {
+        size_t n = workers_.size();
+        if (n == 0 || (self != nullptr && n == 1)) return false;
+        bool grouped = self != nullptr && !nodeQues_.empty();
+        if (!grouped && !sameNode) return false;
+
+        // xorshift32 生成随机起点，依次尝试所有其他线程
+        thread_local std::uint32_t externalRng = 0x2545F491u;
+        std::uint32_t& rng = self != nullptr ? self->rng : externalRng;
+        std::uint32_t x = rng;
+        x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+        rng = x;
+        size_t start = x % n;
+
+        for (size_t i = 0; i < n; i++) {
+            Worker* victim = workers_[(start + i) % n].get();
+            if (victim == self) continue;
+            if (grouped && (victim->node == self->node) != sameNode) continue;
+            if (victim->localQue.steal(task)) {
+                if (self != nullptr) detail::bumpCounter(self->stats.steals);
+                return true;
+            }
+        }
+        if (self != nullptr) detail::bumpCounter(self->stats.failedSteals);
+        return false;
+    }
+
+    // 依次从本地队列、全局队列、其他线程获取任务
+    // 按节点分组时：本地队列 -> 本节点队列 -> 全局队列 -> 同节点线程 -> 其他节点队列 -> 其他节点线程
+    bool findTask(Worker* self, Task*& task) {
+        if (self->localQue.pop(task)) return true;
+        if (nodeQues_.empty()) {
+            if (popGlobal(self, task)) return true;
+            return stealTask(self, task);
+        }
+
+        Task t;
+        if (popNode(self->node, true, t)) {
+            task = newTaskNode(std::move(t));
+            return true;
+        }
+        if (popGlobal(self, task)) return true;
+        if (stealTask(self, task, true)) return true;
+        if (popNode(self->node, false, t)) {
+            task = newTaskNode(std::move(t));
+            return true;
+        }
+        return stealTask(self, task, false);
+    }
+
+    // 工作窃取模式的线程函数
+    void stealingThreadFunc(int threadid, int index) {
+        Worker* self = workers_[index].get();
+        workerLoop(threadid, self, [this, self](Task& task) {
+            Task* ptr = nullptr;
+            if (!findTask(self, ptr)) return false;
+            task = takeTaskNode(ptr);
+            return true;
+        });
+    }
+
+    // 休眠结果
+    enum class ParkResult {
+        PARK_RECHECK,  // 登记后发现已有任务，未真正休眠
+        PARK_WOKEN,    // 被提交方（或回收线程的控制器）唤醒
+        PARK_EXIT,     // 线程池已关闭且没有剩余任务
+    };
+
+    // 有新任务时唤醒一个休眠线程
+    // 已有线程在自旋找任务时不再唤醒：自旋线程会拿走任务，
+    // 最后一个自旋线程拿到任务后若还有剩余，再由它接力唤醒下一个
+    void wakeWorker() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (spawnLazily(1) > 0) return;  // 新线程启动后会取走任务
+        if (spinners_.load(std::memory_order_relaxed) > 0) return;
+        if (!idle_.notifyOne()) wakeIoPoller();
+    }
+
+    // 自适应自旋：自旋期间拿到任务则下次多转一会，落空则减半
+    template<typename TryGet>
+    bool spinForTask(TryGet& tryGet, Task& task, int& spinLimit) {
+        spinners_.fetch_add(1, std::memory_order_seq_cst);
+        for (int i = 0; i < spinLimit; i++) {
+            if (tryGet(task)) {
+                spinLimit = std::min(spinLimit * 2, IDLE_SPIN_MAX);
+                // 最后一个自旋线程离开时，若仍有任务则接力唤醒
+                if (spinners_.fetch_sub(1, std::memory_order_seq_cst) == 1) {
+                    std::atomic_thread_fence(std::memory_order_seq_cst);
+                    if (hasPendingWork()) idle_.notifyOne();
+                }
+                return true;
+            }
+            if (i < SPIN_PAUSE_COUNT) cpuRelax();
+            else std::this_thread::yield();
+        }
+        spinners_.fetch_sub(1, std::memory_order_seq_cst);
+        spinLimit = std::max(spinLimit / 2, IDLE_SPIN_MIN);
+        return false;
+    }
+
+    // 登记到空闲表后再检查一次，确认没有任务才挂起
+    ParkResult park(IdleRegistry::Waiter& waiter, Worker* self) {
+        ParkResult res;
+        if (parkInReactor(self, res)) return res;
+
+        idle_.enlist(&waiter);
+
+        if (hasWorkFor(self)) {
+            return idle_.cancel(&waiter) ? ParkResult::PARK_RECHECK : ParkResult::PARK_WOKEN;
+        }
+        if (!isPoolRunning_) {
+            idle_.cancel(&waiter);
+            return ParkResult::PARK_EXIT;
+        }
+
+        // 所有模式都无限等待；CACHED模式的回收由控制器唤醒空闲线程完成
+        std::int64_t parkedAt = detail::laneNowNs();
+        detail::bumpCounter(self->stats.parks);
+        idle_.wait(&waiter);
+        detail::bumpCounter(self->stats.wakeups);
+        detail::bumpCounter(self->stats.parkedNs, static_cast<unsigned long long>(detail::laneNowNs() - parkedAt));
+        return ParkResult::PARK_WOKEN;
+    }
+
+#if defined(THREADPOOL_HAS_IO_REACTOR)
+    // 不等待地收割一次I/O完成，返回是否投递了完成回调
+    bool pollIo() {
+        return reactor_ != nullptr && reactor_->poll(0) > 0;
+    }
+
+    // 没有线程阻塞在反应器上时，由当前线程代替登记空闲表、阻塞在反应器上等待：
+    // I/O完成或提交方找不到空闲线程可唤醒时（wakeIoPoller）返回
+    // 与wakeWorker的配对方式同park：先置位ioPollerParked_再检查任务，提交方先入队再检查标记
+    bool parkInReactor(Worker* self, ParkResult& res) {
+        if (reactor_ == nullptr || ioPollerParked_.exchange(true, std::memory_order_seq_cst)) return false;
+        if (hasWorkFor(self)) {
+            res = ParkResult::PARK_RECHECK;
+        } else if (!isPoolRunning_) {
+            res = ParkResult::PARK_EXIT;
+        } else {
+            std::int64_t parkedAt = detail::laneNowNs();
+            detail::bumpCounter(self->stats.parks);
+            reactor_->poll(-1);
+            detail::bumpCounter(self->stats.wakeups);
+            detail::bumpCounter(self->stats.parkedNs, static_cast<unsigned long long>(detail::laneNowNs() - parkedAt));
+            res = ParkResult::PARK_WOKEN;
+        }
+        ioPollerParked_.store(false, std::memory_order_seq_cst);
+        return true;
+    }
+
+    void wakeIoPoller() {
+        if (reactor_ != nullptr && ioPollerParked_.load(std::memory_order_seq_cst)) reactor_->wake();
+    }
+#else
+    bool pollIo() { return false; }
+    bool parkInReactor(Worker*, ParkResult&) { return false; }
+    void wakeIoPoller() {}
+#endif
+
+    // 通用工作循环：取任务 -> 自旋 -> 休眠，tryGet由各模式提供
+    template<typename TryGet>
+    void workerLoop(int threadid, Worker* self, TryGet tryGet) {
+        currentWorker() = self;
+        if (!self->cpus.empty()) pinCurrentThread(self->cpus);
+        if (prefault_) {
+            prefaultStack();
+            self->arena.prefault();
+        }
+        IdleRegistry::Waiter& waiter = self->waiter;  // 本线程的休眠对象
+        int spinLimit = IDLE_SPIN_MIN;  // 当前自旋次数
+        bool woken = false;             // 上一次休眠是否被唤醒
+        int ioTick = 0;                 // 距上次顺带收割I/O完成执行的任务数
+        // 专属队列优先，其次是各模式的公共队列
+        auto get = [this, self, &tryGet](Task& task) { return popInbox(self, task) || tryGet(task); };
+
+        for (;;) {
+            Task task;
+
+            if (!get(task) && !spinForTask(get, task, spinLimit)) {
+                // 休眠前先收割I/O完成，投递出的回调由本线程接着取走执行
+                if (pollIo()) continue;
+
+                // 被唤醒后却没有拿到任务，记为一次无效唤醒
+                if (woken) {
+                    detail::bumpCounter(self->stats.spuriousWakeups);
+                }
+
+                // 控制器要求回收线程：休眠前和被唤醒后各认领一次
+                if (retireRequests_.load(std::memory_order_relaxed) > 0 && retireThread(threadid, self)) {
+                    currentWorker() = nullptr;
+                    return;
+                }
+
+                ParkResult res = park(waiter, self);
+                woken = (res == ParkResult::PARK_WOKEN);
+                if (res == ParkResult::PARK_EXIT) {
+                    if (!closeInbox(self)) continue;  // 退出前又有专属任务
+                    currentWorker() = nullptr;
+                    exitThread(threadid);
+                    return;
+                }
+                if (woken && retireRequests_.load(std::memory_order_relaxed) > 0
+                    && retireThread(threadid, self)) {
+                    currentWorker() = nullptr;
+                    return;
+                }
+                continue;
+            }
+            woken = false;
+
+            // SHUTDOWN_ABORT：取到的用户任务直接丢弃，尽快排空队列；
+            // 内部任务（分块、驱动任务、续延、协程恢复等）照常执行，等待它们的一方才能返回
+            if (aborting_.load(std::memory_order_relaxed) && task.droppable()) {
+                task = nullptr;
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+
+            // 执行任务（在锁外执行）
+            if (poolMode_ == PoolMode::MODE_CACHED) idleThreadSize_--;
+            if (lazyStart_) self->busy.store(true, std::memory_order_relaxed);
+            std::int64_t startNs = detail::laneNowNs();
+            self->dequeueNs = startNs;
+            if (task != nullptr) {
+                task();  // 执行函数对象
+            }
+            task = nullptr;  // 先销毁任务（其捕获的对象可能引用arena内存），再回收arena
+            self->stats.runTime.record(static_cast<std::uint64_t>(detail::laneNowNs() - startNs));
+            detail::bumpCounter(self->stats.executed);
+            if (self->arena.autoReset()) self->arena.reset();
+            if (lazyStart_) self->busy.store(false, std::memory_order_relaxed);
+            if (poolMode_ == PoolMode::MODE_CACHED) idleThreadSize_++;
+            if (++ioTick == IO_POLL_INTERVAL) {
+                ioTick = 0;
+                pollIo();  // 持续忙碌时也不让I/O完成一直积压
+            }
+        }
+    }
+
+    // 线程池关闭：移出线程表并通知shutdown（由shutdown join）
+    void exitThread(int threadid) {
+        std::lock_guard<std::mutex> lock(taskQueMtx_);
+        detachSelf(threadid);
+        POOL_LOG_DEBUG("线程ID:%lu 退出！", detail::poolThreadTag());
+        exitCond_.notify_all();  // 通知shutdown
+    }
+
+    // 把当前线程的Thread对象从线程表移到待回收表（调用方持有taskQueMtx_）：线程不能join自己
+    void detachSelf(int threadid) {
+        auto it = threads_.find(threadid);
+        if (it == threads_.end()) return;
+        exitedThreads_.push_back(std::move(it->second));
+        threads_.erase(it);
+    }
+
+    // 认领一个回收请求并退出（CACHED模式），返回true表示当前线程应退出
+    // 仍有待执行任务或线程数已降到初始值时放弃本次回收
+    bool retireThread(int threadid, Worker* self) {
+        int requests = retireRequests_.load(std::memory_order_relaxed);
+        do {
+            if (requests <= 0) return false;
+        } while (!retireRequests_.compare_exchange_weak(requests, requests - 1, std::memory_order_acq_rel));
+
+        std::vector<std::unique_ptr<Thread>> reaped;  // 先前回收的线程，释放锁后在这里join
+        std::lock_guard<std::mutex> lock(taskQueMtx_);
+        if (curThreadSize_ <= initThreadSize_ || hasPendingWork() || !closeInbox(self)) return false;
+        reaped.swap(exitedThreads_);
+        detachSelf(threadid);  // 移出线程表
+        freeSlots_.push_back(self->index);  // 归还槽位
+        self->arena.release();  // 块由之后复用槽位的线程重新申请（落在新线程的节点上）
+        curThreadSize_--;    // 当前线程数减1
+        idleThreadSize_--;  // 空闲数减1
+        threadsRetired_.fetch_add(1, std::memory_order_relaxed);
+        POOL_LOG_DEBUG("线程ID:%lu 因空闲被回收退出！", detail::poolThreadTag());
+        exitCond_.notify_all();
+        return true;
+    }
+
+    // 线程槽位数：CACHED模式按最大线程数预留
+    int workerSlots() const {
+        if (poolMode_ == PoolMode::MODE_CACHED && threadSizeThreshHold_ > initThreadSize_) {
+            return threadSizeThreshHold_;
+        }
+        return initThreadSize_;
+    }
+
+    // 检查线程池是否在运行
+    bool checkRunningState() const {
+        return isPoolRunning_;
+    }
+
+private:
+    // 线程列表（使用线程ID映射管理）
+    std::unordered_map<int, std::unique_ptr<Thread>> threads_;
+    int nextThreadId_ = 0;  // 下一个线程ID（受taskQueMtx_保护）
+    // 已退出、尚未join的线程（受taskQueMtx_保护），由shutdown或下一个被回收的线程join
+    std::vector<std::unique_ptr<Thread>> exitedThreads_;
+
+    // 初始线程数量
+    int initThreadSize_;
+    // 线程数量上限阈值
+    int threadSizeThreshHold_;
+    // 当前线程总数（原子操作）
+    std::atomic_int curThreadSize_;
+    // 空闲线程数量（原子操作）
+    std::atomic_int idleThreadSize_;
+
+    // 任务队列相关
+    LaneQueue<Task> taskQue_;           // 任务队列（按优先级分通道）
+    std::atomic_int taskSize_;          // 当前任务数
+    int taskQueMaxThreshHold_;          // 任务队列最大容量
+
+    // 同步机制
+    std::mutex taskQueMtx_;              // 任务队列互斥锁
+    std::condition_variable notFull_;    // 队列未满条件变量
+    std::condition_variable exitCond_;   // 线程退出通知条件变量
+    std::atomic_int blockedProducers_{0};  // 因队列满而阻塞的提交者数
+    // 队列满时的处理策略
+    OverflowPolicy overflowPolicy_ = OverflowPolicy::OVERFLOW_BLOCK;
+    std::chrono::milliseconds blockTimeout_ = SUBMIT_BLOCK_DEFAULT_TIMEOUT;
+    std::atomic<unsigned long long> rejected_{0};   // 提交失败的任务数
+    std::atomic<unsigned long long> dropped_{0};    // drop-oldest丢弃的任务数
+    std::atomic<unsigned long long> callerRan_{0};  // caller-runs就地执行的任务数
+
+    // 运行模式
+    PoolMode poolMode_;
+    // 任务队列后端
+    QueueMode queueMode_;
+
+    // 无锁后端相关
+    std::unique_ptr<LockFreeLaneQueue<Task>> lockFreeQue_;  // 无锁环形任务队列（按优先级分通道）
+
+    // CPU绑定与NUMA分组
+    AffinityMode affinityMode_;
+    CpuTopology topology_;      // 节点与CPU布局
+    bool topologySet_;          // 拓扑是否由用户指定
+    std::vector<std::unique_ptr<NodeQueue>> nodeQues_;  // 每个节点的注入队列（多节点时才创建）
+    std::atomic_int nodeTaskSize_{0};                   // 各节点队列中的任务总数
+    // 线程池运行状态（原子标记）
+    std::atomic_bool isPoolRunning_;
+    std::atomic_bool shuttingDown_{false};  // 已调用shutdown：拒绝外部提交
+    std::atomic_bool aborting_{false};      // SHUTDOWN_ABORT：丢弃尚未开始的任务
+    bool lazyStart_ = false;                // 是否延迟创建初始线程
+    bool prefault_ = false;                 // 线程启动时是否预热栈和arena
+    std::atomic_int lazyPending_{0};        // 延迟启动时尚未创建的初始线程数
+
+    // 线程槽位
+    std::vector<std::unique_ptr<Worker>> workers_;  // 每个线程槽位的私有状态
+    std::vector<int> freeSlots_;                    // CACHED模式空闲槽位（受taskQueMtx_保护）
+
+    // CACHED模式弹性伸缩控制器
+    ElasticPolicy elastic_;
+    std::thread controller_;
+    std::mutex ctrlMtx_;
+    std::condition_variable ctrlCond_;
+    bool ctrlStop_ = false;                    // 受ctrlMtx_保护
+    std::atomic_bool ctrlPoked_{false};        // 提交方已通知、控制器尚未处理
+    std::atomic_int retireRequests_{0};        // 待认领的回收请求数
+
+    // 空闲线程登记表（精准唤醒单个休眠线程）
+    IdleRegistry idle_;
+    // 正在自旋找任务的线程数
+    std::atomic_int spinners_{0};
+    // 统计：非工作线程的计数器分片，CACHED模式线程增减（在taskQueMtx_内修改）
+    ExternalStats externalStats_[EXTERNAL_STATS_STRIPES];
+    std::atomic<unsigned long long> threadsCreated_{0};
+    std::atomic<unsigned long long> threadsRetired_{0};
+    // 任务跟踪：tracer_创建后一直保留到线程池销毁（已包装的任务持有其指针）
+    std::unique_ptr<TaskTracer> tracer_;
+    std::atomic<TaskTracer*> activeTracer_{nullptr};  // 为空表示未开启跟踪
+#if defined(THREADPOOL_HAS_IO_REACTOR)
+    // I/O反应器（不拥有）与是否已有线程阻塞在反应器上
+    IoReactor* reactor_ = nullptr;
+    std::atomic_bool ioPollerParked_{false};
+#endif
+    // 定时任务：时间轮（受timerMtx_保护）和推进它的定时器线程（第一次有定时器时创建）
+    TimerWheel timers_;
+    std::thread timerThread_;
+    std::mutex timerMtx_;
+    std::condition_variable timerCond_;
+    bool timerStop_ = false;                                    // 受timerMtx_保护
+    std::uint64_t timerWakeTick_ = TimerWheel::NO_TICK;         // 定时器线程计划醒来的tick（0表示正在处理）
+    std::chrono::steady_clock::time_point timerOrigin_ = std::chrono::steady_clock::now();  // tick 0
+    std::atomic<unsigned long long> timersFired_{0};            // 已到期的定时任务
+    std::atomic<unsigned long long> expired_{0};                // 过了截止时间而跳过的任务
+    // 任务组：每组当前一轮的取消状态（cancelGroup后移除，下次提交时重新创建）
+    std::mutex groupMtx_;
+    std::unordered_map<GroupId, std::shared_ptr<detail::CancelState>> groups_;  // 受groupMtx_保护
+    std::size_t groupSweepAt_ = GROUP_SWEEP_MIN;
+    std::atomic<unsigned long long> cancelled_{0};              // 被取消而跳过的任务
+    // 多租户：各租户的队列（受tenantMtx_保护，统计可无锁读取）和在途的轮转任务数
+    std::mutex tenantMtx_;
+    std::condition_variable tenantNotFull_;
+    TenantQueue<Task> tenants_;
+    int tenantPumps_ = 0;                                       // 受tenantMtx_保护
+    int tenantBlocked_ = 0;                                     // 因租户队列满而等待的提交者（受tenantMtx_保护）
+};
+
+inline bool TimerHandle::cancel() const {
+    return valid() && pool_->cancelTimer(id_);
+}
 #endif
\ No newline at end of file
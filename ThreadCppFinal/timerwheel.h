@@ -0,0 +1,270 @@
+#ifndef TIMERWHEEL_H
+#define TIMERWHEEL_H
+
+#include<chrono>
+#include<cstdint>
+#include<cstddef>
+#include<deque>
+#include<utility>
+
+#include"taskfunction.h"
+#include"lanequeue.h"
+
+// 分层时间轮：每层64个槽，共4层，1个tick为1毫秒，可直接容纳约4.6小时内的定时器；
+// 更远的定时器先挂在最高层，转到时按剩余时间重新放置
+const int TIMER_WHEEL_BITS = 6;
+const int TIMER_WHEEL_SLOTS = 1 << TIMER_WHEEL_BITS;
+const int TIMER_WHEEL_LEVELS = 4;
+const std::chrono::milliseconds TIMER_TICK{1};
+
+// 定时器编号：低32位为节点下标+1，高32位为节点的代数（节点复用后旧编号失效），0表示无效
+using TimerId = std::uint64_t;
+
+// 时间轮节点（由TimerWheel统一分配，地址在时间轮销毁前保持不变）
+struct TimerNode {
+    enum State : std::uint8_t {
+        TIMER_FREE,     // 空闲
+        TIMER_PENDING,  // 挂在时间轮上
+        TIMER_RUNNING,  // 已到期、由调用方处理中（周期定时器执行期间保持此状态）
+    };
+
+    std::uint64_t expiry = 0;  // 到期tick
+    std::uint64_t period = 0;  // 周期（tick），0为一次性
+    TaskFunction fn;
+    TaskPriority priority = TaskPriority::PRIORITY_NORMAL;
+    State state = TIMER_FREE;
+    bool cancelled = false;     // RUNNING期间被取消：处理完后由调用方释放
+    std::uint32_t index = 0;
+    std::uint32_t generation = 0;
+    TimerNode* prev = nullptr;  // 槽内双向链表（空闲时next串起空闲链表）
+    TimerNode* next = nullptr;
+    TimerNode** head = nullptr; // 所在槽的表头
+};
+
+// 非线程安全，由调用方加锁；插入、取消都是O(1)，推进时间只处理到期槽和进位的槽
+// 节点放置（base为下一个要处理的tick，delta = expiry - base）：
+//   delta < 64 放第0层expiry所在槽，delta < 64^2 放第1层，依此类推；
+//   第L层的槽在tick的低6L位全为0时整体下放（高层先于低层），下放时的delta一定落在下一层
+class TimerWheel {
+public:
+    static constexpr std::uint64_t NO_TICK = ~std::uint64_t(0);
+
+    TimerWheel() {
+        for (int l = 0; l < TIMER_WHEEL_LEVELS; l++) {
+            occupied_[l] = 0;
+            for (int s = 0; s < TIMER_WHEEL_SLOTS; s++) slots_[l][s] = nullptr;
+        }
+    }
+
+    TimerWheel(const TimerWheel&) = delete;
+    TimerWheel& operator=(const TimerWheel&) = delete;
+
+    // 下一个要处理的tick（小于它的都已处理）
+    std::uint64_t base() const {
+        return base_;
+    }
+
+    // 挂在时间轮上的定时器数
+    std::size_t pending() const {
+        return pending_;
+    }
+
+    // 已分配（挂起或处理中）的定时器数
+    std::size_t size() const {
+        return live_;
+    }
+
+    // 分配一个节点，由调用方填写expiry / period / fn / priority后insert
+    TimerNode* allocate() {
+        TimerNode* node = freeList_;
+        if (node != nullptr) {
+            freeList_ = node->next;
+        } else {
+            nodes_.emplace_back();
+            node = &nodes_.back();
+            node->index = static_cast<std::uint32_t>(nodes_.size() - 1);
+        }
+        node->next = nullptr;
+        node->cancelled = false;
+        node->state = TimerNode::TIMER_RUNNING;
+        live_++;
+        return node;
+    }
+
+    static TimerId idOf(const TimerNode* node) {
+        return (static_cast<TimerId>(node->generation) << 32) | (node->index + 1);
+    }
+
+    // 按编号查找仍然有效的节点，已释放或编号无效时返回nullptr
+    TimerNode* find(TimerId id) {
+        std::uint64_t slot = id & 0xffffffffu;
+        if (slot == 0 || slot > nodes_.size()) return nullptr;
+        TimerNode* node = &nodes_[slot - 1];
+        if (node->state == TimerNode::TIMER_FREE || node->generation != static_cast<std::uint32_t>(id >> 32)) {
+            return nullptr;
+        }
+        return node;
+    }
+
+    // 把节点挂到时间轮上（已过期的节点在下一个tick触发）
+    void insert(TimerNode* node) {
+        std::uint64_t when = node->expiry > base_ ? node->expiry : base_;
+        std::uint64_t delta = when - base_;
+        int level = 0;
+        while (level < TIMER_WHEEL_LEVELS - 1
+            && delta >= (std::uint64_t(1) << (TIMER_WHEEL_BITS * (level + 1)))) {
+            level++;
+        }
+        std::uint64_t range = std::uint64_t(1) << (TIMER_WHEEL_BITS * TIMER_WHEEL_LEVELS);
+        if (delta >= range) when = base_ + range - 1;  // 超出范围：先挂在最高层最远的槽
+        int slot = static_cast<int>((when >> (TIMER_WHEEL_BITS * level)) & (TIMER_WHEEL_SLOTS - 1));
+        link(node, level, slot);
+        node->state = TimerNode::TIMER_PENDING;
+        pending_++;
+    }
+
+    // 从时间轮上摘下挂起的节点（节点转为RUNNING，由调用方释放或重新insert）
+    void remove(TimerNode* node) {
+        unlink(node);
+        node->state = TimerNode::TIMER_RUNNING;
+        pending_--;
+    }
+
+    // 释放节点，返回其中的任务（调用方在锁外销毁，避免在锁内运行捕获对象的析构）
+    TaskFunction release(TimerNode* node) {
+        if (node->state == TimerNode::TIMER_PENDING) remove(node);
+        TaskFunction fn(std::move(node->fn));
+        node->fn = nullptr;
+        node->state = TimerNode::TIMER_FREE;
+        node->generation++;
+        node->next = freeList_;
+        freeList_ = node;
+        live_--;
+        return fn;
+    }
+
+    // 处理到now（含）为止的所有tick，每个到期节点摘下后调用onExpire(node)（节点为RUNNING状态）
+    template<typename OnExpire>
+    void advance(std::uint64_t now, OnExpire&& onExpire) {
+        while (base_ <= now) {
+            if (pending_ == 0) {
+                base_ = now + 1;
+                return;
+            }
+            std::uint64_t t = base_;
+            std::uint64_t low = t & (TIMER_WHEEL_SLOTS - 1);
+            if (low != 0 && (occupied_[0] >> low) == 0) {
+                // 本轮第0层已没有定时器：直接跳到下一轮的进位点
+                std::uint64_t next = t - low + TIMER_WHEEL_SLOTS;
+                base_ = next <= now ? next : now + 1;
+                continue;
+            }
+            if (low == 0) {
+                for (int l = TIMER_WHEEL_LEVELS - 1; l >= 1; l--) {
+                    std::uint64_t mask = (std::uint64_t(1) << (TIMER_WHEEL_BITS * l)) - 1;
+                    if ((t & mask) == 0) {
+                        cascade(l, static_cast<int>((t >> (TIMER_WHEEL_BITS * l)) & (TIMER_WHEEL_SLOTS - 1)));
+                    }
+                }
+            }
+            TimerNode* node = detach(0, static_cast<int>(low));
+            base_ = t + 1;
+            while (node != nullptr) {
+                TimerNode* next = node->next;
+                node->state = TimerNode::TIMER_RUNNING;
+                pending_--;
+                onExpire(node);
+                node = next;
+            }
+        }
+    }
+
+    // 下一次需要推进时间的tick（没有挂起的定时器时返回NO_TICK）
+    // 本轮第0层有定时器时是最近的那个；否则是下一轮的进位点（更高层的定时器在那时下放）
+    std::uint64_t nextTick() const {
+        if (pending_ == 0) return NO_TICK;
+        std::uint64_t low = base_ & (TIMER_WHEEL_SLOTS - 1);
+        std::uint64_t round = base_ - low;
+        bool higher = false;
+        for (int l = 1; l < TIMER_WHEEL_LEVELS; l++) higher = higher || occupied_[l] != 0;
+        if (low == 0 && higher) return base_;  // 处在进位点上，本tick先要下放高层的槽
+        std::uint64_t ahead = occupied_[0] >> low;
+        if (ahead != 0) return base_ + static_cast<std::uint64_t>(__builtin_ctzll(ahead));
+        std::uint64_t next = round + TIMER_WHEEL_SLOTS;
+        if (!higher && occupied_[0] != 0) return next + static_cast<std::uint64_t>(__builtin_ctzll(occupied_[0]));
+        return next;
+    }
+
+    // 摘下所有挂起的节点，逐个调用onNode(node)（用于关闭时清理）
+    template<typename OnNode>
+    void drain(OnNode&& onNode) {
+        for (int l = 0; l < TIMER_WHEEL_LEVELS; l++) {
+            for (int s = 0; s < TIMER_WHEEL_SLOTS; s++) {
+                TimerNode* node = detach(l, s);
+                while (node != nullptr) {
+                    TimerNode* next = node->next;
+                    node->state = TimerNode::TIMER_RUNNING;
+                    pending_--;
+                    onNode(node);
+                    node = next;
+                }
+            }
+        }
+    }
+
+private:
+    void link(TimerNode* node, int level, int slot) {
+        TimerNode** head = &slots_[level][slot];
+        node->head = head;
+        node->prev = nullptr;
+        node->next = *head;
+        if (*head != nullptr) (*head)->prev = node;
+        *head = node;
+        occupied_[level] |= std::uint64_t(1) << slot;
+    }
+
+    void unlink(TimerNode* node) {
+        if (node->prev != nullptr) node->prev->next = node->next;
+        else *node->head = node->next;
+        if (node->next != nullptr) node->next->prev = node->prev;
+        if (*node->head == nullptr) clearBit(node->head);
+        node->prev = node->next = nullptr;
+        node->head = nullptr;
+    }
+
+    // 由表头地址换算出层和槽，清除占用位
+    void clearBit(TimerNode** head) {
+        std::ptrdiff_t pos = head - &slots_[0][0];
+        occupied_[pos / TIMER_WHEEL_SLOTS] &= ~(std::uint64_t(1) << (pos % TIMER_WHEEL_SLOTS));
+    }
+
+    // 整槽摘下，返回链表头（节点的next仍串在一起）
+    TimerNode* detach(int level, int slot) {
+        TimerNode* list = slots_[level][slot];
+        if (list == nullptr) return nullptr;
+        slots_[level][slot] = nullptr;
+        occupied_[level] &= ~(std::uint64_t(1) << slot);
+        return list;
+    }
+
+    // 把第level层的slot槽下放到低层（按剩余时间重新放置）
+    void cascade(int level, int slot) {
+        TimerNode* node = detach(level, slot);
+        while (node != nullptr) {
+            TimerNode* next = node->next;
+            pending_--;
+            insert(node);
+            node = next;
+        }
+    }
+
+    TimerNode* slots_[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS];
+    std::uint64_t occupied_[TIMER_WHEEL_LEVELS];  // 每层非空槽的位图
+    std::deque<TimerNode> nodes_;                 // 节点存储（deque追加时已有元素地址不变）
+    TimerNode* freeList_ = nullptr;
+    std::uint64_t base_ = 0;
+    std::size_t pending_ = 0;
+    std::size_t live_ = 0;
+};
+
+#endif
@@ -0,0 +1,148 @@
+#ifndef TOPOLOGY_H
+#define TOPOLOGY_H
+
+#include<vector>
+#include<string>
+#include<fstream>
+#include<sstream>
+#include<thread>
+#include<cstdlib>
+
+#if defined(__linux__)
+#include<sched.h>
+#include<pthread.h>
+#include<unistd.h>
+#include<sys/syscall.h>
+#endif
+
+// CPU/NUMA拓扑：每个NUMA节点及其（当前进程允许使用的）CPU编号
+// Linux下读取 /sys/devices/system/node，不依赖libnuma；
+// 其他平台或读取失败时视为单节点，CPU为 0..hardware_concurrency-1
+// 线程池内的节点编号为nodes的下标（连续，从0开始），ids保存对应的系统节点编号
+struct CpuTopology {
+    std::vector<std::vector<int>> nodes;  // nodes[n] 为节点n上的CPU列表
+    std::vector<int> ids;                 // ids[n] 为节点n的系统节点编号
+
+    int nodeCount() const {
+        return static_cast<int>(nodes.size());
+    }
+
+    // CPU所在节点（未知时返回-1）
+    int nodeOfCpu(int cpu) const {
+        for (int n = 0; n < nodeCount(); n++) {
+            for (int c : nodes[n]) {
+                if (c == cpu) return n;
+            }
+        }
+        return -1;
+    }
+
+    // 系统节点编号对应的下标（不存在时返回-1）
+    int indexOfNode(int systemId) const {
+        for (int n = 0; n < nodeCount(); n++) {
+            if (ids[n] == systemId) return n;
+        }
+        return -1;
+    }
+
+    // 探测本机拓扑
+    static CpuTopology detect() {
+        CpuTopology topo;
+#if defined(__linux__)
+        cpu_set_t allowed;
+        CPU_ZERO(&allowed);
+        bool haveMask = sched_getaffinity(0, sizeof(allowed), &allowed) == 0;
+
+        std::vector<int> online = parseList(readFile("/sys/devices/system/node/online"));
+        for (int node : online) {
+            std::vector<int> cpus = parseList(readFile(
+                "/sys/devices/system/node/node" + std::to_string(node) + "/cpulist"));
+            std::vector<int> usable;
+            for (int c : cpus) {
+                if (!haveMask || (c < CPU_SETSIZE && CPU_ISSET(c, &allowed))) usable.push_back(c);
+            }
+            // 没有可用CPU的节点（纯内存节点或被cgroup排除）不参与调度
+            if (!usable.empty()) {
+                topo.nodes.push_back(std::move(usable));
+                topo.ids.push_back(node);
+            }
+        }
+#endif
+        if (topo.nodes.empty()) {
+            int n = static_cast<int>(std::thread::hardware_concurrency());
+            if (n <= 0) n = 1;
+            topo.nodes.emplace_back();
+            topo.ids.push_back(0);
+            for (int c = 0; c < n; c++) topo.nodes[0].push_back(c);
+        }
+        return topo;
+    }
+
+    // 解析 "0-3,8-11" 格式的编号列表
+    static std::vector<int> parseList(const std::string& text) {
+        std::vector<int> result;
+        std::stringstream ss(text);
+        std::string item;
+        while (std::getline(ss, item, ',')) {
+            if (item.empty() || item[0] < '0' || item[0] > '9') continue;
+            char* end = nullptr;
+            long lo = std::strtol(item.c_str(), &end, 10);
+            long hi = lo;
+            if (*end == '-') hi = std::strtol(end + 1, nullptr, 10);
+            for (long v = lo; v <= hi; v++) result.push_back(static_cast<int>(v));
+        }
+        return result;
+    }
+
+private:
+    static std::string readFile(const std::string& path) {
+        std::ifstream in(path);
+        std::string line;
+        std::getline(in, line);
+        return line;
+    }
+};
+
+// 把当前线程绑定到给定CPU集合，成功返回true（非Linux平台不做任何事）
+inline bool pinCurrentThread(const std::vector<int>& cpus) {
+#if defined(__linux__)
+    if (cpus.empty()) return false;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int c : cpus) {
+        if (c >= 0 && c < CPU_SETSIZE) CPU_SET(c, &set);
+    }
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    (void)cpus;
+    return false;
+#endif
+}
+
+// 当前线程正在运行的CPU（未知时返回-1）
+inline int currentCpu() {
+#if defined(__linux__)
+    return sched_getcpu();
+#else
+    return -1;
+#endif
+}
+
+// 地址所在页面当前位于哪个NUMA节点（系统节点编号，未知或页面尚未分配时返回-1）
+// 直接调用get_mempolicy系统调用（MPOL_F_NODE | MPOL_F_ADDR），不依赖libnuma
+inline int memoryNodeOf(const void* addr) {
+#if defined(__linux__) && defined(SYS_get_mempolicy)
+    const unsigned long MPOL_F_NODE_ = 1;
+    const unsigned long MPOL_F_ADDR_ = 2;
+    int node = -1;
+    if (syscall(SYS_get_mempolicy, &node, nullptr, 0UL,
+            const_cast<void*>(addr), MPOL_F_NODE_ | MPOL_F_ADDR_) == 0) {
+        return node;
+    }
+#else
+    (void)addr;
+#endif
+    return -1;
+}
+
+#endif
@@ -0,0 +1,151 @@
+#ifndef WORKSTEALINGQUEUE_H
+#define WORKSTEALINGQUEUE_H
+
+#include<atomic>
+#include<vector>
+#include<memory>
+#include<cstdint>
+#include<type_traits>
+
+// 缓存行大小（用于隔离热点原子变量，避免伪共享）
+constexpr std::size_t CACHE_LINE_SIZE = 64;
+
+// Chase-Lev 工作窃取双端队列
+// 参考: Lê, Pop, Cohen, Nardelli,
+//      "Correct and Efficient Work-Stealing for Weak Memory Models" (PPoPP'13)
+// 约定：
+//   - push/pop 只能由拥有者线程调用（操作 bottom 端，LIFO，缓存更热）
+//   - steal 可由任意线程并发调用（操作 top 端，FIFO）
+//   - 元素以原子方式读写，因此 T 必须可平凡拷贝（通常存放任务指针）
+template<typename T>
+class WorkStealingQueue {
+    static_assert(std::is_trivially_copyable<T>::value,
+        "WorkStealingQueue 只能存放可平凡拷贝的类型（如指针）");
+
+public:
+    explicit WorkStealingQueue(std::int64_t capacity = 256)
+        : top_(0)
+        , bottom_(0)
+    {
+        // 容量取不小于capacity的2的幂，便于用掩码取模
+        std::int64_t cap = 1;
+        while (cap < capacity) cap <<= 1;
+        auto arr = std::make_unique<Array>(cap);
+        array_.store(arr.get(), std::memory_order_relaxed);
+        garbage_.emplace_back(std::move(arr));
+    }
+
+    ~WorkStealingQueue() = default;
+
+    WorkStealingQueue(const WorkStealingQueue&) = delete;
+    WorkStealingQueue& operator=(const WorkStealingQueue&) = delete;
+
+    // 拥有者压入任务（空间不足时自动扩容）
+    void push(T item) {
+        std::int64_t b = bottom_.load(std::memory_order_relaxed);
+        std::int64_t t = top_.load(std::memory_order_acquire);
+        Array* a = array_.load(std::memory_order_relaxed);
+        if (b - t > a->capacity - 1) {
+            a = grow(a, t, b);
+        }
+        a->put(b, item);
+        bottom_.store(b + 1, std::memory_order_release);  // 发布元素给窃取者
+    }
+
+    // 拥有者弹出最近压入的任务，队列为空时返回false
+    bool pop(T& item) {
+        std::int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+        Array* a = array_.load(std::memory_order_relaxed);
+        bottom_.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::int64_t t = top_.load(std::memory_order_relaxed);
+
+        if (t > b) {  // 队列为空，恢复bottom
+            bottom_.store(b + 1, std::memory_order_relaxed);
+            return false;
+        }
+
+        item = a->get(b);
+        if (t == b) {  // 最后一个元素，需要与窃取者竞争
+            bool won = top_.compare_exchange_strong(t, t + 1,
+                std::memory_order_seq_cst, std::memory_order_relaxed);
+            bottom_.store(b + 1, std::memory_order_relaxed);
+            return won;
+        }
+        return true;
+    }
+
+    // 其他线程从top端窃取最早压入的任务，失败（为空或竞争失败）返回false
+    bool steal(T& item) {
+        std::int64_t t = top_.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::int64_t b = bottom_.load(std::memory_order_acquire);
+
+        if (t >= b) return false;
+
+        Array* a = array_.load(std::memory_order_acquire);
+        T x = a->get(t);
+        if (!top_.compare_exchange_strong(t, t + 1,
+            std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            return false;
+        }
+        item = x;
+        return true;
+    }
+
+    // 近似判空（仅作提示，结果可能立即过期）
+    bool empty() const {
+        std::int64_t t = top_.load(std::memory_order_relaxed);
+        std::int64_t b = bottom_.load(std::memory_order_relaxed);
+        return t >= b;
+    }
+
+    // 近似元素个数
+    std::size_t size() const {
+        std::int64_t t = top_.load(std::memory_order_relaxed);
+        std::int64_t b = bottom_.load(std::memory_order_relaxed);
+        return b > t ? static_cast<std::size_t>(b - t) : 0;
+    }
+
+private:
+    // 环形缓冲区
+    struct Array {
+        explicit Array(std::int64_t cap)
+            : capacity(cap)
+            , mask(cap - 1)
+            , buffer(new std::atomic<T>[static_cast<std::size_t>(cap)])
+        {}
+
+        void put(std::int64_t i, T item) {
+            buffer[i & mask].store(item, std::memory_order_relaxed);
+        }
+
+        T get(std::int64_t i) const {
+            return buffer[i & mask].load(std::memory_order_relaxed);
+        }
+
+        std::int64_t capacity;
+        std::int64_t mask;
+        std::unique_ptr<std::atomic<T>[]> buffer;
+    };
+
+    // 扩容为两倍（旧数组保留到析构，窃取者可能仍在读取）
+    Array* grow(Array* old, std::int64_t t, std::int64_t b) {
+        auto arr = std::make_unique<Array>(old->capacity * 2);
+        for (std::int64_t i = t; i < b; i++) {
+            arr->put(i, old->get(i));
+        }
+        Array* raw = arr.get();
+        garbage_.emplace_back(std::move(arr));
+        array_.store(raw, std::memory_order_release);
+        return raw;
+    }
+
+private:
+    alignas(CACHE_LINE_SIZE) std::atomic<std::int64_t> top_;     // 窃取端
+    alignas(CACHE_LINE_SIZE) std::atomic<std::int64_t> bottom_;  // 拥有者端
+    alignas(CACHE_LINE_SIZE) std::atomic<Array*> array_;        // 当前缓冲区
+    std::vector<std::unique_ptr<Array>> garbage_;               // 所有分配过的缓冲区（仅拥有者修改）
+};
+
+#endif
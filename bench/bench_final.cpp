@@ -0,0 +1,180 @@
+// ThreadCppFinal 基准测试
+// 编译（不依赖第三方库）：
+//   g++ -std=c++17 -O2 -pthread -I../ThreadCppFinal bench_final.cpp -o bench_final
+// 运行：./bench_final <fixed|cached|ws>[-lf] <线程数> [bench过滤子串]
+#include"threadpool.h"
+#include"parallel.h"
+#include"benchutil.h"
+
+#include<atomic>
+#include<vector>
+#include<memory>
+#include<numeric>
+
+using bench::Config;
+using bench::nowNs;
+
+// 空任务吞吐：一次性提交N个空任务后等待全部完成
+static void benchEmptyThroughput(ThreadPool& pool, const Config& cfg) {
+    const int n = cfg.iters(200000);
+    std::vector<Future<void>> futs;
+    futs.reserve(n);
+    std::int64_t t0 = nowNs();
+    for (int i = 0; i < n; i++) futs.push_back(pool.submitTask([] {}));
+    for (auto& f : futs) f.get();
+    double sec = (nowNs() - t0) / 1e9;
+    bench::report(cfg, "empty_throughput", "rate", n / sec, "tasks/s");
+}
+
+// 区间批量提交的空任务吞吐（共享一个计数器，不逐个分配结果）
+static void benchRangeThroughput(ThreadPool& pool, const Config& cfg) {
+    const int n = cfg.iters(200000);
+    std::int64_t t0 = nowNs();
+    pool.submitRange(0, n, [](int) {}).get();
+    double sec = (nowNs() - t0) / 1e9;
+    bench::report(cfg, "range_throughput", "rate", n / sec, "tasks/s");
+}
+
+// 提交到开始执行的延迟：空闲线程池逐个提交（含唤醒代价），以及一次突发提交
+static void benchSubmitLatency(ThreadPool& pool, const Config& cfg) {
+    const int n = cfg.iters(2000);
+    std::vector<std::int64_t> samples(n);
+    for (int i = 0; i < n; i++) {
+        std::int64_t* slot = &samples[i];
+        std::int64_t ts = nowNs();
+        pool.submitTask([slot, ts] { *slot = nowNs() - ts; }).get();
+    }
+    bench::reportPercentiles(cfg, "latency_idle", samples);
+
+    const int burst = cfg.iters(10000);
+    std::vector<std::int64_t> burstSamples(burst);
+    std::vector<Future<void>> futs;
+    futs.reserve(burst);
+    for (int i = 0; i < burst; i++) {
+        std::int64_t* slot = &burstSamples[i];
+        std::int64_t ts = nowNs();
+        futs.push_back(pool.submitTask([slot, ts] { *slot = nowNs() - ts; }));
+    }
+    for (auto& f : futs) f.get();
+    bench::reportPercentiles(cfg, "latency_burst", burstSamples);
+}
+
+// future.get() 往返：提交一个返回值的任务并立即等待
+static void benchGetRoundTrip(ThreadPool& pool, const Config& cfg) {
+    const int n = cfg.iters(20000);
+    std::vector<std::int64_t> samples(n);
+    for (int i = 0; i < n; i++) {
+        std::int64_t t0 = nowNs();
+        int v = pool.submitTask([i] { return i; }).get();
+        samples[i] = nowNs() - t0;
+        bench::doNotOptimize(v);
+    }
+    bench::reportPercentiles(cfg, "get_roundtrip", samples);
+}
+
+// 扇出/扇入：每轮提交K个约2us的任务并等待全部完成
+static void benchFanOut(ThreadPool& pool, const Config& cfg) {
+    const int rounds = cfg.iters(500);
+    const int k = cfg.threads * 16;
+    std::vector<std::int64_t> samples(rounds);
+    std::vector<Future<void>> futs;
+    futs.reserve(k);
+    for (int r = 0; r < rounds; r++) {
+        std::int64_t t0 = nowNs();
+        for (int i = 0; i < k; i++) futs.push_back(pool.submitTask([] { bench::spinFor(2000); }));
+        for (auto& f : futs) f.get();
+        futs.clear();
+        samples[r] = nowNs() - t0;
+    }
+    bench::reportPercentiles(cfg, "fanout_fanin", samples);
+}
+
+// 递归分叉-合并：fib(n)的一个分支作为子任务提交，另一个分支就地计算，再get()等待子任务
+// 工作线程上的get()会帮忙执行排队任务，线程数固定时也不会死锁
+static long fibParallel(ThreadPool& pool, int n, int cutoff) {
+    if (n <= cutoff) return bench::fibSerial(n);
+    Future<long> left = pool.submitTask(fibParallel, std::ref(pool), n - 1, cutoff);
+    long right = fibParallel(pool, n - 2, cutoff);
+    return left.get() + right;
+}
+
+static void benchFib(ThreadPool& pool, const Config& cfg) {
+    const int n = 32;
+    const int cutoff = 16;
+    std::int64_t t0 = nowNs();
+    long serial = bench::fibSerial(n);
+    std::int64_t serialNs = nowNs() - t0;
+
+    t0 = nowNs();
+    long parallel = fibParallel(pool, n, cutoff);
+    std::int64_t parallelNs = nowNs() - t0;
+    if (parallel != serial) std::printf("fib mismatch: %ld != %ld\n", parallel, serial);
+    bench::report(cfg, "fib_forkjoin", "time", parallelNs / 1e6, "ms");
+    bench::report(cfg, "fib_forkjoin", "speedup", static_cast<double>(serialNs) / parallelNs, "x");
+}
+
+// 长短任务混合：每100个任务中有1个2ms的长任务，其余20us；报告相对理想完成时间的效率
+static void benchSkew(ThreadPool& pool, const Config& cfg) {
+    const int n = cfg.iters(4000);
+    std::int64_t work = 0;
+    std::vector<Future<void>> futs;
+    futs.reserve(n);
+    std::int64_t t0 = nowNs();
+    for (int i = 0; i < n; i++) {
+        std::int64_t ns = (i % 100 == 0) ? 2000000 : 20000;
+        work += ns;
+        futs.push_back(pool.submitTask([ns] { bench::spinFor(ns); }));
+    }
+    for (auto& f : futs) f.get();
+    std::int64_t wall = nowNs() - t0;
+    bench::report(cfg, "mixed_skew", "time", wall / 1e6, "ms");
+    bench::report(cfg, "mixed_skew", "efficiency", 100.0 * work / bench::usableCpus(cfg) / wall, "%");
+}
+
+// 连续数组区间求和：串行std::accumulate与parallel_reduce（按缓存行切块）对比
+static void benchRangeSum(ThreadPool& pool, const Config& cfg) {
+    const std::size_t n = static_cast<std::size_t>(cfg.iters(1 << 22));
+    const int rounds = 10;
+    std::vector<double> data(n);
+    std::iota(data.begin(), data.end(), 0.0);
+    std::int64_t t0 = nowNs();
+    for (int r = 0; r < rounds; r++) bench::doNotOptimize(std::accumulate(data.begin(), data.end(), 0.0));
+    double serial = (nowNs() - t0) / 1e9;
+    t0 = nowNs();
+    for (int r = 0; r < rounds; r++) bench::doNotOptimize(parallel_reduce(pool, data.begin(), data.end(), 0.0));
+    double par = (nowNs() - t0) / 1e9;
+    bench::report(cfg, "range_sum", "serial", n * rounds / serial / 1e6, "Melem/s");
+    bench::report(cfg, "range_sum", "parallel", n * rounds / par / 1e6, "Melem/s");
+    bench::report(cfg, "range_sum", "speedup", serial / par, "x");
+}
+
+int main(int argc, char** argv) {
+    Config cfg = bench::parseArgs("final", argc, argv);
+
+    ThreadPool pool;
+    std::string mode = cfg.mode;
+    if (mode.size() > 3 && mode.compare(mode.size() - 3, 3, "-lf") == 0) {
+        pool.setQueueMode(QueueMode::QUEUE_LOCK_FREE);
+        mode.resize(mode.size() - 3);
+    }
+    if (mode == "cached") {
+        pool.setMode(PoolMode::MODE_CACHED);
+        pool.setThreadSizeThreshHold(cfg.threads * 2);
+    } else if (mode == "ws") {
+        pool.setMode(PoolMode::MODE_WORK_STEALING);
+    }
+    pool.setTaskQueMaxThreshHold(1 << 20);
+    pool.start(cfg.threads);
+    // 预热：让所有线程跑起来，分配器和slab池进入稳定状态
+    pool.submitRange(0, 10000, [](int) {}).get();
+
+    if (cfg.enabled("empty_throughput")) benchEmptyThroughput(pool, cfg);
+    if (cfg.enabled("range_throughput")) benchRangeThroughput(pool, cfg);
+    if (cfg.enabled("latency")) benchSubmitLatency(pool, cfg);
+    if (cfg.enabled("get_roundtrip")) benchGetRoundTrip(pool, cfg);
+    if (cfg.enabled("fanout_fanin")) benchFanOut(pool, cfg);
+    if (cfg.enabled("fib_forkjoin")) benchFib(pool, cfg);
+    if (cfg.enabled("mixed_skew")) benchSkew(pool, cfg);
+    if (cfg.enabled("range_sum")) benchRangeSum(pool, cfg);
+    return 0;
+}
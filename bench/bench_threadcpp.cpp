@@ -0,0 +1,175 @@
+// ThreadCpp 基准测试（与 bench_final.cpp 相同的场景和输出格式）
+// 编译（需要C++20：Result使用 atomic::wait）：
+//   g++ -std=c++20 -O2 -pthread -I../ThreadCpp bench_threadcpp.cpp ../ThreadCpp/threadpool.cpp -o bench_threadcpp
+// 运行：./bench_threadcpp <fixed|cached> <线程数> [bench过滤子串]
+#include"threadpool.h"
+#include"benchutil.h"
+
+#include<vector>
+#include<memory>
+#include<functional>
+
+using bench::Config;
+using bench::nowNs;
+
+// 原有接口：把可调用对象包装成Task子类（结果经过Any），用于和submit()对比
+class AnyFnTask : public Task {
+public:
+    explicit AnyFnTask(std::function<Any()> fn) : fn_(std::move(fn)) {}
+    Any run() override { return fn_(); }
+private:
+    std::function<Any()> fn_;
+};
+
+template<typename T>
+using ResultPtr = TaskHandle<T>;
+
+template<typename F, typename T = decltype(std::declval<F&>()())>
+static ResultPtr<T> submit(ThreadPool& pool, F fn) {
+    return pool.submit(std::move(fn));
+}
+
+// 与bench_final的场景保持一致，空任务统一返回int
+static void benchEmptyThroughput(ThreadPool& pool, const Config& cfg) {
+    const int n = cfg.iters(200000);
+    std::vector<ResultPtr<int>> results;
+    results.reserve(n);
+    std::int64_t t0 = nowNs();
+    for (int i = 0; i < n; i++) results.push_back(submit(pool, [] { return 0; }));
+    for (auto& r : results) r.get();
+    double sec = (nowNs() - t0) / 1e9;
+    bench::report(cfg, "empty_throughput", "rate", n / sec, "tasks/s");
+}
+
+static void benchSubmitLatency(ThreadPool& pool, const Config& cfg) {
+    const int n = cfg.iters(2000);
+    std::vector<std::int64_t> samples(n);
+    for (int i = 0; i < n; i++) {
+        std::int64_t* slot = &samples[i];
+        std::int64_t ts = nowNs();
+        submit(pool, [slot, ts] { *slot = nowNs() - ts; return 0; }).get();
+    }
+    bench::reportPercentiles(cfg, "latency_idle", samples);
+
+    const int burst = cfg.iters(10000);
+    std::vector<std::int64_t> burstSamples(burst);
+    std::vector<ResultPtr<int>> results;
+    results.reserve(burst);
+    for (int i = 0; i < burst; i++) {
+        std::int64_t* slot = &burstSamples[i];
+        std::int64_t ts = nowNs();
+        results.push_back(submit(pool, [slot, ts] { *slot = nowNs() - ts; return 0; }));
+    }
+    for (auto& r : results) r.get();
+    bench::reportPercentiles(cfg, "latency_burst", burstSamples);
+}
+
+static void benchGetRoundTrip(ThreadPool& pool, const Config& cfg) {
+    const int n = cfg.iters(20000);
+    std::vector<std::int64_t> samples(n);
+    for (int i = 0; i < n; i++) {
+        std::int64_t t0 = nowNs();
+        int v = submit(pool, [i] { return i; }).get();
+        samples[i] = nowNs() - t0;
+        bench::doNotOptimize(v);
+    }
+    bench::reportPercentiles(cfg, "get_roundtrip", samples);
+}
+
+static void benchFanOut(ThreadPool& pool, const Config& cfg) {
+    const int rounds = cfg.iters(500);
+    const int k = cfg.threads * 16;
+    std::vector<std::int64_t> samples(rounds);
+    std::vector<ResultPtr<int>> results;
+    results.reserve(k);
+    for (int r = 0; r < rounds; r++) {
+        std::int64_t t0 = nowNs();
+        for (int i = 0; i < k; i++) results.push_back(submit(pool, [] { bench::spinFor(2000); return 0; }));
+        for (auto& res : results) res.get();
+        results.clear();
+        samples[r] = nowNs() - t0;
+    }
+    bench::reportPercentiles(cfg, "fanout_fanin", samples);
+}
+
+// 递归分叉-合并：子任务用waitFor等待（等待期间帮忙执行队列中的任务）
+static long fibParallel(ThreadPool& pool, int n, int cutoff) {
+    if (n <= cutoff) return bench::fibSerial(n);
+    ResultPtr<long> left = submit(pool, [&pool, n, cutoff] { return fibParallel(pool, n - 1, cutoff); });
+    long right = fibParallel(pool, n - 2, cutoff);
+    return pool.waitFor(left) + right;
+}
+
+static void benchFib(ThreadPool& pool, const Config& cfg) {
+    const int n = 32;
+    const int cutoff = 16;
+    std::int64_t t0 = nowNs();
+    long serial = bench::fibSerial(n);
+    std::int64_t serialNs = nowNs() - t0;
+
+    t0 = nowNs();
+    long parallel = fibParallel(pool, n, cutoff);
+    std::int64_t parallelNs = nowNs() - t0;
+    if (parallel != serial) std::printf("fib mismatch: %ld != %ld\n", parallel, serial);
+    bench::report(cfg, "fib_forkjoin", "time", parallelNs / 1e6, "ms");
+    bench::report(cfg, "fib_forkjoin", "speedup", static_cast<double>(serialNs) / parallelNs, "x");
+}
+
+static void benchSkew(ThreadPool& pool, const Config& cfg) {
+    const int n = cfg.iters(4000);
+    std::int64_t work = 0;
+    std::vector<ResultPtr<int>> results;
+    results.reserve(n);
+    std::int64_t t0 = nowNs();
+    for (int i = 0; i < n; i++) {
+        std::int64_t ns = (i % 100 == 0) ? 2000000 : 20000;
+        work += ns;
+        results.push_back(submit(pool, [ns] { bench::spinFor(ns); return 0; }));
+    }
+    for (auto& r : results) r.get();
+    std::int64_t wall = nowNs() - t0;
+    bench::report(cfg, "mixed_skew", "time", wall / 1e6, "ms");
+    bench::report(cfg, "mixed_skew", "efficiency", 100.0 * work / bench::usableCpus(cfg) / wall, "%");
+}
+
+// 返回大结果：原有Task/Any接口（Any内部分配、dynamic_cast）与submit()（结果就地构造、移出）对比
+static void benchLargeResult(ThreadPool& pool, const Config& cfg) {
+    const int n = cfg.iters(2000);
+    const std::size_t len = 4096;
+    std::int64_t t0 = nowNs();
+    for (int i = 0; i < n; i++) {
+        Result<Any> res = pool.submitTask(std::make_shared<AnyFnTask>([len] { return Any(std::vector<int>(len, 1)); }));
+        std::vector<int> v = res.get().cast_<std::vector<int>>();
+        bench::doNotOptimize(v.data());
+    }
+    double anySec = (nowNs() - t0) / 1e9;
+
+    t0 = nowNs();
+    for (int i = 0; i < n; i++) {
+        std::vector<int> v = pool.submit([len] { return std::vector<int>(len, 1); }).get();
+        bench::doNotOptimize(v.data());
+    }
+    double typedSec = (nowNs() - t0) / 1e9;
+    bench::report(cfg, "large_result", "any_task", n / anySec, "tasks/s");
+    bench::report(cfg, "large_result", "submit", n / typedSec, "tasks/s");
+}
+
+int main(int argc, char** argv) {
+    Config cfg = bench::parseArgs("threadcpp", argc, argv);
+
+    ThreadPool pool;
+    if (cfg.mode == "cached") {
+        pool.setMode(PoolMode::MODE_CACHED);
+        pool.setThreadSizeThreshHold(cfg.threads * 2);
+    }
+    pool.start(cfg.threads);
+
+    if (cfg.enabled("empty_throughput")) benchEmptyThroughput(pool, cfg);
+    if (cfg.enabled("latency")) benchSubmitLatency(pool, cfg);
+    if (cfg.enabled("get_roundtrip")) benchGetRoundTrip(pool, cfg);
+    if (cfg.enabled("fanout_fanin")) benchFanOut(pool, cfg);
+    if (cfg.enabled("fib_forkjoin")) benchFib(pool, cfg);
+    if (cfg.enabled("mixed_skew")) benchSkew(pool, cfg);
+    if (cfg.enabled("large_result")) benchLargeResult(pool, cfg);
+    return 0;
+}
@@ -0,0 +1,102 @@
+#ifndef BENCHUTIL_H
+#define BENCHUTIL_H
+
+#include<vector>
+#include<string>
+#include<chrono>
+#include<thread>
+#include<algorithm>
+#include<cstdio>
+#include<cstdlib>
+#include<cstring>
+#include<cstdint>
+
+// 基准测试公共部分：计时、分位数统计、统一的输出格式
+// 两个实现（ThreadCpp / ThreadCppFinal）各编译一个程序，输出格式相同便于对比：
+//   impl  mode  threads  bench  metric  value  unit
+// 每个进程只创建一个线程池（按命令行参数选择模式和线程数），扫描参数见 run.sh
+
+namespace bench {
+
+inline std::int64_t nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// 空转约ns纳秒（模拟计算量，不让出CPU）
+inline void spinFor(std::int64_t ns) {
+    std::int64_t end = nowNs() + ns;
+    while (nowNs() < end) {}
+}
+
+// 防止结果被优化掉
+template<typename T>
+inline void doNotOptimize(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+// 命令行参数：<mode> <threads> [bench过滤子串]
+struct Config {
+    std::string impl;
+    std::string mode = "fixed";
+    int threads = 4;
+    std::string filter;
+    double scale = 1.0;  // 环境变量 BENCH_SCALE 缩放迭代次数（默认1）
+
+    bool enabled(const char* name) const {
+        return filter.empty() || std::strstr(name, filter.c_str()) != nullptr;
+    }
+
+    // 按缩放系数调整迭代次数（至少为1）
+    int iters(int n) const {
+        int v = static_cast<int>(n * scale);
+        return v < 1 ? 1 : v;
+    }
+};
+
+inline Config parseArgs(const char* impl, int argc, char** argv) {
+    Config cfg;
+    cfg.impl = impl;
+    if (argc > 1) cfg.mode = argv[1];
+    if (argc > 2) cfg.threads = std::atoi(argv[2]);
+    if (argc > 3) cfg.filter = argv[3];
+    if (const char* s = std::getenv("BENCH_SCALE")) cfg.scale = std::atof(s);
+    if (cfg.threads <= 0) cfg.threads = 1;
+    return cfg;
+}
+
+inline void report(const Config& cfg, const char* name, const char* metric, double value, const char* unit) {
+    std::printf("%-8s %-8s %3d  %-18s %-10s %14.1f %s\n",
+        cfg.impl.c_str(), cfg.mode.c_str(), cfg.threads, name, metric, value, unit);
+    std::fflush(stdout);
+}
+
+// 样本（纳秒）的分位数报告：p50 / p90 / p99 / max
+inline void reportPercentiles(const Config& cfg, const char* name, std::vector<std::int64_t> samples) {
+    if (samples.empty()) return;
+    std::sort(samples.begin(), samples.end());
+    auto at = [&](double p) {
+        size_t i = static_cast<size_t>(p * (samples.size() - 1));
+        return static_cast<double>(samples[i]);
+    };
+    report(cfg, name, "p50", at(0.50), "ns");
+    report(cfg, name, "p90", at(0.90), "ns");
+    report(cfg, name, "p99", at(0.99), "ns");
+    report(cfg, name, "max", static_cast<double>(samples.back()), "ns");
+}
+
+// 可同时运行的线程数：min(线程池线程数, CPU数)，用于计算并行效率
+inline int usableCpus(const Config& cfg) {
+    int cpus = static_cast<int>(std::thread::hardware_concurrency());
+    if (cpus <= 0 || cpus > cfg.threads) cpus = cfg.threads;
+    return cpus;
+}
+
+// 递归fib的串行部分
+inline long fibSerial(int n) {
+    return n < 2 ? n : fibSerial(n - 1) + fibSerial(n - 2);
+}
+
+} // namespace bench
+
+#endif
@@ -0,0 +1,22 @@
+#!/bin/sh
+# 编译并运行两个实现的基准测试，按模式和线程数扫描
+# 用法：./run.sh [线程数列表] [bench过滤子串]    例：./run.sh "1 2 4 8" latency
+# 环境变量 BENCH_SCALE 缩放迭代次数，CXX 指定编译器
+set -e
+cd "$(dirname "$0")"
+CXX=${CXX:-g++}
+THREADS=${1:-"1 2 4 8"}
+FILTER=$2
+
+$CXX -std=c++17 -O2 -pthread -I../ThreadCppFinal bench_final.cpp -o bench_final
+$CXX -std=c++20 -O2 -pthread -I../ThreadCpp bench_threadcpp.cpp ../ThreadCpp/threadpool.cpp -o bench_threadcpp
+
+# 每个进程只建一个线程池
+for t in $THREADS; do
+    for m in fixed cached; do
+        ./bench_threadcpp $m $t $FILTER
+    done
+    for m in fixed cached ws fixed-lf ws-lf; do
+        ./bench_final $m $t $FILTER
+    done
+done